@@ -3,7 +3,15 @@
 
 #include "Hazy/Util/Log.h"
 #include "Hazy/Util/ThreadPool.hpp"
+#include "Hazy/Util/Cancellation.hpp"
+#include "Hazy/Util/Task.hpp"
+#include "Hazy/Util/Dispatcher.hpp"
+#include "Hazy/Util/AsyncIO.hpp"
+#include "Hazy/Util/TaskGraph.h"
 #include "Hazy/Util/TimePoint.h"
+#include "Hazy/Util/FixedTimestep.h"
+#include "Hazy/Util/DoubleBuffer.h"
+#include "Hazy/Util/TimerWheel.h"
 #include "Hazy/Util/Util.h"
 
 #include "Hazy/Renderer/Interface.h"
@@ -13,6 +21,7 @@
 #include "Hazy/Renderer/Light.h"
 #include "Hazy/Renderer/Shader.h"
 #include "Hazy/Renderer/Renderer.h"
+#include "Hazy/Renderer/RenderThread.h"
 #include "Hazy/Renderer/VertexArray.h"
 #include "Hazy/Renderer/Texture.h"
 
@@ -2,10 +2,26 @@
 #include <hazy_pch.h>
 #include "Hazy/Window.h"
 #include "Hazy/Util/ThreadPool.hpp"
+#include "Hazy/Util/AsyncIO.hpp"
+#include "Hazy/Util/TimerWheel.h"
+#include "Hazy/EventSystem/EventQueue.h"
+#include "Hazy/Renderer/RenderThread.h"
 
 namespace Hazy {
 
+    class Event;
     class WindowCloseEvent;
+    class EventRecorder;
+    class EventReplay;
+
+    /**
+     * @brief 主循环渲染窗口的方式
+     */
+    enum class RenderMode : uint8_t {
+        Serial,     // 主线程逐个更新、渲染每一个窗口，默认的方式
+        Pipelined,  // 一个渲染线程渲染第N帧，同时主线程更新第N+1帧
+        PerWindow   // 每一个窗口一个渲染线程，上下文一直绑定在上面，不同窗口的渲染和交换缓冲区互相并行
+    };
 
     /**
      * @brief 一个程序只能有一个Application，且这个类无法被移动构造，实际上这是一个静态的类，所有属性方法都是静态的
@@ -105,6 +121,112 @@ namespace Hazy {
 
         inline static ThreadPool& getThreadPool() { return s_threadPool; }
 
+        /**
+         * @brief 获取异步文件读取服务，着色器、纹理和模型都通过它读取文件
+         */
+        inline static AsyncIO& getAsyncIO() { return s_asyncIO; }
+
+        /**
+         * @brief 获取应用程序级别的事件总线，不属于某一个窗口的系统可以在上面订阅事件
+         * @note 事件先分发给产生它的窗口（以及窗口的层），没有被处理的事件再分发到这条总线上
+         */
+        inline static EventBus& getEventBus() { return s_eventBus; }
+
+        /**
+         * @brief 获取当前的帧号，主循环每循环一次加一
+         */
+        inline static uint64_t getFrameIndex() { return s_frameIndex; }
+
+        /**
+         * @brief 开始把分发的事件录制到文件中，正在录制的话先结束之前的录制
+         * @param path 文件路径，已经存在的文件会被覆盖
+         * @throws std::runtime_error 文件打不开
+         * @note 录制的是 CheckEvents() 分发的事件（合并之后的），帧号相对于开始录制的这一帧
+         */
+        static void startRecording(const std::string& path);
+        static void stopRecording();
+        inline static bool isRecording() { return s_recorder != nullptr; }
+
+        /**
+         * @brief 从当前帧开始回放录制的事件，按照窗口标题找到对应的窗口，回放完之后自动结束
+         * @param path 文件路径
+         * @throws std::runtime_error 文件打不开，或者不是有效的录制文件
+         * @note 回放期间忽略实际的输入事件（EventCategory::Input），窗口事件照常处理，这样每一次回放的输入都是相同的
+         */
+        static void startReplay(const std::string& path);
+        static void stopReplay();
+        inline static bool isReplaying() { return s_replay != nullptr; }
+
+        /**
+         * @brief 设置主循环渲染窗口的方式，可以在主循环运行的过程中切换，切换前会等待正在渲染的帧完成
+         * @param mode 渲染方式
+         * @note RenderMode::Pipelined：
+         * @note - 主线程更新完第N+1帧（m_updateFunc 和帧任务图）之后等待渲染线程渲染完第N帧，在同步点（Window::m_syncFunc）交换帧数据，
+         * 然后把第N+1帧交给渲染线程，接着更新第N+2帧，更新和渲染的耗时互相重叠
+         * @note - 事件在同步点渲染线程空闲时分发，窗口、层的 onEvent() 和层的 update() 不会同时执行，m_updateFunc 在下一帧才能看到这些事件
+         * @note - 渲染线程依次切换到每一个窗口的上下文，执行渲染线程函数、m_renderFunc、层的 update()，然后交换缓冲区，
+         * 主线程只处理窗口系统的事件，不会再被交换缓冲区阻塞
+         * @note - 画面比输入多落后一帧
+         * @note RenderMode::PerWindow：
+         * @note - 和 RenderMode::Pipelined 一样流水线执行，但是每一个窗口有自己的渲染线程，窗口的上下文一直绑定在这个线程上，每一帧不再切换上下文
+         * @note - 主线程只处理事件、更新窗口，然后等待所有窗口的上一帧渲染完，分发事件之后逐个窗口同步、提交这一帧，
+         * 多个开启了垂直同步的窗口在各自的线程中等待交换缓冲区，一帧只需要一个刷新间隔，而不是每一个窗口一个
+         * @note - 新添加的窗口在它的第一帧启动渲染线程，关闭窗口时先结束它的渲染线程，上下文回到主线程之后再销毁
+         * @warning - 使用渲染线程时主线程不能再绑定窗口的上下文（渲染线程持有它时 bind() 抛出 std::logic_error），需要上下文的工作请用 Window::postToRenderThread() 或者 executeOnRenderThread()
+         * @warning - m_renderFunc 和层的 update() 在渲染线程中执行，它们和 m_updateFunc 都会访问的数据请用 DoubleBuffer（见 Window::registerFrameData()）或者在 m_syncFunc 中交换，
+         * 需要在主线程中调用 GLFW 的层（比如 ImGuiLayer）不能和渲染线程一起使用
+         * @warning 只能在主线程调用
+         */
+        static void setRenderMode(RenderMode mode);
+        inline static RenderMode getRenderMode() { return s_renderMode; }
+
+        /**
+         * @brief 获取 RenderMode::Pipelined 时所有窗口共用的渲染线程，其他模式下为nullptr
+         */
+        inline static RenderThread* getRenderThread() { return s_renderThread.get(); }
+
+        // 定时器的精度，也就是时间轮中一刻的长度
+        static constexpr std::chrono::milliseconds s_timerResolution { 1 };
+
+        /**
+         * @brief 添加一个定时器，到期之后在主循环中、处理事件之前调用回调
+         * @param delay 延迟，按照 s_timerResolution 向上取整，比一帧更精细：同一帧中到期的多个定时器按照到期的先后调用
+         * @param callback 回调，在主线程中调用
+         * @param repeat 为 true 时每隔 delay 调用一次，直到被取消，一帧跨过了好几个间隔时每一个间隔都会调用一次
+         * @return TimerWheel::Handle 定时器的句柄，用于 cancelTimer()
+         * @note 添加和取消都是 O(1)，成千上万个定时器也不需要每一帧逐个检查
+         * @warning 定时器只能在主线程上添加和取消
+         */
+        static TimerWheel::Handle addTimer(std::chrono::nanoseconds delay, TimerWheel::Callback callback, bool repeat = false);
+
+        /**
+         * @brief 添加一个按帧计时的定时器，在 frames 帧之后的主循环中、处理事件之前调用回调
+         * @param frames 多少帧之后，为0时和1相同，也就是下一帧
+         * @param callback 回调，在主线程中调用
+         * @param repeat 为 true 时每隔 frames 帧调用一次，直到被取消
+         * @return TimerWheel::Handle 定时器的句柄，用于 cancelTimer()
+         */
+        static TimerWheel::Handle addFrameTimer(uint64_t frames, TimerWheel::Callback callback, bool repeat = false);
+
+        /**
+         * @brief 在 delay 之后把一个事件投递到事件队列中，和其他事件一样在这一帧分发
+         * @tparam T 事件类型
+         * @param delay 延迟
+         * @param args 事件构造函数的参数，会被复制到定时器中
+         * @return TimerWheel::Handle 定时器的句柄，在投递之前可以用 cancelTimer() 取消
+         */
+        template<extendsFrom<Event> T, typename... Args>
+        inline static TimerWheel::Handle postEventAfter(std::chrono::nanoseconds delay, Args&&... args) {
+            return addTimer(delay, [... args = std::forward<Args>(args)] { EventQueue::emplaceEvent<T>(args...); });
+        }
+
+        /**
+         * @brief 取消一个定时器
+         * @return true 取消成功
+         * @return false 定时器已经结束或者已经被取消了
+         */
+        static bool cancelTimer(TimerWheel::Handle handle);
+
         inline static void addShutDownHook(std::function<void()> func) {
             s_shutDownHooks.push(func);
         }
@@ -117,8 +239,34 @@ namespace Hazy {
          * @brief 从消息队列中获取事件，然后分发事件给各个窗口
          */
         static void CheckEvents();
+        static void DispatchEvent(Event& event);
+
+        /**
+         * @brief 触发到期的定时器，每一帧开始时调用一次
+         */
+        static void AdvanceTimers();
+
+        /**
+         * @brief 当前时间对应的定时器时间轮的刻
+         */
+        static uint64_t CurrentTimerTick();
         static bool OnWindowClose(WindowCloseEvent& e);
 
+        /**
+         * @brief RenderMode::Pipelined 时的一帧：在主线程中更新所有窗口，等待上一帧渲染完成，分发事件、同步之后交给渲染线程
+         */
+        static void PipelineFrame();
+
+        /**
+         * @brief RenderMode::PerWindow 时的一帧：在主线程中更新所有窗口，等待所有窗口的上一帧渲染完成，分发事件之后逐个窗口同步，交给它自己的渲染线程
+         */
+        static void ParallelFrame();
+
+        /**
+         * @brief 等待所有渲染线程渲染完正在渲染的帧，没有渲染线程时立即返回
+         */
+        static void WaitForRender();
+
     private:
         inline static void init() {
             std::call_once(s_initializedFlag,
@@ -137,6 +285,18 @@ namespace Hazy {
         }
 
         static ThreadPool s_threadPool;
+        static AsyncIO s_asyncIO;   // 使用 s_threadPool，必须在它之后构造
+        static EventBus s_eventBus;
+        static uint64_t s_frameIndex;
+        static UniqueRef<EventRecorder> s_recorder;
+        static UniqueRef<EventReplay> s_replay;
+        static uint64_t s_replayStartFrame;
+        static TimerWheel s_timers;         // 按照时间计时，一刻为 s_timerResolution
+        static TimerWheel s_frameTimers;    // 按照帧计时，一刻为一帧
+        static RenderMode s_renderMode;
+        static UniqueRef<RenderThread> s_renderThread;
+        static std::vector<Window*> s_renderingWindows;     // 渲染线程正在渲染的窗口，只在同步点修改
+        static const std::chrono::steady_clock::time_point s_timerEpoch;
         static std::unordered_set<UniqueRef<Window>> s_windows;
         static std::shared_mutex s_windowMutex;
         static bool s_running;
@@ -115,19 +115,44 @@ namespace Hazy {
 
     int KeyToGLFW(Key key);
     Key GLFWToKey(int key);
-    std::string KeyToString(Key key);
+    /**
+     * @brief 获取键的名称，返回的字符串是静态的，不会分配内存
+     */
+    std::string_view KeyToString(Key key);
 
     int MouseButtonToGLFW(MouseButton button);
     MouseButton GLFWToMouseButton(int button);
-    std::string MouseButtonToString(MouseButton button);
+    std::string_view MouseButtonToString(MouseButton button);
 
     int ModifierKeyToGLFW(ModifierKey key);
     ModifierKey GLFWToModifierKey(int key);
-    std::string ModifierKeyToString(ModifierKey key);
+    std::string_view ModifierKeyToString(ModifierKey key);
 
     int KeyActionToGLFW(KeyAction action);
     KeyAction GLFWToKeyAction(int action);
 
     int MouseButtonActionToGLFW(MouseButtonAction action);
     MouseButtonAction GLFWToMouseButtonAction(int action);
-}
\ No newline at end of file
+}
+
+// 让键、鼠标按键和修饰键可以直接用 fmt 和 Logger 格式化，输出它们的名称，支持字符串的格式说明符（比如 {:>8}）
+template <>
+struct fmt::formatter<Hazy::Key> : fmt::formatter<std::string_view> {
+    auto format(Hazy::Key key, fmt::format_context& ctx) const {
+        return fmt::formatter<std::string_view>::format(Hazy::KeyToString(key), ctx);
+    }
+};
+
+template <>
+struct fmt::formatter<Hazy::MouseButton> : fmt::formatter<std::string_view> {
+    auto format(Hazy::MouseButton button, fmt::format_context& ctx) const {
+        return fmt::formatter<std::string_view>::format(Hazy::MouseButtonToString(button), ctx);
+    }
+};
+
+template <>
+struct fmt::formatter<Hazy::ModifierKey> : fmt::formatter<std::string_view> {
+    auto format(Hazy::ModifierKey key, fmt::format_context& ctx) const {
+        return fmt::formatter<std::string_view>::format(Hazy::ModifierKeyToString(key), ctx);
+    }
+};
\ No newline at end of file
@@ -15,4 +15,8 @@
 #include "Hazy/EventSystem/Event.h"
 #include "Hazy/EventSystem/AppEvent.h"
 #include "Hazy/EventSystem/KeyEvent.h"
-#include "Hazy/EventSystem/MouseEvent.h"
\ No newline at end of file
+#include "Hazy/EventSystem/MouseEvent.h"
+#include "Hazy/EventSystem/EventQueue.h"
+#include "Hazy/EventSystem/EventBus.h"
+#include "Hazy/EventSystem/InputLatency.h"
+#include "Hazy/EventSystem/EventRecorder.h"
\ No newline at end of file
@@ -7,13 +7,11 @@ namespace Hazy {
     public:
         WindowCloseEvent(Window* window) : Event(window) { }
         
-        inline static EventType getStaticType() { return EventType::WindowClose; }
+        static constexpr EventType getStaticType() { return EventType::WindowClose; }
         inline EventType getType() const override { return EventType::WindowClose; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Application; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "WindowCloseEvent -- Window: " << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "WindowCloseEvent -- Window: {}", windowTitle());
         }
     };
 
@@ -26,13 +24,11 @@ namespace Hazy {
         inline unsigned int getHeight() const { return m_height; }
         inline float getAspectRatio() const { return (float)m_width / (float)m_height; }
 
-        inline static EventType getStaticType() { return EventType::WindowResize; }
+        static constexpr EventType getStaticType() { return EventType::WindowResize; }
         inline EventType getType() const override { return EventType::WindowResize; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Application; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "WindowResizeEvent -- Window: " << Event::getWindow()->getProps().title << " width: " << m_width << " height: " << m_height;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "WindowResizeEvent -- Window: {} width: {} height: {}", windowTitle(), m_width, m_height);
         }
     private:
         unsigned int m_width, m_height;
@@ -41,26 +37,22 @@ namespace Hazy {
     class HAZY_API WindowFocusEvent : public Event {
     public:
         WindowFocusEvent(Window* window) : Event(window) { }
-        inline static EventType getStaticType() { return EventType::WindowFocus; }
+        static constexpr EventType getStaticType() { return EventType::WindowFocus; }
         inline EventType getType() const override { return EventType::WindowFocus; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Application; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "WindowFocusEvent -- Window: " << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "WindowFocusEvent -- Window: {}", windowTitle());
         }
     };
 
     class HAZY_API WindowLostFocusEvent : public Event {
     public:
         WindowLostFocusEvent(Window* window) : Event(window) { }
-        inline static EventType getStaticType() { return EventType::WindowLostFocus; }
+        static constexpr EventType getStaticType() { return EventType::WindowLostFocus; }
         inline EventType getType() const override { return EventType::WindowLostFocus; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Application; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "WindowLostFocusEvent -- Window: " << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "WindowLostFocusEvent -- Window: {}", windowTitle());
         }
     };
 
@@ -71,13 +63,11 @@ namespace Hazy {
         inline int getX() const { return x; }
         inline int getY() const { return y; }
         
-        inline static EventType getStaticType() { return EventType::WindowMoved; }
+        static constexpr EventType getStaticType() { return EventType::WindowMoved; }
         inline EventType getType() const override { return EventType::WindowMoved; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Application; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "WindowMovedEvent -- Window: " << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "WindowMovedEvent -- Window: {} x: {} y: {}", windowTitle(), x, y);
         }
     private:
         int x, y;
@@ -85,25 +75,25 @@ namespace Hazy {
 
     class HAZY_API AppTickEvent : public Event {
     public:
-        inline static EventType getStaticType() { return EventType::AppTick; }
+        static constexpr EventType getStaticType() { return EventType::AppTick; }
         inline EventType getType() const override { return EventType::AppTick; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Application; }
-        inline std::string_view toString() const override { return "AppTickEvent"; }
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override { return fmt::format_to(out, "AppTickEvent"); }
     };
 
     class HAZY_API AppUpdateEvent : public Event {
     public:
-        inline static EventType getStaticType() { return EventType::AppUpdate; }
+        static constexpr EventType getStaticType() { return EventType::AppUpdate; }
         inline EventType getType() const override { return EventType::AppUpdate; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Application; }
-        inline std::string_view toString() const override { return "AppUpdateEvent"; }
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override { return fmt::format_to(out, "AppUpdateEvent"); }
     };
 
     class HAZY_API AppRenderEvent : public Event {
     public:
-        inline static EventType getStaticType() { return EventType::AppRender; }
+        static constexpr EventType getStaticType() { return EventType::AppRender; }
         inline EventType getType() const override { return EventType::AppRender; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Application; }
-        inline std::string_view toString() const override { return "AppRenderEvent"; }
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override { return fmt::format_to(out, "AppRenderEvent"); }
     };
 }
\ No newline at end of file
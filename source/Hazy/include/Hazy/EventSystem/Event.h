@@ -6,101 +6,31 @@
 
 namespace Hazy {
 
-    class Event;
+    using EventClock = std::chrono::steady_clock;
 
     /**
-     * @brief 事件队列，单例类，这个类线程安全
+     * @brief 事件在传递过程中的各个时间点，用于统计输入延迟，没有经过的阶段为默认值（时钟的纪元）
      */
-    class HAZY_API EventQueue {
-    public:
-        EventQueue(EventQueue&) = delete;
-        EventQueue(EventQueue&&) = delete;
-        EventQueue& operator=(EventQueue&) = delete;
-        EventQueue& operator=(EventQueue&&) = delete;
-
-        ~EventQueue() {
-            Logger::LogTrace("EventQueue destroyed");
-        }
-
-        /**
-         * @brief 从事件队列中拉取事件
-         * @return std::optional<Ref<Event>> 一个指向事件的智能指针
-         */
-        inline static std::optional<Ref<Event>> pollEvent() {
-            init();
-            if (s_toDoList.empty())
-                return { std::nullopt };
-            else {
-                {
-                    std::lock_guard<std::mutex> lock(s_queueMutex);
-                    Ref<Event> front = s_toDoList.front();
-                    s_toDoList.pop();
-                    return { front };
-                }
-            }
-        }
-
-        inline bool isEmpty() const { return s_toDoList.empty(); }
-
-        /**
-         * @brief 将事件放置于队列，如果这个事件没有被处理
-         * @tparam T 事件类型（自动推导）
-         * @param event 事件
-         */
-        template<extendsFrom<Event> T>
-        inline static void pushEvent(T& event) {
-            init();
-            {
-                std::lock_guard<std::mutex> lock(s_queueMutex);
-                s_toDoList.emplace(std::move(event));
-            }
-        }
-
-        /**
-         * @brief 将事件放置于队列
-         * @tparam T 事件类型（指定）
-         * @param[in] args 事件构造函数参数
-         */
-        template<extendsFrom<Event> T, typename... Args>
-        inline static void emplaceEvent(Args&&... args) {
-            init();
-            Ref<Event> event = Ref<T>(new T(std::forward<Args>(args)...));
-            {
-                std::lock_guard<std::mutex> lock(s_queueMutex);
-                s_toDoList.emplace(event);
-            }
-        }
-
-    private:
-        
-        inline static void init() {
-            std::call_once(s_initialzed,
-                [] {
-                    s_eventQueue.reset(new EventQueue());
-                    std::atexit([] { s_eventQueue.reset(); });
-                });
-        }
-        
-        EventQueue() {
-            Logger::LogTrace("EventQueue created");
-        }
-
-        static std::once_flag s_initialzed;
-        static UniqueRef<EventQueue> s_eventQueue;
-
-        static std::mutex s_queueMutex;                        // 这个代办事件的互斥锁
-        static std::queue<Ref<Event>> s_toDoList;  // 代办事件清单
+    struct EventTimestamps {
+        EventClock::time_point queued;      // 投递到事件队列的时间，GLFW 的事件就是回调被调用的时间
+        EventClock::time_point dequeued;    // 主线程从事件队列中取出的时间
+        EventClock::time_point dispatched;  // 开始分发给窗口和层的时间
     };
 
-
     /**
-     * @brief 继承此类来创建自定义事件，注意需要创建函数：getStaticType()，返回事件的类型
+     * @brief 继承此类来创建自定义事件，注意需要创建函数：getStaticType()，返回事件的类型，
+     * 声明为 static constexpr 之后才能使用编译期生成跳转表的 EventDispatcher::dispatch<Ts...>(handlers...)
      * 需要重写函数：getType()、getCategoryFlags()
-     * 可以重写函数：toString()
+     * 可以重写函数：formatTo()，决定事件被 fmt、Logger 和 toString() 格式化成什么样子
      */
     class HAZY_API Event {
     public:
         Event(Window* window) : s_windows(window) { }
+        Event(const Event&) = default;
+        Event(Event&&) = default;
+        Event& operator=(const Event&) = default;
+        Event& operator=(Event&&) = default;
+        virtual ~Event() = default;
 
         /**
          * @brief 获取事件的类型（小类）
@@ -115,14 +45,34 @@ namespace Hazy {
         virtual EventCategory getCategoryFlags() const = 0;
 
         /**
-         * @brief 将事件转换成字符串，注意这个函数会访问Window中的属性（需要打印出产生此事件的窗口名称，所以在调用这个函数之前一定要确保产生此事件的窗口没有被销毁）
-         * @return std::string_view 转换出来的新的字符串视图，为什么是视图，因为视图更加高效，虽然也没快到那里去
+         * @brief 把事件格式化到 out 中，fmt::formatter<Event> 直接调用它，Logger::LogInfo("{}", event) 会把事件直接写进日志的缓冲区，不会分配内存
+         * @param out 输出位置，一般是 fmt 的缓冲区
+         * @return fmt::format_context::iterator 写完之后的输出位置
+         * @note 会打印产生此事件的窗口的标题，调用之前一定要确保这个窗口没有被销毁
+         */
+        virtual fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const {
+            return fmt::format_to(out, "{}Event -- window: {}", EventTypeToString(getType()), windowTitle());
+        }
+
+        /**
+         * @brief 将事件转换成字符串，内容和 formatTo() 相同
+         * @return std::string 转换出来的字符串
+         * @note 会分配内存，记录日志时请直接格式化事件：Logger::LogInfo("{}", event)
          */
-        inline virtual std::string_view toString() const { return "Event -- Base"; }
+        inline std::string toString() const {
+            fmt::memory_buffer buffer;
+            formatTo(fmt::appender(buffer));
+            return fmt::to_string(buffer);
+        }
         inline bool isHandled() const { return m_handled; }
         inline void markDone() { m_handled = true; }
         inline bool isInCategory(EventCategory category) const { return static_cast<bool>(getCategoryFlags() & category); }
 
+        inline const EventTimestamps& getTimestamps() const { return m_timestamps; }
+        inline void markQueued(EventClock::time_point time) { m_timestamps.queued = time; }
+        inline void markDequeued(EventClock::time_point time) { m_timestamps.dequeued = time; }
+        inline void markDispatched(EventClock::time_point time) { m_timestamps.dispatched = time; }
+
         /**
          * @brief 获取产生这个事件的窗口
          * @return Window* 产生事件的窗口的指针
@@ -133,6 +83,7 @@ namespace Hazy {
          * @brief 过滤事件，如果传入的事件的类型不是这个事件的类型，则标记为已经处理（逻辑上就是过滤）
          * @param event 需要判断的事件，如果这个事件是后面的事件类型，那么就放过它
          * @param eventType 需要这个事件的类型，（小类）
+         * @note 被标记为已处理的事件不会再传给后面的层，层只关心某些事件的话请使用 EventListener::subscribe()
          */
         inline static void filter(Event& event, EventType eventType) {
             if (event.getType() != eventType)
@@ -150,10 +101,26 @@ namespace Hazy {
         }
 
     protected:
+        /**
+         * @brief 产生此事件的窗口的标题，没有窗口时为 "null"，给 formatTo() 使用
+         */
+        inline std::string_view windowTitle() const {
+            return s_windows != nullptr ? std::string_view(s_windows->getProps().title) : std::string_view("null");
+        }
+
         bool m_handled = false;
         Window* s_windows;
+        EventTimestamps m_timestamps;
     };
     
+    /**
+     * @brief getStaticType() 可以在编译期求值的事件类型，只有这样的类型才能放进 EventDispatcher 的跳转表
+     */
+    template<class T>
+    concept StaticEventType = requires {
+        typename std::integral_constant<EventType, T::getStaticType()>;
+    };
+
     /**
      * @brief 事件分发器，用于分发事件，使用装饰器模式
      * 
@@ -183,10 +150,83 @@ namespace Hazy {
             return true;
         }
 
+        /**
+         * @brief 事件分发，一次性分发给多种事件的处理方法
+         * @tparam Ts 要处理的事件类型，getStaticType() 必须是 constexpr，不能重复；
+         * 否则这个重载不参与重载决议，只处理一种事件时会退回到上面的 std::function 版本
+         * @param handlers 处理方法，和 Ts 一一对应，签名为 bool(T&)，可以是 lambda、函数指针或者任何可调用对象
+         * @return true 事件之前已经被处理过了，或者被这一次的处理方法处理成功
+         * @return false 没有对应的处理方法，或者处理失败
+         * @note 编译期按照 EventType 生成一张跳转表，运行时只查一次表，处理方法直接被调用（可以被内联），不会构造 std::function，
+         * 也不需要对每一个处理方法比较一次事件类型
+         * @code
+         * EventDispatcher(event).dispatch<WindowResizeEvent, MouseMovedEvent>(
+         *     [&](WindowResizeEvent& e) { ...; return true; },
+         *     [&](MouseMovedEvent& e) { ...; return false; });
+         * @endcode
+         */
+        template<class... Ts, class... Fns>
+        requires (sizeof...(Ts) > 0 && (StaticEventType<Ts> && ...))
+        inline bool dispatch(Fns&&... handlers) {
+            static_assert(sizeof...(Ts) == sizeof...(Fns), "Each event type needs exactly one handler");
+            static_assert((extendsFrom<Ts, Event> && ...), "Handled types must derive from Event");
+            static_assert(distinctTypes<Ts...>(), "Each event type can only be handled once");
+
+            if (m_event.isHandled())
+                return true;
+
+            using Handlers = std::tuple<Fns&...>;
+            static constexpr JumpTable table = makeJumpTable<Handlers, Ts...>(std::index_sequence_for<Ts...> {});
+
+            Handlers references(handlers...);
+            size_t index = static_cast<size_t>(m_event.getType());
+            if (index < table.size() && table[index] != nullptr && table[index](m_event, &references)) {
+                m_event.markDone();
+                return true;
+            }
+            return false;
+        }
+
     private:
-        
+        // 跳转表的每一项：把事件转换成对应的类型，然后调用处理方法
+        using JumpTable = std::array<bool (*)(Event&, void*), eventTypeCount>;
+
+        template<class Handlers, class T, size_t I>
+        static bool invokeHandler(Event& event, void* handlers) {
+            return static_cast<bool>(std::invoke(std::get<I>(*static_cast<Handlers*>(handlers)), static_cast<T&>(event)));
+        }
+
+        template<class Handlers, class... Ts, size_t... Is>
+        static constexpr JumpTable makeJumpTable(std::index_sequence<Is...>) {
+            JumpTable table {};
+            ((table[static_cast<size_t>(Ts::getStaticType())] = &invokeHandler<Handlers, Ts, Is>), ...);
+            return table;
+        }
+
+        template<class... Ts>
+        static constexpr bool distinctTypes() {
+            constexpr std::array<EventType, sizeof...(Ts)> types { Ts::getStaticType()... };
+            for (size_t i = 0; i < types.size(); i++) {
+                for (size_t j = i + 1; j < types.size(); j++) {
+                    if (types[i] == types[j])
+                        return false;
+                }
+            }
+            return true;
+        }
+
         Event& m_event;
     };
 
     
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 所有事件（包括自定义事件）的格式化器，通过虚函数 Event::formatTo() 直接写入 fmt 的缓冲区
+ */
+template <typename T>
+struct fmt::formatter<T, char, std::enable_if_t<std::is_base_of_v<Hazy::Event, T>>> {
+    constexpr auto parse(fmt::format_parse_context& ctx) { return ctx.begin(); }
+
+    auto format(const Hazy::Event& event, fmt::format_context& ctx) const { return event.formatTo(ctx.out()); }
+};
\ No newline at end of file
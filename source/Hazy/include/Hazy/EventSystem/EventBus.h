@@ -0,0 +1,123 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Definition.h"
+#include "Hazy/EventSystem/EventEnum.h"
+
+namespace Hazy {
+
+    class Event;
+
+    /**
+     * @brief 事件监听者，挂到 EventBus 上接收事件，可以按照事件类型（小类）或者事件类别（大类）订阅感兴趣的事件
+     * @note 默认订阅所有事件，只关心部分事件的监听者先调用 unsubscribeAll()，再订阅需要的事件
+     * @warning 订阅只能在分发事件的线程（主线程）上修改
+     */
+    class HAZY_API EventListener {
+    public:
+        virtual ~EventListener() = default;
+
+        virtual void onEvent(Event&) { }
+
+        /**
+         * @brief 是否正在接收事件，返回 false 时 EventBus 会跳过这个监听者
+         */
+        virtual bool isListening() const { return true; }
+
+        /**
+         * @brief 订阅某一种事件
+         * @param type 事件类型（小类）
+         */
+        void subscribe(EventType type);
+
+        /**
+         * @brief 订阅某一类或者某几类事件，事件的 getCategoryFlags() 和它有交集就会收到
+         * @param category 事件类别（大类），可以用 | 组合
+         */
+        void subscribe(EventCategory category);
+
+        /**
+         * @brief 取消订阅某一种事件，通过类别订阅到的这种事件仍然会收到
+         * @param type 事件类型（小类）
+         */
+        void unsubscribe(EventType type);
+
+        void subscribeAll();
+        void unsubscribeAll();
+
+        /**
+         * @brief 判断某个事件是否被订阅了
+         * @param type 事件的类型
+         * @param categories 事件的类别
+         */
+        inline bool isSubscribed(EventType type, EventCategory categories) const {
+            return (m_types & typeBit(type)) != 0 || (m_categories & static_cast<uint8_t>(categories)) != 0;
+        }
+
+        /**
+         * @brief 是否有按照类别订阅的事件
+         */
+        inline bool hasCategorySubscription() const { return m_categories != 0; }
+
+        /**
+         * @brief 订阅的版本号，任何一个监听者修改订阅都会使它增加，EventBus 根据它判断订阅表是否需要重建
+         */
+        inline static uint64_t getSubscriptionVersion() { return s_subscriptionVersion.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr uint32_t typeBit(EventType type) { return 1u << static_cast<uint32_t>(type); }
+
+        static constexpr uint32_t s_allTypes = (1u << eventTypeCount) - 1;
+
+        uint32_t m_types = s_allTypes;  // 第 n 位表示订阅了 EventType 为 n 的事件
+        uint8_t m_categories = 0;       // 订阅的事件类别
+        static std::atomic<uint64_t> s_subscriptionVersion;
+    };
+
+    /**
+     * @brief 事件总线，按照挂载的顺序把事件分发给订阅了它的监听者
+     * @note - 每一种事件类型有一张订阅者列表，分发时只遍历这一张列表，不关心这个事件的监听者不会被调用
+     * @note - 事件被标记为已处理之后立即停止传播
+     * @note - 订阅者列表在挂载、卸载监听者或者订阅发生变化之后的下一次分发时重建
+     * @warning 只能在分发事件的线程（主线程）上使用，监听者的生命周期由使用者管理，销毁之前必须先卸载，
+     * 在分发的过程中卸载的监听者在这一次分发中仍然可能被调用，所以不能在 onEvent 中销毁其他监听者
+     */
+    class HAZY_API EventBus {
+    public:
+        EventBus() = default;
+        EventBus(const EventBus&) = delete;
+        EventBus& operator=(const EventBus&) = delete;
+
+        /**
+         * @brief 挂载一个监听者
+         * @param listener 监听者
+         * @param position 插入的位置，越靠前越先收到事件，超过监听者的数量时放到最后
+         */
+        void attach(EventListener* listener, size_t position = SIZE_MAX);
+
+        /**
+         * @brief 卸载一个监听者，没有挂载的话什么也不做
+         */
+        void detach(EventListener* listener);
+
+        /**
+         * @brief 分发一个事件
+         * @param event 事件
+         * @return true 事件已经被处理了（包括分发之前就已经被处理的事件，它们不会再分发给任何监听者）
+         * @return false 事件没有被处理
+         */
+        bool publish(Event& event);
+
+        inline size_t size() const { return m_listeners.size(); }
+        inline bool empty() const { return m_listeners.empty(); }
+
+    private:
+        void rebuild();
+
+        std::vector<EventListener*> m_listeners;                                // 按照分发顺序排列的所有监听者
+        std::array<std::vector<EventListener*>, eventTypeCount> m_subscribers;  // 每一种事件可能的订阅者，按照类别订阅的监听者在分发时还要检查一次
+        uint64_t m_version = 0;
+        int m_publishing = 0;   // 正在进行的分发的层数
+        bool m_dirty = true;
+    };
+
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <hazy_pch.h>
 
 namespace Hazy
 {
@@ -11,6 +12,32 @@ namespace Hazy
         MouseButtonPressed, MouseButtonReleased, MouseMoved, MouseScrolled      // Mouse events
     };
 
+    // 事件类型（小类）的数量，按照 EventType 建表时使用，添加新的事件类型时需要同时修改
+    constexpr size_t eventTypeCount = static_cast<size_t>(EventType::MouseScrolled) + 1;
+
+    /**
+     * @brief 获取事件类型的名称，返回的字符串是静态的
+     */
+    constexpr std::string_view EventTypeToString(EventType type) {
+        switch (type) {
+        case EventType::WindowClose:         return "WindowClose";
+        case EventType::WindowResize:        return "WindowResize";
+        case EventType::WindowFocus:         return "WindowFocus";
+        case EventType::WindowLostFocus:     return "WindowLostFocus";
+        case EventType::WindowMoved:         return "WindowMoved";
+        case EventType::AppTick:             return "AppTick";
+        case EventType::AppUpdate:           return "AppUpdate";
+        case EventType::AppRender:           return "AppRender";
+        case EventType::KeyPressed:          return "KeyPressed";
+        case EventType::KeyReleased:         return "KeyReleased";
+        case EventType::MouseButtonPressed:  return "MouseButtonPressed";
+        case EventType::MouseButtonReleased: return "MouseButtonReleased";
+        case EventType::MouseMoved:          return "MouseMoved";
+        case EventType::MouseScrolled:       return "MouseScrolled";
+        default:                             return "None";
+        }
+    }
+
     enum class EventCategory : uint8_t
     {
         None = 0,
@@ -0,0 +1,291 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Definition.h"
+#include "Hazy/Util/BoundedQueue.hpp"
+#include "Hazy/EventSystem/Event.h"
+#include "Hazy/EventSystem/AppEvent.h"
+#include "Hazy/EventSystem/KeyEvent.h"
+#include "Hazy/EventSystem/MouseEvent.h"
+
+namespace Hazy {
+
+    /**
+     * @brief 按值存放一个事件的槽位，事件直接构造在槽位内部，不经过堆分配
+     * @note - 槽位的大小是所有内置事件（AppEvent.h、KeyEvent.h、MouseEvent.h）中最大的那一个，相当于内置事件的联合体，事件的虚表指针就是类型标签
+     * @note - 放不下的自定义事件放在一个预分配的大块对象池中，对象池用完了或者事件超过 s_largeSize 才在堆上分配
+     * @note 只能移动，不能拷贝，移动时内置事件会被移动构造到新的槽位中
+     */
+    class HAZY_API EventSlot {
+    public:
+        static constexpr size_t s_inlineSize = std::max({
+            sizeof(WindowCloseEvent), sizeof(WindowResizeEvent), sizeof(WindowFocusEvent), sizeof(WindowLostFocusEvent), sizeof(WindowMovedEvent),
+            sizeof(AppTickEvent), sizeof(AppUpdateEvent), sizeof(AppRenderEvent),
+            sizeof(KeyPressedEvent), sizeof(KeyReleasedEvent),
+            sizeof(MouseButtonPressedEvent), sizeof(MouseButtonReleasedEvent), sizeof(MouseMovedEvent), sizeof(MouseScrolledEvent)
+        });
+
+        // 对象池中每一块的大小，超过这个大小的自定义事件直接在堆上分配
+        static constexpr size_t s_largeSize = 256;
+
+        // 对象池中预分配的块数
+        static constexpr size_t s_largePoolCapacity = 256;
+
+        EventSlot() = default;
+        EventSlot(EventSlot&& other) noexcept { moveFrom(other); }
+        EventSlot& operator=(EventSlot&& other) noexcept {
+            if (this != &other) {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+        EventSlot(const EventSlot&) = delete;
+        EventSlot& operator=(const EventSlot&) = delete;
+        ~EventSlot() { reset(); }
+
+        /**
+         * @brief 在槽位中构造一个事件，原来的事件会被销毁
+         * @tparam T 事件类型
+         * @param[in] args 事件构造函数参数
+         * @return T& 构造出来的事件
+         */
+        template<extendsFrom<Event> T, typename... Args>
+        T& emplace(Args&&... args) {
+            reset();
+            T* event;
+            if constexpr (sizeof(T) <= s_inlineSize && alignof(T) <= alignof(std::max_align_t)) {
+                event = new (m_storage) T(std::forward<Args>(args)...);
+                m_relocate = [](EventSlot& from, EventSlot& to) {
+                    T* source = std::launder(reinterpret_cast<T*>(from.m_storage));
+                    to.m_event = new (to.m_storage) T(std::move(*source));
+                    source->~T();
+                };
+                m_destroy = [](EventSlot& slot) { std::launder(reinterpret_cast<T*>(slot.m_storage))->~T(); };
+            }
+            else if constexpr (sizeof(T) <= s_largeSize && alignof(T) <= alignof(std::max_align_t)) {
+                void* block = acquireLargeBlock();
+                try {
+                    event = new (block) T(std::forward<Args>(args)...);
+                }
+                catch (...) {
+                    releaseLargeBlock(block);
+                    throw;
+                }
+                m_destroy = [](EventSlot& slot) {
+                    T* event = static_cast<T*>(slot.m_event);
+                    event->~T();
+                    releaseLargeBlock(event);
+                };
+            }
+            else {
+                event = new T(std::forward<Args>(args)...);
+                m_destroy = [](EventSlot& slot) { delete static_cast<T*>(slot.m_event); };
+            }
+            m_event = event;
+            return *event;
+        }
+
+        /**
+         * @brief 销毁槽位中的事件，槽位变为空
+         */
+        inline void reset() {
+            if (m_destroy != nullptr) {
+                m_destroy(*this);
+                m_destroy = nullptr;
+                m_relocate = nullptr;
+                m_event = nullptr;
+            }
+        }
+
+        inline bool empty() const { return m_event == nullptr; }
+        inline explicit operator bool() const { return m_event != nullptr; }
+
+        inline Event& get() const { return *m_event; }
+        inline Event& operator*() const { return *m_event; }
+        inline Event* operator->() const { return m_event; }
+
+    private:
+        inline void moveFrom(EventSlot& other) {
+            if (other.m_relocate != nullptr)
+                other.m_relocate(other, *this);
+            else
+                m_event = other.m_event;
+            m_destroy = std::exchange(other.m_destroy, nullptr);
+            m_relocate = std::exchange(other.m_relocate, nullptr);
+            other.m_event = nullptr;
+        }
+
+        /**
+         * @brief 从大块对象池中申请一块，对象池用完了在堆上分配
+         */
+        static void* acquireLargeBlock();
+        static void releaseLargeBlock(void* block);
+
+        alignas(std::max_align_t) unsigned char m_storage[s_inlineSize];
+        Event* m_event = nullptr;                               // 指向槽位内部或者槽位外部的事件
+        void (*m_destroy)(EventSlot&) = nullptr;
+        void (*m_relocate)(EventSlot& from, EventSlot& to) = nullptr;   // 为nullptr表示事件在槽位外部，移动时只需要转移指针
+    };
+
+    /**
+     * @brief 事件队列，单例类，这个类线程安全
+     * @note - 内部是一个有界的无锁多生产者单消费者环形队列，GLFW 回调和工作线程投递事件时互相之间没有锁竞争
+     * @note - 事件按值存放在 EventSlot 中，投递和取出内置事件都不会分配内存
+     * @note - 队列满时按照 OverflowPolicy 处理，默认丢弃新事件并计数
+     * @note - 可以为高频事件开启合并，见 setCoalescing()
+     * @note - 主循环使用 drain() 一次取出一帧的所有事件，逐个取出使用 pollEvent()
+     * @warning pollEvent() 和 drain() 只能由同一个线程（主线程）调用
+     */
+    class HAZY_API EventQueue {
+    public:
+        /**
+         * @brief 队列满时如何处理新的事件
+         */
+        enum class OverflowPolicy : uint8_t {
+            DropNewest, // 丢弃新的事件，记录丢弃的数量
+            Block       // 等待主线程取出事件腾出位置，在主线程上投递（比如 GLFW 回调），或者还没有线程取过事件时退化为 DropNewest，避免死锁
+        };
+
+        // 队列的容量，队列中最多同时有这么多个事件
+        static constexpr size_t s_capacity = 4096;
+
+        EventQueue(EventQueue&) = delete;
+        EventQueue(EventQueue&&) = delete;
+        EventQueue& operator=(EventQueue&) = delete;
+        EventQueue& operator=(EventQueue&&) = delete;
+
+        ~EventQueue() {
+            Logger::LogTrace("EventQueue destroyed");
+        }
+
+        /**
+         * @brief 从事件队列中拉取事件，只有主线程可以调用
+         * @return EventSlot 存放着事件的槽位，队列为空时槽位也为空
+         */
+        inline static EventSlot pollEvent() {
+            init();
+            registerConsumer();
+            EventSlot slot;
+            if (s_ring.tryPop(slot)) {
+                if (isCoalescing(slot->getType()))
+                    coalesce(slot);
+                slot->markDequeued(EventClock::now());
+            }
+            return slot;
+        }
+
+        /**
+         * @brief 一次取出当前所有已经投递的事件，只有主线程可以调用
+         * @return std::span<EventSlot> 按投递顺序排列的事件，连续存放，在下一次调用 drain() 之前有效
+         * @note - 只和生产者同步一次：调用时还没有投递完成的事件，以及处理这一批事件时新投递的事件，都留到下一次
+         * @note - 生产者继续往环形队列中投递，主线程处理自己的这一批，两者互不干扰
+         * @note - 开启了合并的事件在这一批中同样会被合并
+         * @note - 存放这一批事件的缓冲区预先分配了 s_capacity 个槽位，不会分配内存
+         * @note - 这一批事件的出队时间（EventTimestamps::dequeued）相同，都是调用 drain() 的时间
+         */
+        static std::span<EventSlot> drain();
+
+        inline static bool isEmpty() { return s_ring.empty(); }
+
+        /**
+         * @brief 正在排队的事件的大致数量，只用于统计
+         */
+        inline static size_t getPendingCount() { return s_ring.size(); }
+
+        /**
+         * @brief 因为队列满而被丢弃的事件的总数
+         */
+        inline static size_t getDroppedCount() { return s_droppedCount.load(std::memory_order_relaxed); }
+
+        inline static void setOverflowPolicy(OverflowPolicy policy) { s_overflowPolicy.store(policy, std::memory_order_relaxed); }
+        inline static OverflowPolicy getOverflowPolicy() { return s_overflowPolicy.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 开启或者关闭某一种事件的合并，默认全部关闭
+         * @param type 事件类型，只支持 MouseMoved、MouseScrolled、WindowResize、WindowMoved
+         * @param enabled 是否开启
+         * @throws std::invalid_argument 这种事件不能合并
+         * @note 取出事件的时候，紧跟在它后面的同一个窗口的同类事件会被合并成一个：
+         * 鼠标移动、窗口大小改变、窗口移动只保留最新的那一个，滚动事件的偏移量会被累加。
+         * 只合并相邻的事件，所以事件之间的先后顺序（比如鼠标移动和鼠标按下）不会改变。
+         * 合并之后的事件保留最早的那一个事件的投递时间，输入延迟从用户最早的那一次操作开始计算
+         */
+        static void setCoalescing(EventType type, bool enabled);
+
+        inline static bool isCoalescing(EventType type) {
+            return (s_coalescingMask.load(std::memory_order_relaxed) & (1u << static_cast<uint32_t>(type))) != 0;
+        }
+
+        /**
+         * @brief 因为合并而省掉的事件的总数
+         */
+        inline static size_t getCoalescedCount() { return s_coalescedCount.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 将事件放置于队列，如果这个事件没有被处理
+         * @tparam T 事件类型（自动推导）
+         * @param event 事件，会被移动到队列中
+         * @note 事件的投递时间（EventTimestamps::queued）是调用这个函数的时间
+         */
+        template<extendsFrom<Event> T>
+        inline static void pushEvent(T& event) {
+            emplaceEvent<T>(std::move(event));
+        }
+
+        /**
+         * @brief 将事件放置于队列
+         * @tparam T 事件类型（指定）
+         * @param[in] args 事件构造函数参数
+         */
+        template<extendsFrom<Event> T, typename... Args>
+        inline static void emplaceEvent(Args&&... args) {
+            init();
+            EventSlot slot;
+            slot.emplace<T>(std::forward<Args>(args)...).markQueued(EventClock::now());
+            if (!s_ring.tryPush(std::move(slot)))
+                onOverflow(std::move(slot));
+        }
+
+    private:
+
+        inline static void init() {
+            std::call_once(s_initialzed,
+                [] {
+                    s_eventQueue.reset(new EventQueue());
+                    std::atexit([] { s_eventQueue.reset(); });
+                });
+        }
+
+        EventQueue() {
+            Logger::LogTrace("EventQueue created");
+        }
+
+        /**
+         * @brief 队列满了，按照 OverflowPolicy 处理这个事件
+         */
+        static void onOverflow(EventSlot slot);
+
+        /**
+         * @brief 把队首紧跟着的同一个窗口的同类事件合并到 slot 中，只有消费者线程可以调用
+         */
+        static void coalesce(EventSlot& slot);
+
+        inline static void registerConsumer() {
+            std::thread::id current = std::this_thread::get_id();
+            if (s_consumerThread.load(std::memory_order_relaxed) != current)
+                s_consumerThread.store(current, std::memory_order_relaxed);
+        }
+
+        static std::once_flag s_initialzed;
+        static UniqueRef<EventQueue> s_eventQueue;
+
+        static MpscRing<EventSlot> s_ring;                      // 代办事件清单
+        static std::atomic<OverflowPolicy> s_overflowPolicy;
+        static std::atomic<size_t> s_droppedCount;
+        static std::atomic<uint32_t> s_coalescingMask;          // 第 n 位表示 EventType 为 n 的事件是否合并
+        static std::atomic<size_t> s_coalescedCount;
+        static std::atomic<std::thread::id> s_consumerThread;   // 最近一次调用 pollEvent() 或者 drain() 的线程
+        static std::vector<EventSlot> s_batch;                  // drain() 取出的这一批事件，只有主线程访问
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Definition.h"
+#include "Hazy/EventSystem/EventQueue.h"
+
+namespace Hazy {
+
+    /**
+     * @brief 事件录制文件的格式
+     * @note 文件头是 s_magic 和一个字节的版本号，后面是一条条记录，每一条记录以一个字节的 EventType 开头：
+     * @note - EventType::None：窗口记录，后面是窗口标题的长度（变长整数）和标题，第 n 条窗口记录的窗口编号为 n，0 表示没有窗口
+     * @note - 其他：事件记录，后面是距离上一条事件记录的帧数、投递时间的差值（纳秒，有符号）、窗口编号（都是变长整数），然后是事件自己的数据
+     */
+    struct EventRecordFormat {
+        static constexpr std::array<char, 4> s_magic { 'H', 'Z', 'E', 'R' };
+        static constexpr uint8_t s_version = 1;
+    };
+
+    /**
+     * @brief 事件录制器，把分发的事件（类型、数据、窗口、帧号、投递时间）写入一个紧凑的二进制文件，用 EventReplay 回放
+     * @note - 只能录制内置的窗口事件、键盘事件和鼠标事件，其他事件（比如自定义事件）会被跳过并计数
+     * @note - 窗口按照标题记录，回放时按照标题找到对应的窗口
+     * @note - 数据先写入内存中的缓冲区，缓冲区满了或者调用 flush() 时才写入文件
+     * @warning 只能在分发事件的线程（主线程）上使用
+     */
+    class HAZY_API EventRecorder {
+    public:
+        /**
+         * @brief 创建录制文件，已经存在的文件会被覆盖
+         * @param path 文件路径
+         * @param startFrame 开始录制时的帧号，记录的帧号都相对于这一帧
+         * @throws std::runtime_error 文件打不开
+         */
+        explicit EventRecorder(const std::string& path, uint64_t startFrame = 0);
+
+        /**
+         * @brief 把缓冲区中剩下的数据写入文件
+         */
+        ~EventRecorder();
+
+        EventRecorder(const EventRecorder&) = delete;
+        EventRecorder& operator=(const EventRecorder&) = delete;
+
+        /**
+         * @brief 录制一个事件
+         * @param event 事件
+         * @param frame 分发这个事件时的帧号，不能小于上一次录制时的帧号
+         * @return true 录制成功
+         * @return false 这种事件不能录制，被跳过了
+         */
+        bool record(const Event& event, uint64_t frame);
+
+        /**
+         * @brief 把缓冲区中的数据写入文件
+         * @throws std::runtime_error 写入失败
+         */
+        void flush();
+
+        inline size_t getRecordedCount() const { return m_recordedCount; }
+        inline size_t getSkippedCount() const { return m_skippedCount; }
+
+    private:
+        // 缓冲区超过这个大小就写入文件
+        static constexpr size_t s_flushThreshold = 64 * 1024;
+
+        uint32_t windowId(const Window* window);
+
+        std::string m_path;
+        std::ofstream m_file;
+        std::vector<char> m_buffer;
+        std::unordered_map<const Window*, uint32_t> m_windowIds;
+        uint64_t m_lastFrame;
+        int64_t m_lastTime = 0;             // 上一个事件的投递时间，相对于 m_start，单位为纳秒
+        EventClock::time_point m_start;     // 开始录制的时间
+        size_t m_recordedCount = 0;
+        size_t m_skippedCount = 0;
+    };
+
+    /**
+     * @brief 事件回放，把 EventRecorder 录制的事件按照录制时的帧重新构造出来，不需要 GLFW
+     * @note - 整个文件在构造时读入并校验，回放时不会读文件，也不会分配内存
+     * @note - 回放的第 n 帧得到的就是录制的第 n 帧分发的事件，顺序也相同
+     * @note - 回放出来的事件的时间戳是回放时的时间，录制时的投递时间（相对于开始录制）可以用 getRecordedTime() 查询
+     */
+    class HAZY_API EventReplay {
+    public:
+        /**
+         * @brief 根据录制时的窗口标题找到回放时的窗口，返回 nullptr 表示这个窗口的事件不回放
+         * @note 每一个事件都会查找一次，回放过程中窗口可能被创建或者关闭
+         */
+        using WindowResolver = std::function<Window*(std::string_view title)>;
+
+        /**
+         * @brief 读取录制文件
+         * @param path 文件路径
+         * @param resolver 查找窗口的方法，为空时只回放没有窗口的事件
+         * @throws std::runtime_error 文件打不开，不是录制文件，版本不支持，或者文件被截断了
+         */
+        EventReplay(const std::string& path, WindowResolver resolver = nullptr);
+
+        EventReplay(const EventReplay&) = delete;
+        EventReplay& operator=(const EventReplay&) = delete;
+
+        /**
+         * @brief 回放某一帧的所有事件，帧号只能递增
+         * @tparam Func 处理事件的方法，签名为 void(Event&)
+         * @param frame 帧号，相对于开始录制的那一帧
+         * @param func 处理事件的方法，每一个事件调用一次，事件在调用结束之后被销毁
+         * @return size_t 这一帧回放了多少个事件
+         */
+        template<typename Func>
+        size_t replayFrame(uint64_t frame, Func&& func) {
+            size_t count = 0;
+            while (m_next < m_records.size() && m_records[m_next].frame <= frame) {
+                if (m_records[m_next].frame == frame && construct(m_records[m_next])) {
+                    func(*m_slot);
+                    count++;
+                }
+                m_next++;
+            }
+            m_slot.reset();
+            return count;
+        }
+
+        /**
+         * @brief 是否已经回放完所有的事件
+         */
+        inline bool isFinished() const { return m_next >= m_records.size(); }
+
+        /**
+         * @brief 录制的帧数，也就是最后一个事件所在的帧号加一
+         */
+        inline uint64_t getFrameCount() const { return m_records.empty() ? 0 : m_records.back().frame + 1; }
+
+        inline size_t getEventCount() const { return m_records.size(); }
+
+        /**
+         * @brief 因为找不到窗口而没有回放的事件的数量
+         */
+        inline size_t getSkippedCount() const { return m_skippedCount; }
+
+        /**
+         * @brief 最近一次交给 replayFrame() 处理方法的事件在录制时的投递时间，相对于开始录制的时间
+         */
+        inline std::chrono::nanoseconds getRecordedTime() const { return m_recordedTime; }
+
+    private:
+        struct Record {
+            uint64_t frame;
+            int64_t time;       // 投递时间，相对于开始录制，单位为纳秒
+            uint32_t window;    // 窗口编号，0 表示没有窗口
+            EventType type;
+            uint8_t code;       // 键、鼠标按键
+            uint8_t mod;        // 修饰键
+            union {
+                struct { uint32_t width, height; } size;
+                struct { int32_t x, y; } position;
+                struct { float x, y; } offset;
+                int32_t repeatCount;
+            };
+        };
+
+        /**
+         * @brief 在 m_slot 中构造记录对应的事件
+         * @return false 找不到事件所在的窗口
+         */
+        bool construct(const Record& record);
+
+        std::vector<Record> m_records;
+        std::vector<std::string> m_windowTitles;    // 第 n - 1 个是编号为 n 的窗口的标题
+        WindowResolver m_resolver;
+        EventSlot m_slot;
+        size_t m_next = 0;
+        size_t m_skippedCount = 0;
+        std::chrono::nanoseconds m_recordedTime { 0 };
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Definition.h"
+#include "Hazy/EventSystem/Event.h"
+
+namespace Hazy {
+
+    /**
+     * @brief 输入延迟的统计阶段
+     */
+    enum class LatencyStage : uint8_t {
+        QueueWait,      // 投递到事件队列 -> 主线程取出
+        DispatchDelay,  // 主线程取出 -> 开始分发
+        Present,        // 开始分发 -> 这一帧交换缓冲区（SwapBuffers 返回）
+        Total           // 投递到事件队列 -> 这一帧交换缓冲区，也就是输入到呈现的延迟
+    };
+
+    /**
+     * @brief 某一个阶段的延迟统计
+     */
+    struct LatencyStats {
+        size_t count = 0;   // 参与统计的样本数量
+        std::chrono::nanoseconds p50 { 0 };
+        std::chrono::nanoseconds p90 { 0 };
+        std::chrono::nanoseconds p99 { 0 };
+        std::chrono::nanoseconds max { 0 };
+    };
+
+    /**
+     * @brief 输入到呈现的延迟统计，单例类，这个类线程安全
+     * @note - 输入事件（EventCategory::Input、Keyboard、Mouse）分发之后被记在产生它的窗口上，
+     * 窗口在这一帧交换缓冲区之后把它们作为样本交给这个类，一个事件就是一个样本
+     * @note - 只保留最近 s_sampleCapacity 个样本，统计的是最近一段时间的延迟
+     * @note - 默认开启，关闭之后窗口不再记录输入事件，只剩下事件队列打时间戳的开销
+     */
+    class HAZY_API InputLatency {
+    public:
+        // 最多保留多少个样本
+        static constexpr size_t s_sampleCapacity = 4096;
+
+        InputLatency() = delete;
+
+        inline static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+        inline static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 记录在同一帧中呈现出来的一批输入事件
+         * @param events 这些事件的时间戳
+         * @param presented 交换缓冲区完成的时间
+         */
+        static void recordPresent(std::span<const EventTimestamps> events, EventClock::time_point presented);
+
+        /**
+         * @brief 获取某一个阶段的延迟的百分位数
+         * @param stage 统计的阶段
+         * @return LatencyStats 没有样本时全部为0
+         */
+        static LatencyStats getStats(LatencyStage stage = LatencyStage::Total);
+
+        /**
+         * @brief 获取某一个阶段的延迟的任意百分位数
+         * @param stage 统计的阶段
+         * @param percentile 百分位数，范围是 [0, 100]
+         * @return std::chrono::nanoseconds 没有样本时为0
+         * @throws std::out_of_range 百分位数超出范围
+         */
+        static std::chrono::nanoseconds getPercentile(LatencyStage stage, double percentile);
+
+        /**
+         * @brief 获取至今为止记录过的样本的总数，包括已经被新样本覆盖的
+         */
+        static size_t getSampleCount();
+
+        /**
+         * @brief 丢弃所有样本，比如调整了队列深度或者帧节奏之后重新统计
+         */
+        static void reset();
+
+    private:
+        struct Sample {
+            std::chrono::nanoseconds stages[4];
+        };
+
+        /**
+         * @brief 把某一个阶段的样本按照从小到大的顺序复制到 s_sorted 中，调用者需要持有 s_mutex
+         */
+        static void sortStage(LatencyStage stage);
+
+        /**
+         * @brief 在已经排好序的 s_sorted 中取百分位数（最近秩法）
+         */
+        static std::chrono::nanoseconds pick(double percentile);
+
+        static std::atomic<bool> s_enabled;
+        static std::mutex s_mutex;
+        static std::vector<Sample> s_samples;                   // 环形缓冲区，写满之后覆盖最旧的样本
+        static size_t s_total;                                  // 记录过的样本总数，s_total % s_sampleCapacity 是下一个写入位置
+        static std::vector<std::chrono::nanoseconds> s_sorted;  // 计算百分位数时使用的缓冲区
+    };
+
+}
\ No newline at end of file
@@ -4,7 +4,7 @@
 namespace Hazy {
     
     /**
-     * @brief 键盘事件的基类，只重写了getCategoryFlags，还有三个函数：getStaticType()、getType()、toString()
+     * @brief 键盘事件的基类，只重写了getCategoryFlags，还有三个函数：getStaticType()、getType()、formatTo()
      * 
      */
     class HAZY_API KeyEvent : public Event {
@@ -30,16 +30,13 @@ namespace Hazy {
             : KeyEvent(key, mod, window), m_repeatCount(repeatCount) { }
         inline int getRepeatCount() const { return m_repeatCount; }
 
-        inline static EventType getStaticType() { return EventType::KeyPressed; }
+        static constexpr EventType getStaticType() { return EventType::KeyPressed; }
         inline EventType getType() const override { return EventType::KeyPressed; }
 
-        inline std::string_view toString() const override {
-            std::stringstream ss;
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
             if (m_repeatCount == 0)
-                ss << "KeyPressedEvent -- " << " Key: " << KeyToString(KeyEvent::getKey()) << " Mod: " << ModifierKeyToString(KeyEvent::getMod()) << " window: " << Event::getWindow()->getProps().title;
-            else
-                ss << "KeyPressedEvent -- RepeatCount: " << m_repeatCount << " Key: " << KeyToString(KeyEvent::getKey()) << " Mod: " << ModifierKeyToString(KeyEvent::getMod()) << " window: " << Event::getWindow()->getProps().title;
-            return ss.str();
+                return fmt::format_to(out, "KeyPressedEvent -- Key: {} Mod: {} window: {}", getKey(), getMod(), windowTitle());
+            return fmt::format_to(out, "KeyPressedEvent -- RepeatCount: {} Key: {} Mod: {} window: {}", m_repeatCount, getKey(), getMod(), windowTitle());
         }
 
     private:
@@ -53,13 +50,10 @@ namespace Hazy {
     public:
         KeyReleasedEvent(Key key, ModifierKey mod, Window* window) : KeyEvent(key, mod, window) { }
 
-        inline static EventType getStaticType() { return EventType::KeyReleased; }
+        static constexpr EventType getStaticType() { return EventType::KeyReleased; }
         inline EventType getType() const override { return EventType::KeyReleased; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "KeyReleasedEvent -- Key: " << KeyToString(KeyEvent::getKey()) << " window: "
-                << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "KeyReleasedEvent -- Key: {} Mod: {} window: {}", getKey(), getMod(), windowTitle());
         }
     };
 
@@ -10,13 +10,11 @@ namespace Hazy {
         inline MouseButton getMouseButton() const { return m_button; }
         inline ModifierKey getMod() const { return m_mod; }
 
-        inline static EventType getStaticType() { return EventType::MouseButtonPressed; }
+        static constexpr EventType getStaticType() { return EventType::MouseButtonPressed; }
         inline EventType getType() const override { return EventType::MouseButtonPressed; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Mouse | EventCategory::Input; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "MouseButtonPressedEvent -- Button: " << MouseButtonToString(m_button) << " Mod: " << ModifierKeyToString(m_mod) << " window: " << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "MouseButtonPressedEvent -- Button: {} Mod: {} window: {}", m_button, m_mod, windowTitle());
         }
     private:
         MouseButton m_button;
@@ -30,13 +28,11 @@ namespace Hazy {
         inline MouseButton getMouseButton() const { return m_button; }
         inline ModifierKey getMod() const { return m_mod; }
 
-        inline static EventType getStaticType() { return EventType::MouseButtonReleased; }
+        static constexpr EventType getStaticType() { return EventType::MouseButtonReleased; }
         inline EventType getType() const override { return EventType::MouseButtonReleased; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Mouse | EventCategory::Input; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "MouseButtonReleasedEvent -- Button: " << MouseButtonToString(m_button) << " Mod: " << ModifierKeyToString(m_mod) << " window: " << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "MouseButtonReleasedEvent -- Button: {} Mod: {} window: {}", m_button, m_mod, windowTitle());
         }
     private:
         MouseButton m_button;
@@ -50,13 +46,11 @@ namespace Hazy {
         inline float getX() const { return m_mouseX; }
         inline float getY() const { return m_mouseY; }
 
-        inline static EventType getStaticType() { return EventType::MouseMoved; }
+        static constexpr EventType getStaticType() { return EventType::MouseMoved; }
         inline EventType getType() const override { return EventType::MouseMoved; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Mouse | EventCategory::Input; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "MouseMovedEvent -- X: " << m_mouseX << " Y: " << m_mouseY << " window: " << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "MouseMovedEvent -- X: {} Y: {} window: {}", m_mouseX, m_mouseY, windowTitle());
         }
     private:
         float m_mouseX, m_mouseY;
@@ -68,14 +62,20 @@ namespace Hazy {
 
         inline float getXOffset() const { return m_xOffset; }
         inline float getYOffset() const { return m_yOffset; }
+
+        /**
+         * @brief 把另一个滚动事件的偏移量累加到这个事件上，用于合并连续的滚动事件
+         */
+        inline void accumulate(const MouseScrolledEvent& other) {
+            m_xOffset += other.m_xOffset;
+            m_yOffset += other.m_yOffset;
+        }
         
-        inline static EventType getStaticType() { return EventType::MouseScrolled; }
+        static constexpr EventType getStaticType() { return EventType::MouseScrolled; }
         inline EventType getType() const override { return EventType::MouseScrolled; }
         inline EventCategory getCategoryFlags() const override { return EventCategory::Mouse | EventCategory::Input; }
-        inline std::string_view toString() const override {
-            std::stringstream ss;
-            ss << "MouseScrolledEvent -- XOffset: " << m_xOffset << " YOffset: " << m_yOffset << " window:  " << Event::getWindow()->getProps().title;
-            return ss.str();
+        inline fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "MouseScrolledEvent -- XOffset: {} YOffset: {} window: {}", m_xOffset, m_yOffset, windowTitle());
         }
     private:
         float m_xOffset, m_yOffset;
@@ -1,5 +1,6 @@
 #pragma once
 #include "Hazy/Definition.h"
+#include "Hazy/EventSystem/EventBus.h"
 
 namespace Hazy {
 
@@ -15,13 +16,16 @@ namespace Hazy {
 
     /**
      * @brief 层的基类，每一个层都属于某一个窗口
+     * @note 层默认接收所有事件，可以通过 EventListener 的 subscribe()/unsubscribe() 只订阅自己关心的事件，
+     * 事件被某一个层处理（markDone()）之后不会再传给后面的层
      */
-    class HAZY_API Layer {
+    class HAZY_API Layer : public EventListener {
     public:
         explicit Layer(Window* window) : m_window(window) { }
         virtual ~Layer() = default;
         virtual void update() { }
-        virtual void onEvent(Event&) { }
+
+        inline bool isListening() const override { return m_enabled; }
 
         inline bool isEnabled() const { return m_enabled; }
         inline void enable()  { m_enabled = true; }
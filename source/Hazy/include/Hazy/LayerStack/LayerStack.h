@@ -13,20 +13,18 @@ namespace Hazy {
         virtual void popLayer(Layer* layer);
         virtual void popOverlay(Layer* overlay);
 
-        inline void onEvent(Event& e) {
-            for (Layer* layer : m_layers) {
-                if (layer->isEnabled()) {
-                    layer->onEvent(e);
-                }
-            }
-        }
+        /**
+         * @brief 把事件分发给订阅了它的层，按照层的顺序，事件被处理之后停止传播
+         */
+        inline void onEvent(Event& e) { m_eventBus.publish(e); }
 
         inline std::vector<Layer*>::iterator begin() { return m_layers.begin(); }
         inline std::vector<Layer*>::iterator end()   { return m_layers.end(); }
 
     private:
         std::vector<Layer*> m_layers;
-        std::vector<Layer*>::iterator m_layerInsert;    // 这个迭代器始终指向这个vector的第一个元素
+        size_t m_layerInsertIndex = 0;                  // 下一个层插入的位置，用下标而不是迭代器，pushOverlay() 扩容之后迭代器会失效
+        EventBus m_eventBus;                            // 和 m_layers 保持相同的顺序
     };
     
 }
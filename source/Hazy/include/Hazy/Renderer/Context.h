@@ -9,6 +9,7 @@
 #include "Hazy/Renderer/Texture.h"
 #include "Hazy/Renderer/VertexArray.h"
 #include "Hazy/Renderer/Renderer.h"
+#include "Hazy/Util/Dispatcher.hpp"
 
 extern "C" {
     struct GLFWwindow;
@@ -50,15 +51,44 @@ namespace Hazy {
     public:
         Context(Window* window) : m_window(window) { }
         virtual ~Context() { }
+
+        /**
+         * @brief 交换缓冲区，然后处理窗口系统的事件，相当于 Present() 之后再 PollEvents()
+         */
         virtual void SwapBuffers() = 0;
 
+        /**
+         * @brief 只交换缓冲区，不处理窗口系统的事件，可以在渲染线程中调用
+         */
+        virtual void Present() = 0;
+
+        /**
+         * @brief 处理窗口系统的事件（所有窗口的），事件的回调在调用的线程中执行
+         * @warning 只能在主线程调用
+         */
+        virtual void PollEvents() = 0;
+
+        /**
+         * @brief 把上下文绑定到当前线程，同一个线程中可以嵌套，只有最外层的绑定会切换上下文
+         * @throws std::logic_error 上下文已经绑定在其他线程上（比如窗口的渲染线程），这时请使用 Window::postToRenderThread()
+         */
         virtual void bind() = 0;
+
+        /**
+         * @brief 解除绑定，和同一个线程中的 bind() 成对使用，最外层的解除绑定才会让当前线程不再持有上下文
+         */
         virtual void unbind() = 0;
 
         virtual inline void setUserPointer(void* userPointer) { m_userPointerPair.second = userPointer; }
         virtual inline void* getUserPointer() { return m_userPointerPair.second; }
         virtual inline Window* getWindow() { return m_window; }
 
+        /**
+         * @brief 获取这个上下文的派发器，投递到这里的函数会在拥有这个上下文的线程中、上下文绑定之后执行
+         * @return Dispatcher& 派发器
+         */
+        inline Dispatcher& getDispatcher() { return m_dispatcher; }
+
         // 获取原生窗口
         virtual void* getNativeWindow() = 0;
 
@@ -149,6 +179,11 @@ namespace Hazy {
             const std::string& path,
             TextureType type = TextureType::Diffuse) = 0;
 
+        virtual Texture2D& createTexture2D(
+            const std::string& name,
+            const ImageData& image,
+            TextureType type = TextureType::Diffuse) = 0;
+
         virtual Texture3D& createTexture3D(
             const std::string& name,
             const std::string& path,
@@ -165,6 +200,9 @@ namespace Hazy {
         UserPointerPair m_userPointerPair;
         bool m_isVSync = true;
         Window* m_window;
+
+        // 需要在这个上下文中执行的函数
+        Dispatcher m_dispatcher;
     };
     using ContextLock = BindLock<Context>;
 
@@ -178,6 +216,8 @@ namespace Hazy {
             GLFWwindow* share = nullptr);
         virtual ~OpenGLContext();
         virtual void SwapBuffers() override;
+        virtual void Present() override;
+        virtual void PollEvents() override;
 
         virtual void* getNativeWindow() override { return m_nativeWindow; }
 
@@ -278,6 +318,18 @@ namespace Hazy {
             throw std::logic_error("Texture already exists");
         }
 
+        inline virtual Texture2D& createTexture2D(
+            const std::string& name,
+            const ImageData& image,
+            TextureType type = TextureType::Diffuse
+        ) override {
+            if (library.texture2Ds.find(name) == library.texture2Ds.end()) {
+                library.texture2Ds.emplace(name, new OpenGLTexture2D(image, type));
+                return *library.texture2Ds.at(name);
+            }
+            throw std::logic_error("Texture already exists");
+        }
+
         inline virtual Texture3D& createTexture3D(
             const std::string& name,
             const std::string& path,
@@ -306,6 +358,9 @@ namespace Hazy {
 
         GLFWwindow* m_nativeWindow;
 
+        // 持有这个上下文的线程，没有线程持有时为默认值，嵌套绑定的层数记在这个线程自己的绑定栈中
+        std::atomic<std::thread::id> m_owner;
+
         static std::once_flag s_GLADInitialized;
         static std::once_flag s_GLFWInitialized;
     };
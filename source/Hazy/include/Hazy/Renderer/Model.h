@@ -8,6 +8,7 @@ namespace Hazy {
 
     class VertexArray;
     class Context;
+    struct PendingTextures;
 
     template<int dimension>
     class Texture;
@@ -33,7 +34,8 @@ namespace Hazy {
 
     /**
      * @brief 模型类，用于加载模型文件
-     * @note 由于在创建它的时候必须要创建VertexBuffer等其他 GPU 资源，所以构造函数的参数中有一个 Context，表示这个模型属于哪一个上下文
+     * @note - 由于在创建它的时候必须要创建VertexBuffer等其他 GPU 资源，所以构造函数的参数中有一个 Context，表示这个模型属于哪一个上下文
+     * @note - 模型文件通过 AsyncIO 读取，材质用到的纹理在解析网格之前就交给线程池并行读取和解码，渲染线程只负责上传
      * @warning 请勿直接new一个Model，而是使用Context的Create方法加载模型
      */
     class Model {
@@ -44,7 +46,7 @@ namespace Hazy {
         inline const std::vector<Mesh>& getMeshes() const { return m_meshes; }
 
     private:
-        void processNode(Context& context, aiNode* node, const aiScene* scene, const std::string& name);
+        void processNode(Context& context, aiNode* node, const aiScene* scene, const std::string& name, PendingTextures& textures);
         
         std::vector<Mesh> m_meshes;
     };
@@ -0,0 +1,78 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Definition.h"
+
+namespace Hazy {
+
+    /**
+     * @brief 渲染线程，一次执行一帧提交过来的渲染工作，和提交它的线程（主线程）流水线并行
+     * @note - 同时最多只有一帧在执行：提交新的一帧之前先等待上一帧完成，两个线程之间交换的数据只需要双缓冲
+     * @note - 调用 wait() 返回之后到下一次 submit() 之前是同步点，渲染线程是空闲的，主线程可以安全地交换帧数据
+     * @note - 某一帧抛出的异常会被保存下来，在主线程下一次 wait() 或者 submit() 时重新抛出
+     * @warning submit() 和 wait() 只能由同一个线程调用
+     */
+    class HAZY_API RenderThread {
+    public:
+        /**
+         * @brief 启动渲染线程
+         * @param name 线程的名字，用于调试
+         */
+        explicit RenderThread(const std::string& name = "HazyRender");
+
+        /**
+         * @brief 等待正在执行的帧完成，然后结束线程，这一帧的异常会被记录然后丢弃
+         */
+        ~RenderThread();
+
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        /**
+         * @brief 提交一帧，上一帧还没有完成时先等待它完成
+         * @param frame 这一帧的渲染工作，在渲染线程中执行
+         * @throws 上一帧抛出的异常，这时新的一帧不会被提交
+         */
+        void submit(std::function<void()> frame);
+
+        /**
+         * @brief 等待正在执行的帧完成，没有正在执行的帧时立即返回
+         * @throws 这一帧抛出的异常
+         */
+        void wait();
+
+        /**
+         * @brief 是否有一帧已经提交了，但是还没有执行完
+         */
+        bool isBusy() const;
+
+        /**
+         * @brief 当前线程是不是这个渲染线程
+         */
+        inline bool isCurrentThread() const { return std::this_thread::get_id() == m_thread.get_id(); }
+
+        /**
+         * @brief 已经执行完的帧数
+         */
+        inline uint64_t getFrameCount() const { return m_frameCount.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 主线程最近一次在 wait() 或者 submit() 中等待渲染线程的时间，接近0说明渲染不是瓶颈
+         */
+        inline std::chrono::nanoseconds getLastWaitTime() const { return m_lastWaitTime; }
+
+    private:
+        void run(std::string name);
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_frameReady;   // 有新的一帧，或者要结束线程
+        std::condition_variable m_frameDone;    // 正在执行的帧完成了
+        std::function<void()> m_frame;          // 已经提交还没有开始执行的帧
+        bool m_busy = false;                    // 有一帧已经提交了，但是还没有执行完
+        bool m_stopping = false;
+        std::exception_ptr m_exception;         // 最近一帧抛出的异常，交给主线程重新抛出
+        std::atomic<uint64_t> m_frameCount = 0;
+        std::chrono::nanoseconds m_lastWaitTime { 0 };  // 只有主线程访问
+        std::thread m_thread;                   // 最后构造，线程启动时其他成员都已经初始化了
+    };
+
+}
\ No newline at end of file
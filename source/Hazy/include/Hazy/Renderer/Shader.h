@@ -85,7 +85,14 @@ namespace Hazy {
     private:
 
         int findUniformLocation(const std::string& name);
-        uint32_t compileShader(const std::string& path, uint32_t type);
+
+        /**
+         * @brief 编译着色器
+         * @param source 着色器源码，由 AsyncIO 读取
+         * @param type 着色器类型
+         * @return uint32_t 着色器ID
+         */
+        uint32_t compileShader(std::string_view source, uint32_t type);
         void linkProgram(uint32_t vertShader, uint32_t fragShader, uint32_t geomShader = 0);
 
     private:
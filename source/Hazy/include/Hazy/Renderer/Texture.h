@@ -7,6 +7,37 @@ namespace Hazy {
     template <int dimension>
     using TextureWrapVec = glm::vec<dimension, TextureWrap, glm::qualifier::defaultp>;
 
+    /**
+     * @brief 解码之后的图片数据，解码不需要上下文，可以在工作线程中进行，然后在渲染线程中交给纹理上传
+     * @note 只能移动，不能拷贝
+     */
+    struct HAZY_API ImageData {
+        struct PixelDeleter {
+            void operator()(uint8_t* pixels) const;
+        };
+
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        std::unique_ptr<uint8_t[], PixelDeleter> pixels;
+
+        inline bool valid() const { return pixels != nullptr; }
+
+        /**
+         * @brief 从内存中解码一张图片，解码之后上下翻转（OpenGL 纹理坐标的原点在左下角）
+         * @param encoded 图片文件的内容
+         * @return ImageData 解码之后的数据，解码失败时 valid() 返回false
+         */
+        static ImageData decode(std::span<const char> encoded);
+
+        /**
+         * @brief 通过 AsyncIO 读取图片文件并解码，等待读取的时候会帮忙执行线程池中的任务
+         * @param path 图片文件路径
+         * @return ImageData 解码之后的数据，文件打不开或者解码失败时 valid() 返回false
+         */
+        static ImageData load(const std::string& path);
+    };
+
     /**
      * @brief 纹理类，用于存储纹理数据
      * @tparam dimension 维度，2为2D纹理，3为3D纹理
@@ -87,6 +118,13 @@ namespace Hazy {
     public:
         
         OpenGLTexture(const std::string& path, TextureType type);
+
+        /**
+         * @brief 使用已经解码好的图片数据创建纹理，只需要上传，不需要读取和解码
+         * @param image 图片数据
+         * @param type 纹理类型
+         */
+        OpenGLTexture(const ImageData& image, TextureType type);
         ~OpenGLTexture();
 
         virtual void bind(uint8_t slot) override;
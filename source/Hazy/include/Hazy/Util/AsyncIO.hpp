@@ -0,0 +1,159 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Util/Log.h"
+#include "Hazy/Util/ThreadPool.hpp"
+
+namespace Hazy {
+
+    class IOBufferPool;
+
+    /**
+     * @brief 异步读取得到的文件内容，存储空间来自 IOBufferPool，销毁时归还，下一次读取可以直接复用
+     * @note 只能移动，不能拷贝
+     */
+    class HAZY_API IOBuffer {
+        friend class IOBufferPool;
+    public:
+        IOBuffer() = default;
+        IOBuffer(IOBuffer&& other) noexcept;
+        IOBuffer& operator=(IOBuffer&& other) noexcept;
+        IOBuffer(const IOBuffer&) = delete;
+        IOBuffer& operator=(const IOBuffer&) = delete;
+        ~IOBuffer();
+
+        inline char* data() { return m_storage.get(); }
+        inline const char* data() const { return m_storage.get(); }
+        inline size_t size() const { return m_size; }
+        inline size_t capacity() const { return m_capacity; }
+        inline bool empty() const { return m_size == 0; }
+
+        inline std::span<const char> span() const { return { m_storage.get(), m_size }; }
+        inline std::string_view view() const { return { m_storage.get(), m_size }; }
+
+        /**
+         * @brief 修改有效数据的长度，不会重新分配存储空间
+         * @param size 新的长度，不能超过 capacity()
+         * @throws std::length_error 超过了容量
+         */
+        void resize(size_t size);
+
+    private:
+        IOBuffer(UniqueRef<char[]> storage, size_t capacity, size_t size, Ref<IOBufferPool> pool);
+
+        void reset();
+
+        UniqueRef<char[]> m_storage;
+        size_t m_capacity = 0;
+        size_t m_size = 0;
+        Ref<IOBufferPool> m_pool;
+    };
+
+    /**
+     * @brief 读取缓冲区的对象池，缓存一定数量的空闲缓冲区，申请时选择容量足够的最小的那一个
+     * @note 线程安全，缓冲区可以在任意线程归还
+     */
+    class HAZY_API IOBufferPool : public std::enable_shared_from_this<IOBufferPool> {
+    public:
+        /**
+         * @param maxCached 最多缓存多少个空闲缓冲区
+         * @param maxBufferSize 超过这个大小的缓冲区归还时直接释放，不会缓存
+         */
+        IOBufferPool(size_t maxCached = 16, size_t maxBufferSize = 64 * 1024 * 1024)
+            : m_maxCached(maxCached), m_maxBufferSize(maxBufferSize) { }
+
+        /**
+         * @brief 申请一个长度为 size 的缓冲区，内容未初始化
+         * @warning IOBufferPool 必须由 std::shared_ptr 持有
+         */
+        IOBuffer acquire(size_t size);
+
+        size_t getCachedCount() const;
+
+    private:
+        friend class IOBuffer;
+
+        void release(UniqueRef<char[]> storage, size_t capacity);
+
+        struct Block {
+            UniqueRef<char[]> storage;
+            size_t capacity;
+        };
+
+        mutable std::mutex m_mutex;
+        std::vector<Block> m_free;
+        size_t m_maxCached;
+        size_t m_maxBufferSize;
+    };
+
+    /**
+     * @brief 异步文件读取服务，读取的结果通过 PooledFuture 返回
+     * @note - Linux 下使用 io_uring：大文件被切成 s_chunkSize 大小的块同时提交，最多同时有 queueDepth 个读取请求在内核中，
+     * 一个专门的完成线程收割完成事件，读完整个文件之后设置 future 的结果，工作线程不会被 I/O 阻塞
+     * @note - 其他平台，或者内核不支持 io_uring（比如被容器的 seccomp 禁用了）的时候，退回到在线程池中同步读取
+     * @note - 文件在调用线程中打开，只有读取是异步的
+     */
+    class HAZY_API AsyncIO {
+    public:
+        enum class Backend : uint8_t {
+            IoUring,    // Linux io_uring
+            ThreadPool  // 在线程池中同步读取
+        };
+
+        // 每一个读取请求的最大长度
+        static constexpr size_t s_chunkSize = 1024 * 1024;
+
+        /**
+         * @brief 构造异步读取服务
+         * @param pool 退回到线程池读取时使用的线程池
+         * @param queueDepth 最多同时提交给内核的读取请求数量
+         * @param useIoUring 为false时总是使用线程池读取
+         * @note io_uring 初始化失败只会记录警告，然后退回到线程池读取
+         */
+        explicit AsyncIO(ThreadPool& pool, uint32_t queueDepth = 128, bool useIoUring = true);
+
+        /**
+         * @brief 等待所有已经提交的读取完成之后再销毁
+         */
+        ~AsyncIO();
+
+        AsyncIO(const AsyncIO&) = delete;
+        AsyncIO& operator=(const AsyncIO&) = delete;
+
+        /**
+         * @brief 读取整个文件到一个来自缓冲池的缓冲区
+         * @param path 文件路径
+         * @param priority 退回到线程池读取时任务的优先级，io_uring 没有优先级
+         * @return PooledFuture<IOBuffer> 文件内容
+         * @throws 返回的 future 中：std::runtime_error 文件打不开，或者读取失败
+         */
+        PooledFuture<IOBuffer> readFile(const std::string& path, TaskPriority priority = TaskPriority::Background);
+
+        /**
+         * @brief 从文件的 offset 处读取数据到调用者提供的缓冲区
+         * @param path 文件路径
+         * @param buffer 目标缓冲区，在 future 就绪之前必须一直有效
+         * @param offset 从文件的哪一个位置开始读取
+         * @param priority 退回到线程池读取时任务的优先级
+         * @return PooledFuture<size_t> 实际读取的字节数，到达文件末尾时小于 buffer.size()
+         * @throws 返回的 future 中：std::runtime_error 文件打不开，或者读取失败
+         */
+        PooledFuture<size_t> read(const std::string& path, std::span<char> buffer, uint64_t offset = 0, TaskPriority priority = TaskPriority::Background);
+
+        inline Backend getBackend() const { return m_ring ? Backend::IoUring : Backend::ThreadPool; }
+        inline IOBufferPool& getBufferPool() { return *m_bufferPool; }
+
+    private:
+        struct Ring;
+        struct Request;
+
+        /**
+         * @brief 把一个已经打开的文件交给 io_uring 读取，切成若干块提交
+         */
+        void submit(Request* request);
+
+        ThreadPool& m_pool;
+        Ref<IOBufferPool> m_bufferPool;
+        UniqueRef<Ring> m_ring;     // 为nullptr时使用线程池读取
+    };
+
+}
@@ -0,0 +1,296 @@
+#pragma once
+#include <hazy_pch.h>
+
+namespace Hazy {
+
+    /**
+     * @brief 有界的无锁多生产者多消费者环形队列（Vyukov），所有内存在构造的时候一次性分配
+     * @tparam T 元素类型，需要可以默认构造和移动
+     * @note 每一个槽位带有一个序号，生产者和消费者通过比较序号判断槽位是否可用，只在竞争同一个位置时才需要CAS
+     */
+    template <typename T>
+    class BoundedQueue {
+    public:
+        /**
+         * @brief 构造一个环形队列
+         * @param capacity 容量，会向上取整到2的幂
+         */
+        explicit BoundedQueue(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            m_mask = size - 1;
+            m_cells.reset(new Cell[size]);
+            for (size_t i = 0; i < size; i++) {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        /**
+         * @brief 尝试放入一个元素
+         * @param value 元素
+         * @return true 放入成功
+         * @return false 队列已满，value 没有被移动
+         */
+        template <typename U>
+        bool tryPush(U&& value) {
+            Cell* cell;
+            size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+            while (true) {
+                cell = &m_cells[position & m_mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0) {
+                    if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else {
+                    position = m_enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+            cell->value = std::forward<U>(value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief 尝试取出一个元素
+         * @param value 取出的元素
+         * @return true 取出成功
+         * @return false 队列为空
+         */
+        bool tryPop(T& value) {
+            Cell* cell;
+            size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+            while (true) {
+                cell = &m_cells[position & m_mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+                if (difference == 0) {
+                    if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else {
+                    position = m_dequeuePosition.load(std::memory_order_relaxed);
+                }
+            }
+            value = std::move(cell->value);
+            cell->sequence.store(position + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        inline size_t capacity() const { return m_mask + 1; }
+
+        /**
+         * @brief 队列中元素的大致数量，只用于统计
+         */
+        inline size_t size() const {
+            size_t enqueue = m_enqueuePosition.load(std::memory_order_relaxed);
+            size_t dequeue = m_dequeuePosition.load(std::memory_order_relaxed);
+            return enqueue > dequeue ? enqueue - dequeue : 0;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        UniqueRef<Cell[]> m_cells;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_enqueuePosition = 0;
+        alignas(64) std::atomic<size_t> m_dequeuePosition = 0;
+    };
+
+    /**
+     * @brief 有界的无锁多生产者单消费者环形队列，生产者一侧和 BoundedQueue 相同，消费者只有一个，取出时不需要CAS
+     * @tparam T 元素类型，需要可以默认构造和移动
+     * @warning tryPop() 只能由同一个线程调用
+     */
+    template <typename T>
+    class MpscRing {
+    public:
+        /**
+         * @brief 构造一个环形队列
+         * @param capacity 容量，会向上取整到2的幂
+         */
+        explicit MpscRing(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            m_mask = size - 1;
+            m_cells.reset(new Cell[size]);
+            for (size_t i = 0; i < size; i++) {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscRing(const MpscRing&) = delete;
+        MpscRing& operator=(const MpscRing&) = delete;
+
+        /**
+         * @brief 尝试放入一个元素，可以在任意线程调用
+         * @param value 元素
+         * @return true 放入成功
+         * @return false 队列已满，value 没有被移动
+         */
+        template <typename U>
+        bool tryPush(U&& value) {
+            Cell* cell;
+            size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+            while (true) {
+                cell = &m_cells[position & m_mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0) {
+                    if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else {
+                    position = m_enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+            cell->value = std::forward<U>(value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief 尝试取出一个元素，只有消费者线程可以调用
+         * @param value 取出的元素
+         * @return true 取出成功
+         * @return false 队列为空，或者占到队首位置的生产者还没有写完
+         */
+        bool tryPop(T& value) {
+            size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+            Cell& cell = m_cells[position & m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+                return false;
+            value = std::move(cell.value);
+            cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+            m_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief 一次取出调用时已经写完的所有元素，只有消费者线程可以调用
+         * @param func 对每一个取出的元素按顺序调用 func(T&&)
+         * @return size_t 取出的元素数量
+         * @note 只读取一次生产者的位置，调用期间新放入的元素留到下一次，消费者的位置也只在最后更新一次
+         */
+        template <typename Func>
+        size_t popBatch(Func&& func) {
+            const size_t begin = m_dequeuePosition.load(std::memory_order_relaxed);
+            const size_t end = m_enqueuePosition.load(std::memory_order_relaxed);
+            size_t position = begin;
+            for (; position != end; position++) {
+                Cell& cell = m_cells[position & m_mask];
+                if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+                    break;  // 这个位置的生产者还没有写完，后面的元素留到下一次，保持顺序
+                func(std::move(cell.value));
+                cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+            }
+            m_dequeuePosition.store(position, std::memory_order_relaxed);
+            return position - begin;
+        }
+
+        /**
+         * @brief 查看队首的元素但不取出，只有消费者线程可以调用
+         * @return T* 队首的元素，在下一次 tryPop() 之前有效，队列为空（或者生产者还没有写完）时为nullptr
+         */
+        T* front() {
+            size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+            Cell& cell = m_cells[position & m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+                return nullptr;
+            return &cell.value;
+        }
+
+        inline size_t capacity() const { return m_mask + 1; }
+
+        /**
+         * @brief 队列中元素的大致数量，只用于统计
+         */
+        inline size_t size() const {
+            size_t enqueue = m_enqueuePosition.load(std::memory_order_relaxed);
+            size_t dequeue = m_dequeuePosition.load(std::memory_order_relaxed);
+            return enqueue > dequeue ? enqueue - dequeue : 0;
+        }
+
+        inline bool empty() const { return size() == 0; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        UniqueRef<Cell[]> m_cells;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_enqueuePosition = 0;
+        alignas(64) std::atomic<size_t> m_dequeuePosition = 0;  // 只有消费者写入
+    };
+
+    /**
+     * @brief 对象池，构造的时候一次性分配 capacity 个对象，之后的申请和归还都不会分配内存
+     * @tparam T 对象类型，需要可以默认构造
+     * @note 申请和归还都是无锁的，可以在任意线程调用
+     */
+    template <typename T>
+    class ObjectPool {
+    public:
+        explicit ObjectPool(size_t capacity)
+            : m_objects(new T[capacity]), m_capacity(capacity), m_freeList(capacity) {
+            for (size_t i = 0; i < capacity; i++) {
+                m_freeList.tryPush(&m_objects[i]);
+            }
+        }
+
+        /**
+         * @brief 申请一个对象
+         * @return T* 对象的指针，池中的对象用完了返回nullptr
+         */
+        inline T* acquire() {
+            T* object = nullptr;
+            m_freeList.tryPop(object);
+            return object;
+        }
+
+        /**
+         * @brief 归还一个对象，这个对象必须是从这个池中申请的
+         * @param object 对象的指针
+         */
+        inline void release(T* object) {
+            m_freeList.tryPush(object);
+        }
+
+        /**
+         * @brief 判断一个对象是不是属于这个池
+         */
+        inline bool owns(const T* object) const {
+            return object >= m_objects.get() && object < m_objects.get() + m_capacity;
+        }
+
+        inline size_t capacity() const { return m_capacity; }
+
+    private:
+        UniqueRef<T[]> m_objects;
+        size_t m_capacity;
+        BoundedQueue<T*> m_freeList;
+    };
+
+}
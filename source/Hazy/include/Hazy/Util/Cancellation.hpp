@@ -0,0 +1,169 @@
+#pragma once
+#include <hazy_pch.h>
+
+namespace Hazy {
+
+    /**
+     * @brief 任务被取消时抛出的异常，PooledFuture::get() 遇到被取消的任务也会抛出它
+     */
+    class TaskCancelled : public std::runtime_error {
+    public:
+        TaskCancelled() : std::runtime_error("Task was cancelled") { }
+    };
+
+    /**
+     * @brief 取消源和它的令牌共享的状态：是否已经取消，以及取消时要调用的回调
+     * @note 回调在 cancel() 的线程中、持有锁的时候调用，所以注销回调之后可以确定它不会再被调用，回调里不能再注册或者注销回调
+     */
+    class CancellationState {
+    public:
+        using Callback = void (*)(void* context);
+
+        static constexpr uint32_t s_invalidSlot = static_cast<uint32_t>(-1);
+
+        inline bool isCancelled() const { return m_cancelled.load(std::memory_order_acquire); }
+
+        /**
+         * @brief 注册一个取消时调用的回调
+         * @return uint32_t 回调的编号，用于注销，已经取消了的话不会注册，返回 s_invalidSlot
+         */
+        inline uint32_t registerCallback(Callback callback, void* context) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (isCancelled())
+                return s_invalidSlot;
+            if (m_freeSlots.empty()) {
+                m_callbacks.push_back({ callback, context });
+                return static_cast<uint32_t>(m_callbacks.size() - 1);
+            }
+            uint32_t slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+            m_callbacks[slot] = { callback, context };
+            return slot;
+        }
+
+        inline void unregisterCallback(uint32_t slot) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_callbacks[slot] = { };
+            m_freeSlots.push_back(slot);
+        }
+
+        inline void cancel() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_cancelled.exchange(true, std::memory_order_acq_rel))
+                return;
+            for (const Entry& entry : m_callbacks) {
+                if (entry.callback != nullptr)
+                    entry.callback(entry.context);
+            }
+        }
+
+    private:
+        struct Entry {
+            Callback callback = nullptr;
+            void* context = nullptr;
+        };
+
+        std::atomic<bool> m_cancelled = false;
+        std::mutex m_mutex;
+        std::vector<Entry> m_callbacks;     // 注销的位置放进 m_freeSlots 重复使用，稳定状态下不会分配内存
+        std::vector<uint32_t> m_freeSlots;
+    };
+
+    /**
+     * @brief 取消回调的注册，析构时注销，只能移动
+     */
+    class CancellationRegistration {
+    public:
+        CancellationRegistration() = default;
+        CancellationRegistration(Ref<CancellationState> state, uint32_t slot) : m_state(std::move(state)), m_slot(slot) { }
+        CancellationRegistration(CancellationRegistration&& other) noexcept
+            : m_state(std::move(other.m_state)), m_slot(other.m_slot) { }
+        CancellationRegistration& operator=(CancellationRegistration&& other) noexcept {
+            if (this != &other) {
+                reset();
+                m_state = std::move(other.m_state);
+                m_slot = other.m_slot;
+            }
+            return *this;
+        }
+        CancellationRegistration(const CancellationRegistration&) = delete;
+        CancellationRegistration& operator=(const CancellationRegistration&) = delete;
+        ~CancellationRegistration() { reset(); }
+
+        inline bool isRegistered() const { return m_state != nullptr; }
+
+        inline void reset() {
+            if (m_state != nullptr) {
+                m_state->unregisterCallback(m_slot);
+                m_state.reset();
+            }
+        }
+
+    private:
+        Ref<CancellationState> m_state;
+        uint32_t m_slot = CancellationState::s_invalidSlot;
+    };
+
+    /**
+     * @brief 取消令牌，从 CancellationSource 获取，只能查询是否被取消，可以随意拷贝，拷贝只是增加引用计数
+     * @note 默认构造的令牌永远不会被取消
+     */
+    class CancellationToken {
+        friend class CancellationSource;
+    public:
+        CancellationToken() = default;
+
+        inline bool isCancelled() const { return m_state != nullptr && m_state->isCancelled(); }
+        inline bool canBeCancelled() const { return m_state != nullptr; }
+
+        /**
+         * @brief 执行时间比较长的任务可以在适当的位置调用这个函数，被取消了就提前结束
+         * @throws TaskCancelled 已经被取消
+         */
+        inline void throwIfCancelled() const {
+            if (isCancelled())
+                throw TaskCancelled();
+        }
+
+        /**
+         * @brief 注册一个在取消时调用的回调，返回的注册对象析构时注销
+         * @param callback 回调，在调用 cancel() 的线程中执行
+         * @param context 传给回调的参数
+         * @return CancellationRegistration 注册对象，令牌不能被取消或者已经被取消时不会注册，isRegistered() 返回false
+         */
+        inline CancellationRegistration onCancel(CancellationState::Callback callback, void* context) const {
+            if (m_state == nullptr)
+                return { };
+            uint32_t slot = m_state->registerCallback(callback, context);
+            if (slot == CancellationState::s_invalidSlot)
+                return { };
+            return CancellationRegistration(m_state, slot);
+        }
+
+    private:
+        explicit CancellationToken(Ref<CancellationState> state) : m_state(std::move(state)) { }
+
+        Ref<CancellationState> m_state;
+    };
+
+    /**
+     * @brief 取消源，持有取消的权力，从它获取的所有令牌共享同一个状态
+     * @note 一般一批相关的任务（比如某个区域的流式加载）共用一个取消源，不再需要这批任务的时候调用 cancel()
+     */
+    class CancellationSource {
+    public:
+        CancellationSource() : m_state(std::make_shared<CancellationState>()) { }
+
+        /**
+         * @brief 取消所有持有这个源的令牌的任务：还在排队的任务马上被标记为取消，之后也不会再执行，
+         * 正在执行的任务可以通过令牌查询到取消状态
+         */
+        inline void cancel() { m_state->cancel(); }
+        inline bool isCancelled() const { return m_state->isCancelled(); }
+        inline CancellationToken getToken() const { return CancellationToken(m_state); }
+
+    private:
+        Ref<CancellationState> m_state;
+    };
+
+}
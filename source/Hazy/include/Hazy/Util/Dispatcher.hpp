@@ -0,0 +1,112 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Util/Log.h"
+#include "Hazy/Util/ThreadPool.hpp"
+
+namespace Hazy {
+
+    /**
+     * @brief 派发器，任意线程都可以往里面投递函数，由拥有它的线程（比如拥有渲染上下文的线程）统一执行
+     * @note - 投递是无锁的（Vyukov 多生产者单消费者链表队列），生产者之间只需要一次原子交换
+     * @note - 节点来自预分配的对象池，函数对象直接存放在节点里（和 ThreadPool::Job 一样），稳定状态下投递不会分配内存
+     * @note - 执行的时候可以指定时间预算，预算用完之后剩下的函数留到下一次执行，避免一次上传太多资源造成卡顿
+     * @warning drain() 只能由同一个线程调用
+     */
+    class HAZY_API Dispatcher {
+    public:
+        Dispatcher();
+        ~Dispatcher();
+
+        Dispatcher(const Dispatcher&) = delete;
+        Dispatcher& operator=(const Dispatcher&) = delete;
+
+        /**
+         * @brief 投递一个函数，不关心返回值，可以在任意线程调用
+         * @tparam Func 调用函数的类型
+         * @param func 要执行的函数
+         * @warning 函数抛出的异常会被记录到日志然后丢弃，需要异常的话请使用 Execute
+         */
+        template <typename Func>
+        void Submit(Func&& func);
+
+        /**
+         * @brief 投递一个函数，并返回它的结果，可以在任意线程调用
+         * @tparam Func 调用函数的类型
+         * @param func 要执行的函数
+         * @return PooledFuture<std::invoke_result_t<Func>> 函数返回值
+         * @warning 不要在执行派发器的线程上等待返回的 future，函数要等到下一次 drain() 才会执行
+         */
+        template <typename Func>
+        PooledFuture<std::invoke_result_t<Func>> Execute(Func&& func);
+
+        /**
+         * @brief 按照投递的顺序执行排队的函数
+         * @param budget 时间预算，每执行完一个函数检查一次，用完之后剩下的函数留到下一次，为0时执行到队列为空
+         * @return size_t 执行了多少个函数
+         * @note 至少会执行一个函数（如果有的话），所以即使预算很小也总能向前推进
+         * @note 执行过程中新投递的函数也可能在这一次被执行
+         */
+        size_t drain(std::chrono::microseconds budget = std::chrono::microseconds(0));
+
+        /**
+         * @brief 正在排队的函数数量，只用于统计
+         */
+        inline size_t getPendingCount() const { return m_pendingCount.load(std::memory_order_relaxed); }
+
+        // 预分配的节点数量
+        static constexpr size_t s_nodePoolCapacity = 1024;
+
+    private:
+        struct Node {
+            std::atomic<Node*> next = nullptr;
+            ThreadPool::Job job;
+        };
+
+        Node* acquireNode();
+        void releaseNode(Node* node);
+        void push(Node* node);
+
+        /**
+         * @brief 取出队首的节点，只有消费者线程可以调用
+         * @return Node* 取出的节点，它会成为新的哨兵节点，执行完之后不需要释放，为nullptr表示队列为空（或者生产者还没有把节点链接上）
+         */
+        Node* pop();
+
+        ObjectPool<Node> m_nodePool;
+        alignas(64) std::atomic<Node*> m_head;  // 生产者在这一端插入
+        alignas(64) Node* m_tail;               // 消费者在这一端取出，m_tail 总是指向一个已经被取走的哨兵节点
+        std::atomic<size_t> m_pendingCount = 0;
+    };
+
+    template <typename Func>
+    void Dispatcher::Submit(Func&& func) {
+        Node* node = acquireNode();
+        node->job.emplace(std::forward<Func>(func));
+        push(node);
+    }
+
+    template <typename Func>
+    PooledFuture<std::invoke_result_t<Func>> Dispatcher::Execute(Func&& func) {
+        using return_type = std::invoke_result_t<Func>;
+
+        FutureState* state = FutureState::acquire();
+        PooledFuture<return_type> future(state);
+        Submit(
+            [promise = FuturePromise(state), func = std::forward<Func>(func)]() mutable {
+                try {
+                    if constexpr (std::is_void_v<return_type>) {
+                        func();
+                        promise.setVoid();
+                    }
+                    else {
+                        promise.setValue(func());
+                    }
+                }
+                catch (...) {
+                    promise.setException(std::current_exception());
+                }
+            });
+        return future;
+    }
+
+}
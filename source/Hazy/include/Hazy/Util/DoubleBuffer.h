@@ -0,0 +1,51 @@
+#pragma once
+#include <hazy_pch.h>
+
+namespace Hazy {
+
+    /**
+     * @brief 双缓冲的帧数据：更新一侧写第N+1帧的数据，渲染一侧同时读第N帧的数据，在同步点交换
+     * @tparam T 帧数据的类型，比如相机矩阵、这一帧要绘制的物体列表
+     * @note - 交换本身不加锁，只能在更新和渲染都没有在执行的时候交换，一般交给 Window::registerFrameData()，由窗口在同步点交换
+     * @note - 交换之后更新一侧拿到的是上上一帧的数据，如果每一帧只修改其中一部分，构造时让 carryOver 为 true，
+     * 交换时把刚交给渲染的数据复制一份给更新一侧
+     */
+    template <typename T>
+    class DoubleBuffer {
+    public:
+        /**
+         * @param initial 两份缓冲区的初始值
+         * @param carryOver 交换时是否把交给渲染的数据复制给更新一侧
+         */
+        explicit DoubleBuffer(const T& initial = T(), bool carryOver = false)
+            : m_buffers { initial, initial }, m_carryOver(carryOver) { }
+
+        DoubleBuffer(const DoubleBuffer&) = delete;
+        DoubleBuffer& operator=(const DoubleBuffer&) = delete;
+
+        /**
+         * @brief 更新一侧的数据，只能在更新的时候（比如 m_updateFunc、帧任务图）访问
+         */
+        inline T& getUpdate() { return m_buffers[m_updateIndex]; }
+
+        /**
+         * @brief 渲染一侧的数据，只能在渲染的时候（比如 m_renderFunc、层的 update()）访问
+         */
+        inline const T& getRender() const { return m_buffers[m_updateIndex ^ 1]; }
+
+        /**
+         * @brief 把更新一侧写好的数据交给渲染
+         */
+        inline void swap() {
+            m_updateIndex ^= 1;
+            if (m_carryOver)
+                m_buffers[m_updateIndex] = m_buffers[m_updateIndex ^ 1];
+        }
+
+    private:
+        std::array<T, 2> m_buffers;
+        uint32_t m_updateIndex = 0;
+        bool m_carryOver;
+    };
+
+}
\ No newline at end of file
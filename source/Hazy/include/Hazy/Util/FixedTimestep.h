@@ -0,0 +1,79 @@
+#pragma once
+#include <hazy_pch.h>
+
+namespace Hazy {
+
+    /**
+     * @brief 固定时间步长的累加器，把不固定的帧间隔换算成固定步长的更新次数
+     * @note - 每一帧调用 advance() 累加帧间隔，够几个步长就返回几，调用者按照返回值执行几次更新
+     * @note - 一帧最多补 maxCatchUpSteps 次更新，卡顿之后超出的时间直接丢弃，避免更新越追越慢（螺旋式卡死）
+     * @note - 剩下的不够一个步长的时间用 getAlpha() 表示，取值范围为 [0, 1)，渲染时用它在上一次和这一次更新的状态之间插值
+     */
+    class HAZY_API FixedTimestep {
+    public:
+        /**
+         * @param tickRate 每秒更新多少次
+         * @param maxCatchUpSteps 一帧最多执行多少次更新
+         * @throws std::invalid_argument tickRate 不是正数，或者 maxCatchUpSteps 为0
+         */
+        FixedTimestep(float tickRate, uint32_t maxCatchUpSteps = 5)
+            : m_maxCatchUpSteps(maxCatchUpSteps) {
+            if (!(tickRate > 0.0f))
+                throw std::invalid_argument("FixedTimestep: tick rate must be positive");
+            if (maxCatchUpSteps == 0)
+                throw std::invalid_argument("FixedTimestep: max catch-up steps must be at least 1");
+            m_step = 1.0 / tickRate;
+        }
+
+        /**
+         * @brief 累加一帧的时间
+         * @param deltaTime 帧间隔，单位为秒，负数按0处理
+         * @return uint32_t 这一帧需要执行的更新次数，不会超过 maxCatchUpSteps
+         */
+        inline uint32_t advance(float deltaTime) {
+            if (deltaTime > 0.0f)
+                m_accumulator += deltaTime;
+            uint32_t steps = 0;
+            while (m_accumulator >= m_step && steps < m_maxCatchUpSteps) {
+                m_accumulator -= m_step;
+                steps++;
+            }
+            if (m_accumulator >= m_step) {
+                // 追不上了，只保留不够一个步长的部分，插值的相位不会突变
+                const double skipped = std::floor(m_accumulator / m_step);
+                m_accumulator -= skipped * m_step;
+                m_droppedSteps += static_cast<uint64_t>(skipped);
+            }
+            return steps;
+        }
+
+        /**
+         * @brief 清空累加的时间，比如窗口从最小化恢复之后，不要把最小化的时间补回来
+         */
+        inline void reset() { m_accumulator = 0.0; }
+
+        /**
+         * @brief 插值系数，累加器中剩下的时间占一个步长的比例
+         */
+        inline float getAlpha() const { return static_cast<float>(m_accumulator / m_step); }
+
+        /**
+         * @brief 步长，单位为秒
+         */
+        inline float getStep() const { return static_cast<float>(m_step); }
+        inline float getTickRate() const { return static_cast<float>(1.0 / m_step); }
+        inline uint32_t getMaxCatchUpSteps() const { return m_maxCatchUpSteps; }
+
+        /**
+         * @brief 因为超过 maxCatchUpSteps 而被丢弃的更新的总数
+         */
+        inline uint64_t getDroppedSteps() const { return m_droppedSteps; }
+
+    private:
+        double m_step;              // 以秒为单位，累加使用 double，长时间运行也不会丢失精度
+        double m_accumulator = 0.0; // 还没有被更新消耗的时间
+        uint32_t m_maxCatchUpSteps;
+        uint64_t m_droppedSteps = 0;
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Util/Cancellation.hpp"
+
+namespace Hazy {
+
+    /**
+     * @brief PooledFuture 的共享状态，从一个全局的对象池中申请，结果直接存放在内部的缓冲区里
+     * @note 由任务和 PooledFuture 共同持有，两者都释放之后归还到对象池
+     */
+    class HAZY_API FutureState {
+    public:
+        enum class Status : uint32_t {
+            Pending,
+            Running,    // 可以取消的任务已经开始执行，不能再在 cancel() 的时候完成
+            Value,
+            Exception,
+            Cancelled
+        };
+
+        static constexpr size_t s_inlineSize = 64;
+
+        FutureState() = default;
+        FutureState(const FutureState&) = delete;
+        FutureState& operator=(const FutureState&) = delete;
+
+        /**
+         * @brief 申请一个共享状态，引用计数为2（任务一份，future一份）
+         * @return FutureState* 共享状态，对象池用完了会从堆上分配
+         */
+        static FutureState* acquire();
+
+        /**
+         * @brief 释放一份引用，引用计数归零时销毁结果并归还到对象池
+         */
+        void release();
+
+        template <typename T>
+        void setValue(T&& value) {
+            using Value = std::decay_t<T>;
+            if constexpr (fitsInline<Value>()) {
+                new (m_storage) Value(std::forward<T>(value));
+                m_destroyValue = [](FutureState& state) { std::launder(reinterpret_cast<Value*>(state.m_storage))->~Value(); };
+            }
+            else {
+                *reinterpret_cast<Value**>(m_storage) = new Value(std::forward<T>(value));
+                m_destroyValue = [](FutureState& state) { delete *reinterpret_cast<Value**>(state.m_storage); };
+            }
+            publish(Status::Value);
+        }
+
+        inline void setVoid() { publish(Status::Value); }
+
+        inline void setException(std::exception_ptr exception) {
+            m_exception = std::move(exception);
+            publish(Status::Exception);
+        }
+
+        /**
+         * @brief 任务在开始之前被取消了，或者任务抛出了 TaskCancelled
+         */
+        inline void setCancelled() { publish(Status::Cancelled); }
+
+        /**
+         * @brief 可以取消的任务开始执行之前调用，和 tryCancel() 竞争，只有一方能成功
+         * @return false 任务已经在 cancel() 的时候被标记为取消了，不要执行
+         */
+        inline bool tryStart() {
+            uint32_t expected = static_cast<uint32_t>(Status::Pending);
+            return m_status.compare_exchange_strong(expected, static_cast<uint32_t>(Status::Running), std::memory_order_acq_rel);
+        }
+
+        /**
+         * @brief 在任务开始执行之前把它标记为取消，由取消源的回调调用
+         */
+        inline void tryCancel() {
+            uint32_t expected = static_cast<uint32_t>(Status::Pending);
+            if (m_status.compare_exchange_strong(expected, static_cast<uint32_t>(Status::Cancelled), std::memory_order_acq_rel))
+                m_status.notify_all();
+        }
+
+        inline bool isReady() const { return m_status.load(std::memory_order_acquire) >= static_cast<uint32_t>(Status::Value); }
+        inline bool isCancelled() const { return m_status.load(std::memory_order_acquire) == static_cast<uint32_t>(Status::Cancelled); }
+
+        inline void wait() const {
+            uint32_t status;
+            while ((status = m_status.load(std::memory_order_acquire)) < static_cast<uint32_t>(Status::Value)) {
+                m_status.wait(status);
+            }
+        }
+
+        /**
+         * @brief 取出结果，如果任务抛出了异常，在这里重新抛出
+         * @tparam T 结果类型
+         * @throws TaskCancelled 任务被取消了
+         */
+        template <typename T>
+        T take() {
+            wait();
+            uint32_t status = m_status.load(std::memory_order_acquire);
+            if (status == static_cast<uint32_t>(Status::Exception))
+                std::rethrow_exception(m_exception);
+            if (status == static_cast<uint32_t>(Status::Cancelled))
+                throw TaskCancelled();
+            if constexpr (!std::is_void_v<T>) {
+                if constexpr (fitsInline<T>())
+                    return std::move(*std::launder(reinterpret_cast<T*>(m_storage)));
+                else
+                    return std::move(**reinterpret_cast<T**>(m_storage));
+            }
+        }
+
+    private:
+        template <typename T>
+        static constexpr bool fitsInline() {
+            return sizeof(T) <= s_inlineSize && alignof(T) <= alignof(std::max_align_t);
+        }
+
+        inline void publish(Status status) {
+            m_status.store(static_cast<uint32_t>(status), std::memory_order_release);
+            m_status.notify_all();
+        }
+
+        std::atomic<uint32_t> m_status = static_cast<uint32_t>(Status::Pending);
+        std::atomic<uint32_t> m_references = 0;
+        std::exception_ptr m_exception;
+        void (*m_destroyValue)(FutureState&) = nullptr;
+        alignas(std::max_align_t) unsigned char m_storage[s_inlineSize];
+    };
+
+    /**
+     * @brief 持有 FutureState 中属于任务的那一份引用，析构时释放
+     * @note 如果直到析构都没有设置结果（比如任务还没执行就被丢弃了），会设置一个 broken_promise 异常，等待结果的一方不会永远阻塞
+     */
+    class HAZY_API FuturePromise {
+    public:
+        explicit FuturePromise(FutureState* state) : m_state(state) { }
+
+        /**
+         * @brief 构造一个可以取消的 promise，令牌被取消时，还没有开始执行的任务马上被标记为取消
+         * @note 令牌已经被取消的话，构造完成时共享状态就已经是取消状态了
+         */
+        FuturePromise(FutureState* state, const CancellationToken& token)
+            : m_state(state), m_registration(token.onCancel([](void* context) { static_cast<FutureState*>(context)->tryCancel(); }, state)) {
+            if (!m_registration.isRegistered() && token.isCancelled())
+                m_state->tryCancel();
+        }
+
+        FuturePromise(FuturePromise&& other) noexcept
+            : m_state(std::exchange(other.m_state, nullptr)), m_registration(std::move(other.m_registration)) { }
+        FuturePromise(const FuturePromise&) = delete;
+        FuturePromise& operator=(const FuturePromise&) = delete;
+        FuturePromise& operator=(FuturePromise&&) = delete;
+        ~FuturePromise() {
+            // 先注销取消回调，之后共享状态可能被归还到对象池
+            m_registration.reset();
+            if (m_state != nullptr) {
+                if (!m_state->isReady())
+                    m_state->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+                m_state->release();
+            }
+        }
+
+        template <typename T>
+        inline void setValue(T&& value) { m_state->setValue(std::forward<T>(value)); }
+        inline void setVoid() { m_state->setVoid(); }
+        inline void setException(std::exception_ptr exception) { m_state->setException(std::move(exception)); }
+        inline void setCancelled() { m_state->setCancelled(); }
+
+        /**
+         * @return false 任务已经被取消了，不要执行
+         */
+        inline bool tryStart() { return m_state->tryStart(); }
+
+    private:
+        FutureState* m_state;
+        CancellationRegistration m_registration;
+    };
+
+    /**
+     * @brief 由 ThreadPool::ExecutePooled 返回的 future，共享状态来自对象池，稳定状态下不会分配内存
+     * @tparam T 结果类型
+     * @note 只能移动，不能拷贝，结果只能取一次
+     */
+    template <typename T>
+    class PooledFuture {
+    public:
+        PooledFuture() = default;
+        explicit PooledFuture(FutureState* state) : m_state(state) { }
+        PooledFuture(PooledFuture&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) { }
+        PooledFuture& operator=(PooledFuture&& other) noexcept {
+            if (this != &other) {
+                reset();
+                m_state = std::exchange(other.m_state, nullptr);
+            }
+            return *this;
+        }
+        PooledFuture(const PooledFuture&) = delete;
+        PooledFuture& operator=(const PooledFuture&) = delete;
+        ~PooledFuture() { reset(); }
+
+        inline bool valid() const { return m_state != nullptr; }
+        inline bool isReady() const { return m_state != nullptr && m_state->isReady(); }
+
+        /**
+         * @brief 任务是不是被取消了，任务还没有结束的时候返回false
+         */
+        inline bool isCancelled() const { return m_state != nullptr && m_state->isCancelled(); }
+        inline void wait() const { if (m_state) m_state->wait(); }
+
+        /**
+         * @brief 等待并取出结果，取出之后这个 future 变为无效
+         * @return T 任务的返回值
+         * @throws std::future_error future 无效
+         * @throws TaskCancelled 任务被取消了
+         * @throws 任务抛出的异常
+         */
+        T get() {
+            if (m_state == nullptr)
+                throw std::future_error(std::future_errc::no_state);
+            FutureState* state = std::exchange(m_state, nullptr);
+            struct Releaser {
+                FutureState* state;
+                ~Releaser() { state->release(); }
+            } releaser { state };
+            return state->take<T>();
+        }
+
+    private:
+        inline void reset() {
+            if (m_state != nullptr)
+                std::exchange(m_state, nullptr)->release();
+        }
+
+        FutureState* m_state = nullptr;
+    };
+
+}
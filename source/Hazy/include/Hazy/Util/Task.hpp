@@ -0,0 +1,209 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Util/Log.h"
+
+namespace Hazy {
+
+    template <typename T>
+    class Task;
+
+    namespace Detail {
+
+        /**
+         * @brief syncWait 用来等待协程结束的信号，放在等待线程的栈上
+         * @note 在持有锁的时候通知，等待的线程拿到锁之后才会返回，所以通知的一方不会访问已经销毁的信号
+         */
+        struct TaskSignal {
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool done = false;
+
+            inline void notify() {
+                std::lock_guard<std::mutex> lock(mutex);
+                done = true;
+                cv.notify_all();
+            }
+
+            inline void wait() {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this] { return done; });
+            }
+        };
+
+        class TaskPromiseBase {
+        public:
+            /**
+             * @brief 协程执行完毕之后：有人 co_await 它就切换回等待者，被分离的协程销毁自己，被 syncWait 的协程通知等待线程
+             */
+            struct FinalAwaiter {
+                inline bool await_ready() const noexcept { return false; }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                    TaskPromiseBase& promise = handle.promise();
+                    if (promise.m_continuation)
+                        return promise.m_continuation;
+                    if (promise.m_detached) {
+                        promise.logException();
+                        handle.destroy();
+                    }
+                    else if (promise.m_signal != nullptr) {
+                        promise.m_signal->notify();
+                    }
+                    return std::noop_coroutine();
+                }
+
+                inline void await_resume() const noexcept { }
+            };
+
+            inline std::suspend_always initial_suspend() const noexcept { return {}; }
+            inline FinalAwaiter final_suspend() const noexcept { return {}; }
+            inline void unhandled_exception() { m_exception = std::current_exception(); }
+
+            inline void setContinuation(std::coroutine_handle<> continuation) { m_continuation = continuation; }
+            inline void setSignal(TaskSignal* signal) { m_signal = signal; }
+            inline void detach() { m_detached = true; }
+
+        protected:
+            inline void rethrowIfFailed() {
+                if (m_exception)
+                    std::rethrow_exception(m_exception);
+            }
+
+            void logException() {
+                if (!m_exception)
+                    return;
+                try {
+                    std::rethrow_exception(m_exception);
+                }
+                catch (const std::exception& e) {
+                    Logger::LogError("Unhandled exception in detached task: {}", e.what());
+                }
+                catch (...) {
+                    Logger::LogError("Unhandled exception in detached task");
+                }
+            }
+
+            std::coroutine_handle<> m_continuation;
+            std::exception_ptr m_exception;
+            TaskSignal* m_signal = nullptr;
+            bool m_detached = false;
+        };
+
+        template <typename T>
+        class TaskPromise : public TaskPromiseBase {
+        public:
+            Task<T> get_return_object() noexcept;
+
+            template <typename U>
+            void return_value(U&& value) { m_value.emplace(std::forward<U>(value)); }
+
+            T result() {
+                rethrowIfFailed();
+                return std::move(*m_value);
+            }
+
+        private:
+            std::optional<T> m_value;
+        };
+
+        template <>
+        class TaskPromise<void> : public TaskPromiseBase {
+        public:
+            Task<void> get_return_object() noexcept;
+
+            inline void return_void() { }
+            inline void result() { rethrowIfFailed(); }
+        };
+
+    }
+
+    /**
+     * @brief 协程任务，协程函数的返回值类型写成 Task<T> 就可以在函数里使用 co_await
+     * @tparam T 协程的返回值类型
+     * @note - 任务是惰性的，创建之后不会执行，直到被 co_await、detach() 或者 syncWait()
+     * @note - 在协程中 co_await pool.schedule() 切换到线程池的工作线程，co_await window.renderThread() 切换回拥有渲染上下文的线程，
+     * 这样读取和解码可以在工作线程中进行，上传到 GPU 的部分在渲染线程中进行，写成一个线性的函数
+     * @note - 一个任务只能被 co_await 一次，co_await 一个任务会在当前线程开始执行它，它结束之后在它结束的那个线程继续执行等待者
+     * @warning 协程的参数如果是引用，请确保引用的对象在协程结束之前一直有效，跨线程切换之后尤其需要注意
+     */
+    template <typename T = void>
+    class [[nodiscard]] Task {
+    public:
+        using promise_type = Detail::TaskPromise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task() = default;
+        explicit Task(Handle handle) : m_handle(handle) { }
+        Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) { }
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (m_handle)
+                    m_handle.destroy();
+                m_handle = std::exchange(other.m_handle, nullptr);
+            }
+            return *this;
+        }
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task() {
+            if (m_handle)
+                m_handle.destroy();
+        }
+
+        inline bool valid() const { return static_cast<bool>(m_handle); }
+
+        inline bool await_ready() const noexcept { return false; }
+
+        /**
+         * @brief 记录等待者，然后直接切换到这个任务开始执行（对称转移，不会增加栈的深度）
+         */
+        inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+            m_handle.promise().setContinuation(continuation);
+            return m_handle;
+        }
+
+        inline T await_resume() { return m_handle.promise().result(); }
+
+        /**
+         * @brief 在当前线程开始执行这个任务，不等待它结束，任务结束之后自动销毁
+         * @note 分离的任务抛出的异常会被记录到日志然后丢弃
+         */
+        void detach() {
+            Handle handle = std::exchange(m_handle, nullptr);
+            handle.promise().detach();
+            handle.resume();
+        }
+
+        /**
+         * @brief 在当前线程开始执行这个任务，阻塞直到它结束，然后返回它的结果
+         * @return T 任务的返回值
+         * @throws 任务抛出的异常
+         * @warning 不要在渲染线程上等待一个会 co_await renderThread() 的任务，渲染线程被阻塞了，任务永远切换不回来
+         */
+        friend T syncWait(Task task) {
+            Detail::TaskSignal signal;
+            task.m_handle.promise().setSignal(&signal);
+            task.m_handle.resume();
+            signal.wait();
+            return task.m_handle.promise().result();
+        }
+
+    private:
+        Handle m_handle;
+    };
+
+    namespace Detail {
+
+        template <typename T>
+        Task<T> TaskPromise<T>::get_return_object() noexcept {
+            return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+            return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+        }
+
+    }
+
+}
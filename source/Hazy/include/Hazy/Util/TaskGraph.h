@@ -0,0 +1,126 @@
+#pragma once
+#include <hazy_pch.h>
+#include "Hazy/Util/ThreadPool.hpp"
+
+namespace Hazy {
+
+    /**
+     * @brief 任务图，用有向无环图描述一组任务之间的依赖关系，然后交给线程池执行
+     * @note - 图只需要构建一次，编译之后可以每一帧重复启动，重复启动时不会重新分配内存
+     * @note - 没有依赖关系的节点会在不同的工作线程上并行执行
+     * @warning 图在运行的时候不能修改，也不能重复启动，请先调用 wait()
+     */
+    class HAZY_API TaskGraph {
+    public:
+        using NodeID = uint32_t;
+
+        TaskGraph() = default;
+        ~TaskGraph();
+
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        /**
+         * @brief 添加一个节点
+         * @param name 节点的名字，用于调试
+         * @param work 节点要执行的工作
+         * @return NodeID 节点的编号，用于添加依赖关系
+         * @throws std::logic_error 图正在运行
+         */
+        NodeID addNode(const std::string& name, std::function<void()> work);
+
+        /**
+         * @brief 添加一条边，before 执行完毕之后才会执行 after
+         * @param before 先执行的节点
+         * @param after 后执行的节点
+         * @return TaskGraph& 此任务图的引用
+         * @throws std::logic_error 图正在运行
+         * @throws std::out_of_range 节点不存在
+         */
+        TaskGraph& precede(NodeID before, NodeID after);
+
+        /**
+         * @brief 编译这个图：检查是否有环，计算每个节点的依赖数量，把后继节点整理成连续的数组
+         * @note 修改图之后，下一次 launch() 会自动重新编译，一般不需要手动调用
+         * @throws std::logic_error 图中有环
+         */
+        void compile();
+
+        /**
+         * @brief 在线程池中启动这个图，不阻塞
+         * @param pool 执行任务的线程池
+         * @param priority 图中所有节点的优先级，每一帧都要完成的图请使用 TaskPriority::Critical
+         * @throws std::logic_error 图已经在运行了
+         */
+        void launch(ThreadPool& pool, TaskPriority priority = TaskPriority::Normal);
+
+        /**
+         * @brief 等待这个图执行完毕，如果图没有在运行，则直接返回
+         * @note - 等待的时候会像 ThreadPool::wait() 一样帮忙执行线程池里的任务，所以可以在线程池的任务里调用
+         * @note - 如果某个节点抛出了异常，或者节点提交到线程池失败，在这里重新抛出第一个异常
+         */
+        void wait();
+
+        /**
+         * @brief 启动这个图并等待它执行完毕
+         * @param pool 执行任务的线程池
+         * @param priority 图中所有节点的优先级
+         */
+        inline void run(ThreadPool& pool, TaskPriority priority = TaskPriority::Normal) { launch(pool, priority); wait(); }
+
+        /**
+         * @brief 删除所有的节点和边
+         * @throws std::logic_error 图正在运行
+         */
+        void clear();
+
+        inline bool isRunning() const { return m_running; }
+        inline bool empty() const { return m_nodes.empty(); }
+        inline size_t size() const { return m_nodes.size(); }
+        inline const std::string& getName(NodeID node) const { return m_nodes.at(node).name; }
+
+    private:
+        struct Node {
+            std::string name;
+            std::function<void()> work;
+            std::vector<NodeID> successors;
+            uint32_t dependencyCount = 0;
+        };
+
+        /**
+         * @brief 让 ThreadPool::wait() 可以等待 m_remaining 归零
+         */
+        struct Completion {
+            const std::atomic<uint32_t>& remaining;
+
+            inline bool isReady() const { return remaining.load(std::memory_order_acquire) == 0; }
+            inline void get() const { }
+        };
+
+        /**
+         * @brief 执行一个节点，然后释放它的后继节点，其中一个后继节点会直接在当前线程继续执行
+         * @param node 节点编号
+         */
+        void execute(NodeID node);
+        void submit(NodeID node);
+        void fail(std::exception_ptr exception);
+        void checkNotRunning() const;
+
+        std::vector<Node> m_nodes;
+
+        // 编译结果：所有节点的后继节点放在同一个数组里，m_successorOffsets[i] 到 m_successorOffsets[i + 1] 是节点 i 的后继
+        std::vector<NodeID> m_successors;
+        std::vector<uint32_t> m_successorOffsets;
+        std::vector<NodeID> m_roots;
+        UniqueRef<std::atomic<uint32_t>[]> m_pending;   // 每个节点还没有完成的前驱数量
+        bool m_compiled = false;
+
+        ThreadPool* m_pool = nullptr;
+        TaskPriority m_priority = TaskPriority::Normal;
+        std::atomic<uint32_t> m_remaining = 0;          // 这一次运行中还没有执行完的节点数量
+        std::atomic<bool> m_failed = false;
+        std::exception_ptr m_exception;
+        bool m_running = false;
+    };
+
+}
@@ -1,29 +1,586 @@
 #pragma once
 #include <hazy_pch.h>
 #include "Hazy/Util/Log.h"
+#include "Hazy/Util/WorkStealingDeque.hpp"
+#include "Hazy/Util/BoundedQueue.hpp"
+#include "Hazy/Util/PooledFuture.hpp"
+#include "Hazy/Util/Cancellation.hpp"
 namespace Hazy {
+
+    /**
+     * @brief 线程池的调度模式
+     */
+    enum class ThreadPoolMode : uint8_t {
+        Shared,         // 所有线程共用一个加锁的任务队列
+        WorkStealing    // 每个线程拥有自己的双端队列，空闲的线程从其他线程那里窃取任务
+    };
+
+    /**
+     * @brief 任务的优先级，每一个优先级有自己的队列（车道）
+     */
+    enum class TaskPriority : uint8_t {
+        Critical,       // 当前帧必须完成的工作，比如剔除、录制渲染命令，总是最先执行
+        Normal,         // 默认优先级
+        Background      // 后台工作，比如解码纹理、导入模型，只在没有更高优先级的任务时执行，并且受每帧的时间预算限制
+    };
+
+    /**
+     * @brief 可取消任务的返回值类型：如果函数的第一个参数可以接受取消令牌，就把令牌传给它
+     */
+    template <typename Func, typename... Args>
+    struct CancellableResult {
+        using type = std::invoke_result_t<std::decay_t<Func>&, std::decay_t<Args>&...>;
+    };
+
+    template <typename Func, typename... Args>
+    requires std::is_invocable_v<std::decay_t<Func>&, const CancellationToken&, std::decay_t<Args>&...>
+    struct CancellableResult<Func, Args...> {
+        using type = std::invoke_result_t<std::decay_t<Func>&, const CancellationToken&, std::decay_t<Args>&...>;
+    };
+
+    template <typename Func, typename... Args>
+    using CancellableResult_t = typename CancellableResult<Func, Args...>::type;
+
+    /**
+     * @brief 一批任务的句柄，由 ThreadPool::ExecuteBatch 返回，可以等待整批任务执行完毕
+     * @note - 整批任务共享一个计数器，不会为每一个任务分配 future
+     * @note - 只能移动，不能拷贝；句柄销毁的时候不会等待任务，任务照常执行
+     */
+    class HAZY_API TaskGroup {
+        friend class ThreadPool;
+    public:
+        TaskGroup() = default;
+        TaskGroup(TaskGroup&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) { }
+        TaskGroup& operator=(TaskGroup&& other) noexcept {
+            if (this != &other) {
+                reset();
+                m_state = std::exchange(other.m_state, nullptr);
+            }
+            return *this;
+        }
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+        ~TaskGroup() { reset(); }
+
+        inline bool valid() const { return m_state != nullptr; }
+        inline size_t size() const { return m_state != nullptr ? m_state->size : 0; }
+        inline bool isReady() const { return m_state != nullptr && m_state->remaining.load(std::memory_order_acquire) == 0; }
+
+        inline void wait() const {
+            if (m_state == nullptr)
+                return;
+            size_t remaining;
+            while ((remaining = m_state->remaining.load(std::memory_order_acquire)) != 0) {
+                m_state->remaining.wait(remaining);
+            }
+        }
+
+        /**
+         * @brief 等待整批任务执行完毕，取出之后这个句柄变为无效
+         * @throws std::future_error 句柄无效
+         * @throws 第一个抛出异常的任务的异常，其余任务照常执行
+         */
+        void get() {
+            if (m_state == nullptr)
+                throw std::future_error(std::future_errc::no_state);
+            wait();
+            State* state = std::exchange(m_state, nullptr);
+            std::exception_ptr exception = state->exception;
+            state->release();
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+
+    private:
+        /**
+         * @brief 整批任务的共享状态，由句柄和整批任务各持有一份引用，最后一个任务结束时释放任务的那一份
+         * @note 和 FutureState 一样从一个全局的对象池中申请，句柄的生命周期可以比线程池更长
+         */
+        struct HAZY_API State {
+            /**
+             * @brief 申请一个共享状态
+             * @param count 这批任务的数量
+             * @return State* 共享状态，对象池用完了会从堆上分配
+             */
+            static State* acquire(size_t count);
+
+            /**
+             * @brief 释放一份引用，引用计数归零时归还到对象池
+             */
+            void release();
+
+            static ObjectPool<State>& Pool();
+
+            inline void fail(std::exception_ptr error) {
+                if (!failed.exchange(true))
+                    exception = std::move(error);
+            }
+
+            inline void finish() {
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    remaining.notify_all();
+                    release();
+                }
+            }
+
+            std::atomic<size_t> remaining = 0;
+            std::atomic<uint32_t> references = 0;
+            std::atomic<bool> failed = false;
+            std::exception_ptr exception;
+            size_t size = 0;
+        };
+
+        explicit TaskGroup(State* state) : m_state(state) { }
+
+        inline void reset() {
+            if (m_state != nullptr)
+                std::exchange(m_state, nullptr)->release();
+        }
+
+        State* m_state = nullptr;
+    };
+
+    /**
+     * @brief 线程池的配置
+     */
+    struct ThreadPoolConfig {
+        // 工作线程的数量
+        int threadCount = static_cast<int>(std::thread::hardware_concurrency());
+
+        // 调度模式
+        ThreadPoolMode mode = ThreadPoolMode::WorkStealing;
+
+        // 工作线程的名字前缀，第i个工作线程叫做 "name-i"，在调试器和性能分析工具中可以看到，Linux 下超过15个字符的部分会被截断
+        std::string name = "HazyWorker";
+
+        // 是否把工作线程固定到CPU核心上，为true且 cpuCores 为空时，依次使用除了 reservedCores 和 mainThreadCore 以外的所有核心
+        bool pinWorkers = false;
+
+        // 工作线程使用的CPU核心，第i个工作线程固定到 cpuCores[i % cpuCores.size()]，不为空时忽略 pinWorkers，
+        // 超出平台支持范围的核心（负数，Windows 下大于等于64，Linux 下大于等于 CPU_SETSIZE）会被忽略并输出警告
+        std::vector<int> cpuCores;
+
+        // 留给其他线程（比如渲染线程、音频线程）的核心，自动分配核心时不会使用
+        std::vector<int> reservedCores;
+
+        // 大于等于0时，构造线程池的线程（一般是主线程，也是渲染线程）会被固定到这个核心上，工作线程不会使用这个核心，超出范围时不固定
+        int mainThreadCore = -1;
+
+        // 工作线程没有任务时，先自旋这么长的时间再睡眠，自旋期间提交的任务不需要唤醒线程，可以降低帧任务的调度延迟，为0时直接睡眠
+        std::chrono::microseconds spinDuration = std::chrono::microseconds(0);
+    };
+
     /**
      * @brief 线程池，根据指定的线程数，将任务分配给不同的线程，注意数据竞争问题
+     * @note - Shared 模式下，所有任务都经过同一个加锁的队列
+     * @note - WorkStealing 模式下，工作线程提交的任务放入自己的双端队列，外部线程提交的任务放入全局注入队列，
+     * 空闲的工作线程依次检查自己的队列、全局队列，最后从其他工作线程那里窃取任务
+     * @note - 任务按照优先级分成三条车道：Critical 总是最先执行；Background 只有在 Critical 和 Normal 都没有任务时才会执行，
+     * 同时执行后台任务的线程最多只有 线程数 - 1 个，所以总有一个线程可以马上响应帧任务
+     * @note - 只有一个工作线程时没有多余的线程可以保留，后台任务仍然会占用这个线程，
+     * 这时由等待帧任务的线程保证响应：ThreadPool::wait() 和 TaskGraph::wait() 在等待时会亲自执行 Critical 和 Normal 任务，
+     * 所以帧任务请用它们等待，而不是直接阻塞在 std::future 上
      */
     class HAZY_API ThreadPool {
     public:
         /**
          * @brief 构造一个线程池
          * @param threadCount 这个线程池拥有的线程数量，默认为std::thread::hardware_concurrency()
+         * @param mode 调度模式，默认为工作窃取模式
+         */
+        ThreadPool(int threadCount = std::thread::hardware_concurrency(), ThreadPoolMode mode = ThreadPoolMode::WorkStealing);
+
+        /**
+         * @brief 根据配置构造一个线程池
+         * @param config 线程池的配置，可以指定线程名字、CPU亲和性和空闲时的自旋时间
+         * @note 设置线程名字或者亲和性失败时只会记录警告，不会抛出异常
          */
-        ThreadPool(int threadCount = std::thread::hardware_concurrency());
+        explicit ThreadPool(const ThreadPoolConfig& config);
         ~ThreadPool();
         template <typename Func, typename... Args>
         std::future<std::invoke_result_t<Func, Args...>> Execute(Func&& func, Args&&... args);
 
+        /**
+         * @brief 以指定的优先级给这个线程池分配任务
+         * @param priority 任务的优先级
+         * @param func 调用的函数
+         * @param args 要传递给函数的参数
+         * @return std::future<std::invoke_result_t<Func, Args...>> 函数返回值
+         */
+        template <typename Func, typename... Args>
+        std::future<std::invoke_result_t<Func, Args...>> Execute(TaskPriority priority, Func&& func, Args&&... args);
+
+        /**
+         * @brief 提交一个不需要返回值的任务（发射后不管），任务对象来自预分配的任务池，稳定状态下不会分配内存
+         * @tparam Func 调用函数的类型
+         * @tparam Args 调用函数的参数类型
+         * @param func 调用的函数，函数和参数的总大小不超过 Job::s_inlineSize 时直接存放在任务对象里
+         * @param args 要传递给函数的参数
+         * @warning 任务抛出的异常会被记录到日志然后丢弃，需要异常的话请使用 Execute 或者 ExecutePooled
+         */
+        template <typename Func, typename... Args>
+        void Submit(Func&& func, Args&&... args);
+
+        template <typename Func, typename... Args>
+        void Submit(TaskPriority priority, Func&& func, Args&&... args);
+
+        /**
+         * @brief 和 Execute 一样，但是返回的 PooledFuture 的共享状态来自对象池，稳定状态下不会分配内存
+         * @tparam Func 调用函数的类型
+         * @tparam Args 调用函数的参数类型
+         * @param func 调用的函数
+         * @param args 要传递给函数的参数
+         * @return PooledFuture<std::invoke_result_t<Func, Args...>> 函数返回值
+         */
+        template <typename Func, typename... Args>
+        PooledFuture<std::invoke_result_t<Func, Args...>> ExecutePooled(Func&& func, Args&&... args);
+
+        template <typename Func, typename... Args>
+        PooledFuture<std::invoke_result_t<Func, Args...>> ExecutePooled(TaskPriority priority, Func&& func, Args&&... args);
+
+        /**
+         * @brief 提交一个可以取消的任务
+         * @tparam Func 调用函数的类型
+         * @tparam Args 调用函数的参数类型
+         * @param token 取消令牌，在任务开始之前被取消的话，任务不会执行
+         * @param func 调用的函数，如果它的第一个参数可以接受 const CancellationToken&，执行的时候会把令牌传给它，方便在执行过程中查询是否被取消
+         * @param args 要传递给函数的参数
+         * @return PooledFuture<CancellableResult_t<Func, Args...>> 函数返回值，被取消的任务 isCancelled() 返回true，get() 抛出 TaskCancelled
+         * @note - 任务在执行过程中抛出 TaskCancelled（比如调用 token.throwIfCancelled()）也算作被取消
+         * @note - 还在排队的任务在 cancel() 的时候马上完成，等待它的一方不需要等它被取出；
+         * 任务对象本身在被取出时直接丢弃，在那之前仍然占着队列的位置并计入 getQueueDepth()
+         * @note - 令牌已经被取消的话不会提交任务，直接返回一个已经取消的 future
+         */
+        template <typename Func, typename... Args>
+        PooledFuture<CancellableResult_t<Func, Args...>> ExecuteCancellable(CancellationToken token, Func&& func, Args&&... args);
+
+        template <typename Func, typename... Args>
+        PooledFuture<CancellableResult_t<Func, Args...>> ExecuteCancellable(TaskPriority priority, CancellationToken token, Func&& func, Args&&... args);
+
+        /**
+         * @brief 一次性提交一批任务，整批任务只加一次锁，并且只唤醒需要的线程数量，适合每一帧分发成千上万个细粒度的任务
+         * @tparam Funcs 存放函数的连续容器，比如 std::vector、std::array 或者 std::span，
+         * 函数必须可以拷贝，每一个任务持有一份拷贝，不接受参数
+         * @param funcs 要执行的函数
+         * @return TaskGroup 整批任务的句柄，可以用 wait()、get() 或者 ThreadPool::wait() 等待
+         * @note 工作线程提交的 Normal 任务放进自己的双端队列，放不下的部分放进全局队列
+         * @throws std::runtime_error 线程池已经停止
+         */
+        template <std::ranges::contiguous_range Funcs>
+        TaskGroup ExecuteBatch(Funcs&& funcs);
+
+        template <std::ranges::contiguous_range Funcs>
+        TaskGroup ExecuteBatch(TaskPriority priority, Funcs&& funcs);
+
+        /**
+         * @brief 等待一个 future 并取出结果，等待的时候当前线程会帮忙执行线程池中正在排队的任务，而不是阻塞
+         * @tparam Future std::future、std::shared_future、PooledFuture 或者 TaskGroup
+         * @param future 要等待的 future
+         * @return 和 future.get() 的返回值相同
+         * @note - 在任务中提交子任务然后等待它们的时候请使用这个函数，直接调用 future.get() 会阻塞工作线程，嵌套足够深的时候所有工作线程都会被阻塞，线程池就死锁了
+         * @note - 工作线程优先执行自己队列中最新的任务，也就是刚刚提交的子任务，所以递归的分治算法可以充分利用所有线程
+         * @note - 等待的时候优先执行其他任务，不会马上执行后台任务，避免一个耗时很长的后台任务拖慢等待者；
+         * 空闲了一段时间还在等待的话，说明等待的结果可能依赖后台任务（比如在任务中等待后台的文件读取），
+         * 这时不受每帧预算和后台线程数量上限的限制，自己执行后台任务，否则所有工作线程都在等待的时候就死锁了
+         * @throws 任务抛出的异常
+         */
+        template <typename Future>
+        decltype(auto) wait(Future&& future);
+
+        /**
+         * @brief 并行地对 [begin, end) 区间执行 func，调用线程也会参与计算，直到整个区间都执行完毕才返回
+         * @tparam Index 下标类型
+         * @tparam Func 可调用对象类型，可以接受一个下标 func(i)，也可以接受一个区间 func(chunkBegin, chunkEnd)
+         * @param begin 区间起点
+         * @param end 区间终点（不包含）
+         * @param grain 每一块的大小，为0时根据线程数量自动分块
+         * @param func 对每一个下标（或者每一块）执行的函数
+         * @note 整个调用只分配一次共享状态和少量辅助任务，不会为每一个元素分配内存
+         * @throws 如果某一块抛出了异常，其余尚未开始的块会被跳过，异常在调用线程中重新抛出
+         */
+        template <typename Index, typename Func>
+        void parallelFor(Index begin, Index end, Index grain, Func&& func);
+
+        /**
+         * @brief 并行归约，把 [begin, end) 分块后分别归约，再按照块的顺序合并结果，调用线程也会参与计算
+         * @tparam Index 下标类型
+         * @tparam T 结果类型
+         * @tparam Reduce 可调用对象类型，签名为 T(Index chunkBegin, Index chunkEnd, T init)
+         * @tparam Combine 可调用对象类型，签名为 T(T lhs, T rhs)
+         * @param begin 区间起点
+         * @param end 区间终点（不包含）
+         * @param grain 每一块的大小，为0时根据线程数量自动分块
+         * @param identity 归约的单位元，每一块都从它开始归约
+         * @param reduce 归约一块的函数
+         * @param combine 合并两个结果的函数，按照块的顺序合并，所以结果是确定的
+         * @return T 归约的结果
+         */
+        template <typename Index, typename T, typename Reduce, typename Combine>
+        T parallelReduce(Index begin, Index end, Index grain, T identity, Reduce&& reduce, Combine&& combine);
+
+        /**
+         * @brief 协程切换到线程池时使用的等待体
+         */
+        struct ScheduleAwaiter {
+            ThreadPool& pool;
+            TaskPriority priority;
+
+            inline bool await_ready() const noexcept { return false; }
+            inline void await_suspend(std::coroutine_handle<> handle) { pool.scheduleCallable(priority, [handle] { handle.resume(); }); }
+            inline void await_resume() const noexcept { }
+        };
+
+        /**
+         * @brief 在协程中 co_await pool.schedule()，协程剩下的部分会在线程池的某个工作线程中继续执行
+         * @param priority 协程剩下的部分以什么优先级执行
+         * @return ScheduleAwaiter 等待体
+         * @throws std::runtime_error 线程池已经停止，在 co_await 的位置抛出
+         */
+        inline ScheduleAwaiter schedule(TaskPriority priority = TaskPriority::Normal) { return ScheduleAwaiter { *this, priority }; }
+
+        /**
+         * @brief 开始新的一帧，重置后台任务的时间预算，Application 每一帧调用一次
+         */
+        void beginFrame();
+
+        /**
+         * @brief 设置每一帧后台任务可以使用的时间预算（所有线程执行后台任务的时间之和），用完之后后台任务要等到下一帧才会继续执行
+         * @param budget 时间预算，为0时不限制
+         * @note 预算按任务计算，已经开始的后台任务不会被打断，所以一帧实际使用的时间可能会超出预算一个任务的时间
+         */
+        inline void setBackgroundBudget(std::chrono::microseconds budget) {
+            m_backgroundBudget.store(std::chrono::duration_cast<std::chrono::nanoseconds>(budget).count());
+        }
+
+        inline std::chrono::microseconds getBackgroundBudget() const {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(m_backgroundBudget.load()));
+        }
+
+        /**
+         * @brief 获取某一条车道中正在排队的任务数量，用于监控
+         * @param priority 车道的优先级
+         * @return size_t 排队的任务数量，Normal 车道包括所有工作线程的本地队列，是一个近似值
+         */
+        size_t getQueueDepth(TaskPriority priority) const;
+
+        inline ThreadPoolMode getMode() const { return m_mode; }
+        inline const ThreadPoolConfig& getConfig() const { return m_config; }
+        inline size_t getThreadCount() const { return m_threads.size(); }
+
+        /**
+         * @brief 线程池中的任务对象，可调用对象直接存放在内部的缓冲区里，放不下的时候才会在堆上分配
+         */
+        class Job {
+        public:
+            static constexpr size_t s_inlineSize = 96;
+
+            Job() = default;
+            Job(const Job&) = delete;
+            Job& operator=(const Job&) = delete;
+            ~Job() { reset(); }
+
+            template <typename Func>
+            void emplace(Func&& func) {
+                using Callable = std::decay_t<Func>;
+                if constexpr (sizeof(Callable) <= s_inlineSize && alignof(Callable) <= alignof(std::max_align_t)) {
+                    new (m_storage) Callable(std::forward<Func>(func));
+                    m_invoke = [](Job& job) { (*std::launder(reinterpret_cast<Callable*>(job.m_storage)))(); };
+                    m_destroy = [](Job& job) { std::launder(reinterpret_cast<Callable*>(job.m_storage))->~Callable(); };
+                }
+                else {
+                    *reinterpret_cast<Callable**>(m_storage) = new Callable(std::forward<Func>(func));
+                    m_invoke = [](Job& job) { (**reinterpret_cast<Callable**>(job.m_storage))(); };
+                    m_destroy = [](Job& job) { delete *reinterpret_cast<Callable**>(job.m_storage); };
+                }
+            }
+
+            /**
+             * @brief 执行任务，执行完毕（包括抛出异常）之后销毁可调用对象
+             */
+            inline void run() {
+                struct Guard {
+                    Job& job;
+                    ~Guard() { job.reset(); }
+                } guard { *this };
+                m_invoke(*this);
+            }
+
+            inline TaskPriority getPriority() const { return m_priority; }
+            inline void setPriority(TaskPriority priority) { m_priority = priority; }
+
+            inline void reset() {
+                if (m_destroy != nullptr) {
+                    m_destroy(*this);
+                    m_destroy = nullptr;
+                    m_invoke = nullptr;
+                }
+            }
+
+        private:
+            alignas(std::max_align_t) unsigned char m_storage[s_inlineSize];
+            void (*m_invoke)(Job&) = nullptr;
+            void (*m_destroy)(Job&) = nullptr;
+            TaskPriority m_priority = TaskPriority::Normal;
+        };
+
+        // 每个线程池预分配的任务对象数量
+        static constexpr size_t s_jobPoolCapacity = 16384;
+
     private:
-        void Work();
+        struct Worker {
+            WorkStealingDeque<Job*> deque;
+        };
+
+        /**
+         * @brief 全局队列中的一条车道，可以增长的环形缓冲区，访问时需要持有 m_queueMutex
+         */
+        struct JobRing {
+            std::vector<Job*> buffer = std::vector<Job*>(1024, nullptr);
+            size_t head = 0;
+            size_t size = 0;
+
+            void push(Job* job);
+            Job* pop();
+        };
+
+        static constexpr size_t s_priorityCount = 3;
+
+        static constexpr size_t lane(TaskPriority priority) { return static_cast<size_t>(priority); }
+
+        /**
+         * @brief 工作线程的主循环
+         * @param index 工作线程的序号
+         * @param core 固定到哪一个CPU核心上，小于0时不固定
+         */
+        void Work(size_t index, int core);
+
+        /**
+         * @brief 睡眠之前自旋等待任务
+         * @return true 自旋期间出现了可以执行的任务
+         * @return false 自旋结束也没有任务，或者线程池已经停止
+         */
+        bool spinForWork() const;
+
+        /**
+         * @brief 把 chunkCount 块工作分给若干辅助任务和调用线程，直到所有块都执行完毕才返回
+         * @param chunkCount 块的数量
+         * @param chunk 执行某一块的函数
+         */
+        template <typename ChunkFunc>
+        void runChunks(size_t chunkCount, ChunkFunc& chunk);
+
+        template <typename Index>
+        size_t chunkSize(Index begin, Index end, Index grain) const;
+
+        /**
+         * @brief 将任务放入它的优先级对应的队列并唤醒工作线程，如果调用者是本线程池的工作线程并且任务是 Normal 优先级，则放入它自己的双端队列
+         * @param job 任务
+         * @throws std::runtime_error 线程池已经停止
+         */
+        void enqueue(Job* job);
+
+        /**
+         * @brief 将同一个优先级的一批任务放入队列，全局队列只加一次锁，然后唤醒 min(任务数量, 睡眠线程数量) 个工作线程
+         * @param jobs 任务
+         * @param count 任务数量
+         * @param priority 这批任务的优先级
+         * @throws std::runtime_error 线程池已经停止，这批任务会被丢弃
+         */
+        void enqueueBatch(Job* const* jobs, size_t count, TaskPriority priority);
+
+        /**
+         * @brief 线程池已经停止时，丢弃这些还没有放进队列的任务
+         * @throws std::runtime_error 总是抛出
+         */
+        [[noreturn]] void rejectJobs(Job* const* jobs, size_t count);
+
+        /**
+         * @brief 申请一个任务对象，任务池用完了的时候，提交者会先帮忙执行已经排队的任务来腾出任务对象，实在不行才在堆上分配
+         * @return Job* 任务对象
+         */
+        Job* acquireJob();
+        void releaseJob(Job* job);
+
+        /**
+         * @brief 取出当前线程缓存的任务指针数组，用完之后用 releaseJobList() 还回去
+         * @note 提交一批任务的过程中可能会帮忙执行其他任务，其中又提交了一批任务，所以是取出而不是直接引用，嵌套的那一次会拿到一个新的数组
+         * @param capacity 需要的容量
+         */
+        std::vector<Job*> acquireJobList(size_t capacity);
+        void releaseJobList(std::vector<Job*>&& jobs);
+
+        /**
+         * @brief 把一个可调用对象包装成任务并放入队列
+         */
+        template <typename Func>
+        inline void scheduleCallable(TaskPriority priority, Func&& func) {
+            Job* job = acquireJob();
+            job->emplace(std::forward<Func>(func));
+            job->setPriority(priority);
+            enqueue(job);
+        }
+
+        /**
+         * @brief 在当前线程执行一个正在排队的任务，工作线程和外部线程都可以调用
+         * @return true 执行了一个任务
+         * @return false 没有找到任务
+         */
+        bool runPendingJob(bool allowBackground = true);
+        void runJob(Job* job);
+
+        /**
+         * @brief 等待者空闲了一段时间之后调用，不受每帧预算和后台线程数量上限的限制，执行一个正在排队的后台任务
+         * @return true 执行了一个任务
+         * @return false 没有后台任务
+         */
+        bool runBlockedBackgroundJob();
+
+        /**
+         * @brief 帮忙等待的时候没有任务可以执行，先让出几次时间片，还是没有任务就短暂地睡一会儿
+         * @param idleRounds 连续没有找到任务的次数
+         */
+        static void idle(uint32_t& idleRounds);
+
+        // 等待者连续空闲这么多次之后，开始自己执行后台任务
+        static constexpr uint32_t s_blockedIdleRounds = 64;
+
+        /**
+         * @brief 按照 Critical 车道 -> 本地队列 -> Normal 车道 -> 窃取 -> Background 车道 的顺序寻找一个任务
+         * @param index 工作线程的序号
+         * @param allowBackground 是否可以取后台任务
+         * @return Job* 找到的任务，没找到返回nullptr
+         */
+        Job* findJob(size_t index, bool allowBackground = true);
+        Job* popGlobal(TaskPriority priority);
+        Job* steal(size_t thief);
+        /**
+         * @brief 有睡眠的工作线程时唤醒其中的 count 个
+         */
+        void notifyWorkers(size_t count = 1);
+
+        /**
+         * @brief 现在能不能开始一个后台任务：有排队的后台任务，预算还没有用完，执行后台任务的线程数量没有达到上限
+         */
+        bool backgroundRunnable() const;
 
         std::condition_variable m_cv;
         std::vector<std::thread> m_threads;
+        std::vector<UniqueRef<Worker>> m_workers;
         std::mutex m_queueMutex;
-        std::queue<std::function<void()>> m_taskQueue;
-        bool m_stopped;
+        std::array<JobRing, s_priorityCount> m_taskQueue;                   // 全局注入队列，每个优先级一条车道，外部线程提交的任务都在这里
+        ObjectPool<Job> m_jobPool;
+        std::array<std::atomic<size_t>, s_priorityCount> m_globalCount {};  // 每条车道中的任务数量，用于在不加锁的情况下判断是否为空
+        std::atomic<size_t> m_pendingCount = 0;     // 所有队列中尚未被取走的 Critical 和 Normal 任务数量
+        std::atomic<int> m_sleepingCount = 0;       // 正在等待任务的线程数量
+
+        // 后台任务的限制
+        size_t m_backgroundLimit;                       // 同时执行后台任务的线程数量上限，见 BackgroundLimit()
+        std::atomic<size_t> m_backgroundRunning = 0;    // 正在执行后台任务的线程数量
+        std::atomic<int64_t> m_backgroundBudget = 0;    // 每一帧的后台时间预算，单位为纳秒，为0时不限制
+        std::atomic<int64_t> m_backgroundSpent = 0;     // 这一帧后台任务已经使用的时间，单位为纳秒
+        std::atomic<bool> m_stopped;
+        ThreadPoolConfig m_config;
+        ThreadPoolMode m_mode;
     };
 
 
@@ -37,6 +594,11 @@ namespace Hazy {
      */
     template <typename Func, typename... Args>
     std::future<std::invoke_result_t<Func, Args...>> ThreadPool::Execute(Func&& func, Args&&... args) {
+        return Execute(TaskPriority::Normal, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template <typename Func, typename... Args>
+    std::future<std::invoke_result_t<Func, Args...>> ThreadPool::Execute(TaskPriority priority, Func&& func, Args&&... args) {
         using return_type = std::invoke_result_t<Func, Args...>;
 
         // 包装任务为一个函数对象
@@ -45,16 +607,270 @@ namespace Hazy {
         );
 
         std::future<return_type> future = task->get_future();
+        scheduleCallable(priority, [task]() { (*task)(); });
+        return future;
+    }
 
-        {
-            std::unique_lock<std::mutex> lock(m_queueMutex);
-            if (m_stopped)
-                throw std::runtime_error("ThreadPool has been stopped.");
-            m_taskQueue.emplace([task]() { (*task)(); });
-        }
+    template <typename Func, typename... Args>
+    void ThreadPool::Submit(Func&& func, Args&&... args) {
+        Submit(TaskPriority::Normal, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template <typename Func, typename... Args>
+    void ThreadPool::Submit(TaskPriority priority, Func&& func, Args&&... args) {
+        scheduleCallable(priority,
+            [func = std::forward<Func>(func), ...args = std::forward<Args>(args)]() mutable {
+                try {
+                    std::invoke(func, args...);
+                }
+                catch (const std::exception& e) {
+                    Logger::LogError("Unhandled exception in submitted task: {}", e.what());
+                }
+                catch (...) {
+                    Logger::LogError("Unhandled exception in submitted task");
+                }
+            });
+    }
+
+    template <typename Func, typename... Args>
+    PooledFuture<std::invoke_result_t<Func, Args...>> ThreadPool::ExecutePooled(Func&& func, Args&&... args) {
+        return ExecutePooled(TaskPriority::Normal, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
 
-        m_cv.notify_one();
+    template <typename Func, typename... Args>
+    PooledFuture<std::invoke_result_t<Func, Args...>> ThreadPool::ExecutePooled(TaskPriority priority, Func&& func, Args&&... args) {
+        using return_type = std::invoke_result_t<Func, Args...>;
+
+        FutureState* state = FutureState::acquire();
+        PooledFuture<return_type> future(state);
+        scheduleCallable(priority,
+            [promise = FuturePromise(state), func = std::forward<Func>(func), ...args = std::forward<Args>(args)]() mutable {
+                try {
+                    if constexpr (std::is_void_v<return_type>) {
+                        std::invoke(func, args...);
+                        promise.setVoid();
+                    }
+                    else {
+                        promise.setValue(std::invoke(func, args...));
+                    }
+                }
+                catch (...) {
+                    promise.setException(std::current_exception());
+                }
+            });
+        return future;
+    }
+
+    template <typename Func, typename... Args>
+    PooledFuture<CancellableResult_t<Func, Args...>> ThreadPool::ExecuteCancellable(CancellationToken token, Func&& func, Args&&... args) {
+        return ExecuteCancellable(TaskPriority::Normal, std::move(token), std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template <typename Func, typename... Args>
+    PooledFuture<CancellableResult_t<Func, Args...>> ThreadPool::ExecuteCancellable(TaskPriority priority, CancellationToken token, Func&& func, Args&&... args) {
+        using return_type = CancellableResult_t<Func, Args...>;
+
+        FutureState* state = FutureState::acquire();
+        PooledFuture<return_type> future(state);
+        FuturePromise promise(state, token);
+        if (future.isCancelled())
+            return future;
+        scheduleCallable(priority,
+            [promise = std::move(promise), token = std::move(token), func = std::forward<Func>(func), ...args = std::forward<Args>(args)]() mutable {
+                // 在 cancel() 的时候已经被标记为取消了，直接丢弃
+                if (!promise.tryStart())
+                    return;
+                auto invoke = [&]() -> return_type {
+                    if constexpr (std::is_invocable_v<decltype(func)&, const CancellationToken&, decltype(args)&...>)
+                        return std::invoke(func, std::as_const(token), args...);
+                    else
+                        return std::invoke(func, args...);
+                };
+                try {
+                    if constexpr (std::is_void_v<return_type>) {
+                        invoke();
+                        promise.setVoid();
+                    }
+                    else {
+                        promise.setValue(invoke());
+                    }
+                }
+                catch (const TaskCancelled&) {
+                    promise.setCancelled();
+                }
+                catch (...) {
+                    promise.setException(std::current_exception());
+                }
+            });
         return future;
     }
 
+    template <std::ranges::contiguous_range Funcs>
+    TaskGroup ThreadPool::ExecuteBatch(Funcs&& funcs) {
+        return ExecuteBatch(TaskPriority::Normal, std::forward<Funcs>(funcs));
+    }
+
+    template <std::ranges::contiguous_range Funcs>
+    TaskGroup ThreadPool::ExecuteBatch(TaskPriority priority, Funcs&& funcs) {
+        size_t count = std::ranges::size(funcs);
+        TaskGroup::State* state = TaskGroup::State::acquire(count);
+        TaskGroup group(state);
+        if (count == 0)
+            return group;
+
+        // 任务指针数组是当前线程复用的，稳定状态下不会分配内存
+        std::vector<Job*> jobs = acquireJobList(count);
+        for (auto& func : funcs) {
+            Job* job = acquireJob();
+            job->emplace(
+                [state, func = func]() mutable {
+                    try {
+                        std::invoke(func);
+                    }
+                    catch (...) {
+                        state->fail(std::current_exception());
+                    }
+                    state->finish();
+                });
+            job->setPriority(priority);
+            jobs.push_back(job);
+        }
+
+        try {
+            enqueueBatch(jobs.data(), jobs.size(), priority);
+        }
+        catch (...) {
+            // 任务已经被丢弃，不会再有任务释放它们的那一份引用
+            state->release();
+            throw;
+        }
+        releaseJobList(std::move(jobs));
+        return group;
+    }
+
+    template <typename Future>
+    decltype(auto) ThreadPool::wait(Future&& future) {
+        auto ready = [&future] {
+            if constexpr (requires { future.isReady(); })
+                return future.isReady();
+            else
+                return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        };
+
+        uint32_t idleRounds = 0;
+        while (!ready()) {
+            if (runPendingJob(false) || (idleRounds >= s_blockedIdleRounds && runBlockedBackgroundJob()))
+                idleRounds = 0;
+            else
+                idle(idleRounds);
+        }
+        return future.get();
+    }
+
+    template <typename ChunkFunc>
+    void ThreadPool::runChunks(size_t chunkCount, ChunkFunc& chunk) {
+        if (chunkCount == 0)
+            return;
+
+        // 共享状态由所有参与者共同持有，调用线程返回之后才开始执行的辅助任务只会访问共享状态，不会访问 chunk
+        struct State {
+            std::atomic<size_t> next = 0;
+            std::atomic<size_t> done = 0;
+            std::atomic<bool> failed = false;
+            std::exception_ptr exception;
+            size_t count = 0;
+            ChunkFunc* chunk = nullptr;
+
+            void participate() {
+                size_t index;
+                while ((index = next.fetch_add(1)) < count) {
+                    if (!failed.load(std::memory_order_relaxed)) {
+                        try {
+                            (*chunk)(index);
+                        }
+                        catch (...) {
+                            if (!failed.exchange(true))
+                                exception = std::current_exception();
+                        }
+                    }
+                    if (done.fetch_add(1) + 1 == count)
+                        done.notify_all();
+                }
+            }
+        };
+
+        auto state = std::make_shared<State>();
+        state->count = chunkCount;
+        state->chunk = &chunk;
+
+        size_t helpers = std::min(m_threads.size(), chunkCount - 1);
+        for (size_t i = 0; i < helpers; i++) {
+            scheduleCallable(TaskPriority::Normal, [state]() { state->participate(); });
+        }
+        state->participate();
+
+        // 调用线程自己领不到块了，等待其他线程手上的块执行完毕
+        size_t done;
+        while ((done = state->done.load()) < chunkCount) {
+            state->done.wait(done);
+        }
+        if (state->exception)
+            std::rethrow_exception(state->exception);
+    }
+
+    template <typename Index>
+    size_t ThreadPool::chunkSize(Index begin, Index end, Index grain) const {
+        size_t length = static_cast<size_t>(end - begin);
+        if (grain > Index(0))
+            return static_cast<size_t>(grain);
+        // 自动分块：每个线程大约分到4块，兼顾负载均衡和调度开销
+        size_t parts = std::max<size_t>(1, (m_threads.size() + 1) * 4);
+        return std::max<size_t>(1, (length + parts - 1) / parts);
+    }
+
+    template <typename Index, typename Func>
+    void ThreadPool::parallelFor(Index begin, Index end, Index grain, Func&& func) {
+        if (!(begin < end))
+            return;
+        size_t length = static_cast<size_t>(end - begin);
+        size_t size = chunkSize(begin, end, grain);
+
+        auto chunk = [&](size_t index) {
+            Index chunkBegin = static_cast<Index>(begin + static_cast<Index>(index * size));
+            Index chunkEnd = static_cast<Index>(begin + static_cast<Index>(std::min(length, (index + 1) * size)));
+            if constexpr (std::is_invocable_v<Func&, Index, Index>) {
+                func(chunkBegin, chunkEnd);
+            }
+            else {
+                for (Index i = chunkBegin; i < chunkEnd; ++i) {
+                    func(i);
+                }
+            }
+        };
+        runChunks((length + size - 1) / size, chunk);
+    }
+
+    template <typename Index, typename T, typename Reduce, typename Combine>
+    T ThreadPool::parallelReduce(Index begin, Index end, Index grain, T identity, Reduce&& reduce, Combine&& combine) {
+        if (!(begin < end))
+            return identity;
+        size_t length = static_cast<size_t>(end - begin);
+        size_t size = chunkSize(begin, end, grain);
+        size_t chunkCount = (length + size - 1) / size;
+
+        std::vector<T> partials(chunkCount, identity);
+        auto chunk = [&](size_t index) {
+            Index chunkBegin = static_cast<Index>(begin + static_cast<Index>(index * size));
+            Index chunkEnd = static_cast<Index>(begin + static_cast<Index>(std::min(length, (index + 1) * size)));
+            partials[index] = reduce(chunkBegin, chunkEnd, identity);
+        };
+        runChunks(chunkCount, chunk);
+
+        T result = std::move(partials[0]);
+        for (size_t i = 1; i < chunkCount; i++) {
+            result = combine(std::move(result), std::move(partials[i]));
+        }
+        return result;
+    }
+
 }
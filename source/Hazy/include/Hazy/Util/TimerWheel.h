@@ -0,0 +1,139 @@
+#pragma once
+#include <hazy_pch.h>
+
+namespace Hazy {
+
+    /**
+     * @brief 分层时间轮，管理大量的一次性定时器和重复定时器，时间的单位是抽象的“刻”（比如一毫秒或者一帧）
+     * @note - 一共 s_levelCount 层，每层 s_slotCount 个槽，第 n 层的一个槽跨越 s_slotCount^n 刻，
+     * 定时器按照剩余的时间放进对应的层，走到高层的槽时再把里面的定时器分散到低层
+     * @note - 添加和取消定时器都是 O(1)：定时器是侵入式双向链表中的节点，节点放在对象池中复用
+     * @note - 定时器按照到期的先后触发，同一刻到期的定时器之间的顺序不做保证，超过时间轮范围的定时器先放在最高层，转到时再重新放置
+     * @note - 定时器的回调可以添加或者取消任何定时器，包括它自己
+     * @warning 这个类不是线程安全的，只能在一个线程中使用
+     */
+    class HAZY_API TimerWheel {
+    public:
+        using Callback = std::function<void()>;
+
+        static constexpr uint32_t s_slotBits = 6;
+        static constexpr uint32_t s_slotCount = 1u << s_slotBits;
+        static constexpr uint32_t s_levelCount = 4;
+
+        /**
+         * @brief 定时器的句柄，用于取消定时器，定时器结束之后句柄自动失效，不会误取消复用了同一个节点的新定时器
+         */
+        struct Handle {
+            const TimerWheel* owner = nullptr;
+            uint32_t index = 0;
+            uint32_t generation = 0;
+
+            inline bool valid() const { return owner != nullptr; }
+        };
+
+        TimerWheel();
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        /**
+         * @brief 添加一个一次性定时器
+         * @param delay 多少刻之后触发，为0时和1相同，在下一次 advance() 时触发
+         * @param callback 触发时调用的函数
+         * @return Handle 定时器的句柄
+         */
+        inline Handle schedule(uint64_t delay, Callback callback) { return add(delay, 0, std::move(callback)); }
+
+        /**
+         * @brief 添加一个重复定时器，取消之前每隔 interval 刻触发一次
+         * @param interval 间隔，为0时和1相同
+         * @param callback 触发时调用的函数
+         * @param firstDelay 第一次触发前等待多少刻，为0时等于 interval
+         * @return Handle 定时器的句柄
+         * @note 一次 advance() 跨过了好几个间隔时，每一个间隔都会触发一次
+         */
+        inline Handle scheduleRepeating(uint64_t interval, Callback callback, uint64_t firstDelay = 0) {
+            interval = std::max<uint64_t>(interval, 1);
+            return add(firstDelay == 0 ? interval : firstDelay, interval, std::move(callback));
+        }
+
+        /**
+         * @brief 取消一个定时器
+         * @param handle 定时器的句柄
+         * @return true 取消成功
+         * @return false 定时器已经触发完了、已经被取消了，或者句柄不属于这个时间轮
+         */
+        bool cancel(Handle handle);
+
+        /**
+         * @brief 定时器是否还没有结束（一次性定时器还没有触发，或者重复定时器还没有被取消）
+         */
+        bool isPending(Handle handle) const;
+
+        /**
+         * @brief 时间前进若干刻，依次触发这段时间内到期的所有定时器
+         * @param ticks 前进多少刻
+         * @return size_t 触发的次数
+         */
+        size_t advance(uint64_t ticks = 1);
+
+        /**
+         * @brief 时间前进到 tick，比当前时间早的话什么也不做
+         */
+        inline size_t advanceTo(uint64_t tick) { return tick > m_now ? advance(tick - m_now) : 0; }
+
+        /**
+         * @brief 当前的时间（刻）
+         */
+        inline uint64_t now() const { return m_now; }
+
+        /**
+         * @brief 还没有结束的定时器的数量
+         */
+        inline size_t size() const { return m_size; }
+        inline bool empty() const { return m_size == 0; }
+
+    private:
+        static constexpr uint32_t s_nil = UINT32_MAX;
+        static constexpr uint32_t s_sentinelCount = s_slotCount * s_levelCount;
+        static constexpr uint32_t s_scratch = s_sentinelCount;  // 把高层的槽分散到低层时暂存节点的链表的哨兵
+
+        // 链表节点，前 s_sentinelCount + 1 个节点是哨兵，不是定时器
+        struct Node {
+            uint32_t prev;
+            uint32_t next;
+            uint32_t generation = 0;
+            bool active = false;
+            uint64_t expiry = 0;
+            uint64_t interval = 0;  // 为0表示一次性定时器
+            Callback callback;
+        };
+
+        Handle add(uint64_t delay, uint64_t interval, Callback callback);
+
+        /**
+         * @brief 按照到期时间把节点放进对应的槽
+         */
+        void place(uint32_t index);
+
+        /**
+         * @brief 把第 level 层第 slot 个槽中的定时器按照剩下的时间重新放置
+         */
+        void cascade(uint32_t level, uint32_t slot);
+
+        void linkBefore(uint32_t sentinel, uint32_t index);
+        void unlink(uint32_t index);
+        void release(uint32_t index);
+
+        /**
+         * @brief 时间前进一刻，返回触发的次数
+         */
+        size_t tick();
+
+        std::vector<Node> m_nodes;
+        uint32_t m_freeHead = s_nil;    // 空闲节点组成的单向链表，用 next 连接
+        uint64_t m_now = 0;
+        size_t m_size = 0;
+    };
+
+}
\ No newline at end of file
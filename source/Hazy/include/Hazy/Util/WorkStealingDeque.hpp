@@ -0,0 +1,107 @@
+#pragma once
+#include <hazy_pch.h>
+
+namespace Hazy {
+
+    /**
+     * @brief 工作窃取双端队列（Chase-Lev），容量固定
+     * @tparam T 元素类型，必须是指针类型
+     * @tparam Capacity 容量，必须是2的幂
+     * @note - 只有拥有者线程可以调用 push() 和 pop()，它们操作队列的底部（后进先出）
+     * @note - 任何线程都可以调用 steal()，它从队列的顶部取走元素（先进先出）
+     */
+    template <typename T, size_t Capacity = 4096>
+    class WorkStealingDeque {
+        static_assert(std::is_pointer_v<T>, "WorkStealingDeque only stores pointers");
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+    public:
+        WorkStealingDeque() {
+            for (auto& slot : m_buffer) {
+                slot.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        /**
+         * @brief 往队列底部压入一个元素，只能由拥有者线程调用
+         * @param item 元素
+         * @return true 压入成功
+         * @return false 队列已满
+         */
+        inline bool push(T item) {
+            int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            int64_t top = m_top.load(std::memory_order_acquire);
+            if (bottom - top >= static_cast<int64_t>(Capacity))
+                return false;
+            m_buffer[bottom & s_mask].store(item, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief 从队列底部弹出一个元素，只能由拥有者线程调用
+         * @return T 弹出的元素，队列为空时返回nullptr
+         */
+        inline T pop() {
+            int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                // 队列为空，恢复底部
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T item = m_buffer[bottom & s_mask].load(std::memory_order_relaxed);
+            if (top == bottom) {
+                // 只剩最后一个元素，需要和窃取者竞争
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    item = nullptr;
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        /**
+         * @brief 从队列顶部窃取一个元素，任何线程都可以调用
+         * @return T 窃取到的元素，队列为空或者竞争失败时返回nullptr
+         */
+        inline T steal() {
+            int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom)
+                return nullptr;
+
+            T item = m_buffer[top & s_mask].load(std::memory_order_relaxed);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return item;
+        }
+
+        /**
+         * @brief 队列中元素的大致数量，只用于统计和启发式判断
+         */
+        inline size_t size() const {
+            int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            int64_t top = m_top.load(std::memory_order_relaxed);
+            return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+        }
+
+        inline bool empty() const { return size() == 0; }
+
+    private:
+        static constexpr int64_t s_mask = static_cast<int64_t>(Capacity) - 1;
+
+        // top 和 bottom 分别放在不同的缓存行，避免拥有者和窃取者之间的伪共享
+        alignas(64) std::atomic<int64_t> m_top { 0 };
+        alignas(64) std::atomic<int64_t> m_bottom { 0 };
+        alignas(64) std::array<std::atomic<T>, Capacity> m_buffer;
+    };
+
+}
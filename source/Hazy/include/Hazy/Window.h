@@ -2,14 +2,19 @@
 #include "Hazy/Window.h"
 #include "Hazy/Util/Log.h"
 #include "Hazy/Util/TimePoint.h"
+#include "Hazy/Util/FixedTimestep.h"
+#include "Hazy/Util/DoubleBuffer.h"
+#include "Hazy/Util/TaskGraph.h"
 #include "Hazy/LayerStack/LayerStack.h"
 #include "Hazy/Renderer/Context.h"
 #include "Hazy/Renderer/Renderer.h"
+#include "Hazy/Renderer/RenderThread.h"
 
 namespace Hazy {
     class Application;
     class Window;
     class Event;
+    struct EventTimestamps;
 
     /**
      * @brief 窗口属性，用于初始化窗口，包括了窗口标题，窗口宽度，窗口高度，父窗口以及子窗口，禁用拷贝构造，允许移动构造
@@ -92,6 +97,103 @@ namespace Hazy {
         virtual inline bool isVSync() const { return m_isVSync; }
 
         inline LayerStack& getLayerStack() { return m_layerStack; }
+
+        /**
+         * @brief 获取此窗口的帧任务图，图中的节点每一帧都会在线程池中执行一次
+         * @note - 帧任务图在 m_updateFunc 之前启动，和 m_updateFunc 以及其他窗口的工作并行执行，在切换到渲染上下文之前等待它完成
+         * @note - 帧任务图的节点以 TaskPriority::Critical 优先级执行，不会被后台任务拖慢
+         * @note - 节点在工作线程中执行，不会有渲染上下文，需要上下文的工作请放在 m_renderFunc 中
+         * @return TaskGraph& 帧任务图
+         */
+        inline TaskGraph& getFrameGraph() { return m_frameGraph; }
+
+        /**
+         * @brief 把一个需要上下文的函数交给这个窗口的渲染线程，在下一次 update() 切换到这个窗口的上下文之后执行
+         * @tparam Func 调用函数的类型
+         * @param func 需要上下文的函数
+         * @note 可以在任意线程调用，投递是无锁的
+         */
+        template <typename Func>
+        inline void postToRenderThread(Func&& func) { m_context->getDispatcher().Submit(std::forward<Func>(func)); }
+
+        /**
+         * @brief 把一个需要上下文的函数交给这个窗口的渲染线程，并返回它的结果
+         * @tparam Func 调用函数的类型
+         * @param func 需要上下文的函数
+         * @return PooledFuture<std::invoke_result_t<Func>> 函数返回值，比如上传完成的纹理
+         * @warning 不要在渲染线程上等待返回的 future，函数要等到下一次 update() 才会执行
+         */
+        template <typename Func>
+        inline PooledFuture<std::invoke_result_t<Func>> executeOnRenderThread(Func&& func) {
+            return m_context->getDispatcher().Execute(std::forward<Func>(func));
+        }
+
+        /**
+         * @brief 设置每一帧执行渲染线程函数的时间预算，用完之后剩下的函数留到下一帧，避免一次上传太多资源造成卡顿
+         * @param budget 时间预算，为0时每一帧执行完所有的函数
+         */
+        inline void setRenderThreadBudget(std::chrono::microseconds budget) { m_renderThreadBudget = budget; }
+        inline std::chrono::microseconds getRenderThreadBudget() const { return m_renderThreadBudget; }
+
+        /**
+         * @brief 当前线程是不是正在这个窗口的上下文中渲染
+         */
+        bool isInRenderThread() const;
+
+        /**
+         * @brief 协程切换到这个窗口的渲染线程时使用的等待体，如果已经在渲染线程中则不会切换
+         */
+        struct RenderThreadAwaiter {
+            Window& window;
+
+            inline bool await_ready() const noexcept { return window.isInRenderThread(); }
+            inline void await_suspend(std::coroutine_handle<> handle) { window.postToRenderThread([handle] { handle.resume(); }); }
+            inline void await_resume() const noexcept { }
+        };
+
+        /**
+         * @brief 在协程中 co_await window.renderThread()，协程剩下的部分会在这个窗口的上下文中继续执行，可以直接创建 GPU 资源
+         * @return RenderThreadAwaiter 等待体
+         * @warning 等待者要到下一次 update() 才会被恢复，不要在渲染线程上阻塞等待这样的协程
+         */
+        inline RenderThreadAwaiter renderThread() { return RenderThreadAwaiter { *this }; }
+
+        /**
+         * @brief 开启固定时间步长模式，m_updateFunc 按照固定的频率执行，和渲染的帧率无关，比如以 30 Hz 模拟、以 144 Hz 渲染
+         * @param tickRate 每秒执行多少次 m_updateFunc
+         * @param maxCatchUpSteps 一帧最多执行多少次 m_updateFunc，卡顿之后超出的时间直接丢弃
+         * @throws std::invalid_argument tickRate 不是正数，或者 maxCatchUpSteps 为0，这时原来的设置不变
+         * @note - 每一帧累加帧间隔，够几个步长就执行几次 m_updateFunc，可能是0次，执行期间 m_deltaTime 等于步长
+         * @note - m_renderFunc 每一帧执行一次，插值系数见 getInterpolationAlpha()，帧间隔见 getRenderDeltaTime()
+         * @note - 帧任务图仍然每一帧执行一次
+         */
+        inline void setFixedTimestep(float tickRate, uint32_t maxCatchUpSteps = 5) { m_fixedTimestep = FixedTimestep(tickRate, maxCatchUpSteps); }
+
+        /**
+         * @brief 关闭固定时间步长模式，恢复为每一帧执行一次 m_updateFunc
+         */
+        inline void disableFixedTimestep() { m_fixedTimestep.reset(); }
+
+        inline bool isFixedTimestep() const { return m_fixedTimestep.has_value(); }
+
+        /**
+         * @brief 获取固定时间步长的累加器，没有开启固定时间步长模式时为nullptr
+         */
+        inline const FixedTimestep* getFixedTimestep() const { return m_fixedTimestep ? &*m_fixedTimestep : nullptr; }
+
+        /**
+         * @brief 渲染时的插值系数，取值范围为 [0, 1]，在上一次和最近一次 m_updateFunc 的状态之间插值
+         * @note 在同步点（见 m_syncFunc）更新，渲染线程渲染第N帧时读到的是第N帧的插值系数
+         * @note 没有开启固定时间步长模式时总是1，也就是直接使用最近一次更新的状态
+         */
+        inline float getInterpolationAlpha() const { return m_interpolationAlpha; }
+
+        /**
+         * @brief 渲染时使用的帧间隔，在同步点从 m_deltaTime 复制过来，m_renderFunc 和层的 update() 请使用它
+         * @note 使用渲染线程时主线程会同时更新下一帧、修改 m_deltaTime，渲染时不能读 m_deltaTime
+         */
+        inline float getRenderDeltaTime() const { return m_renderDeltaTime; }
+
         inline Context& getRenderContext() const { return *m_context; }
 
         inline unsigned int getWidth() const { return m_props.width; }
@@ -127,11 +229,36 @@ namespace Hazy {
 
     protected:
 
+        /**
+         * @brief 开始新的一帧：计算帧间隔，然后在线程池中启动帧任务图，一帧只会生效一次
+         * @note Application 会先让所有窗口开始新的一帧，再逐个调用 update()，这样不同窗口的帧任务图可以并行执行
+         */
+        virtual void beginFrame();
+
         /**
          *@brief 这个窗口在绘制每一帧的时候调用的函数，包括切换上下文，交换双缓冲，清除颜色等
+         * @note 依次调用 updateFrame()、syncFrame()、renderFrame()，然后处理窗口系统的事件。
+         * 使用渲染线程（见 Application::setRenderMode()）时不会调用这个函数，这三步由 Application 分别调用
          */
         virtual void update();
 
+        /**
+         * @brief 一帧中不需要上下文的部分：开始新的一帧，执行 m_updateFunc，等待帧任务图完成，总是在主线程中执行
+         */
+        void updateFrame();
+
+        /**
+         * @brief 更新和渲染之间的同步点：交换登记的帧数据，调用 m_syncFunc，把这一帧的帧间隔、插值系数和输入事件交给渲染
+         * @note 使用渲染线程时，调用这个函数的时候渲染线程一定是空闲的
+         */
+        void syncFrame();
+
+        /**
+         * @brief 一帧中需要上下文的部分：执行渲染线程函数、m_renderFunc 和层的 update()，然后交换缓冲区，
+         * 使用渲染线程时在渲染线程中执行
+         */
+        void renderFrame();
+
         /**
          * @brief 当窗口收到事件时调用，就是将事件转发给层，也可以在这个函数中处理事件
          * @param e
@@ -142,7 +269,7 @@ namespace Hazy {
          * @brief 设置垂直同步是否启用
          * @param enabled
          */
-        virtual inline void setVSync(bool enabled) { m_context->enableVSync(enabled); }
+        virtual void setVSync(bool enabled);
 
         /**
          * @brief 设置渲染函数，这个渲染函数不用担心上下文问题，因为在调用这个渲染函数的时候一定在上下文中
@@ -150,10 +277,38 @@ namespace Hazy {
          */
         virtual inline void setRenderFunc(const std::function<void()>& func) { m_renderFunc = std::move(func); }
 
+        /**
+         * @brief 设置需要插值系数的渲染函数，用于固定时间步长模式
+         * @param func 渲染函数，参数是这一帧的插值系数，见 getInterpolationAlpha()
+         */
+        inline void setRenderFunc(const std::function<void(float)>& func) {
+            setRenderFunc(std::function<void()>([this, func] { func(m_interpolationAlpha); }));
+        }
+
+        /**
+         * @brief 登记一份双缓冲的帧数据，每一帧在同步点交换：m_updateFunc 写 getUpdate()，m_renderFunc 读 getRender()
+         * @param data 帧数据，生命周期不能短于这个窗口
+         * @note 使用渲染线程时，更新和渲染都会访问的数据请放在这里，而不是直接放在窗口的成员里
+         */
+        template <typename T>
+        inline void registerFrameData(DoubleBuffer<T>& data) { m_frameDataSwaps.push_back([&data] { data.swap(); }); }
+
     protected:
         
         virtual void registerEventCallback();
 
+    private:
+        /**
+         * @brief 为这个窗口启动一个专用的渲染线程，上下文一直绑定在这个线程上，已经启动了的话什么也不做
+         */
+        void startRenderThread();
+
+        /**
+         * @brief 等待专用的渲染线程渲染完正在渲染的帧，解除上下文的绑定，然后结束线程，没有专用的渲染线程时什么也不做
+         * @note 之后主线程才能再绑定这个窗口的上下文，比如销毁窗口的时候
+         */
+        void stopRenderThread();
+
     protected:
         WindowProps m_props;
         API m_api;
@@ -170,18 +325,48 @@ namespace Hazy {
         // 用于渲染，指定渲染的时候要干什么，在调用这个函数的时候无需担心上下文问题，因为在调用这个渲染函数的时候一定在上下文中
         std::function<void()> m_renderFunc;
 
-        // 用于指定有上下文的时候额外干什么？比如说调整视口大小，在调用这里面保存的函数的时候一定有上下文
-        std::queue<std::function<void()>> m_contentUpdateQueue;
+        // 更新和渲染之间的同步点，渲染需要的数据在这里从更新交给渲染，登记过的帧数据（见 registerFrameData()）在它之前已经交换好了。
+        // 使用渲染线程时主线程在 m_renderFunc 渲染第N帧的同时执行第N+1帧的 m_updateFunc，
+        // 两者都会访问的数据只能在这里交换，调用这个函数的时候两边都没有在执行
+        std::function<void()> m_syncFunc;
 
-        // 距离上一帧的时间
+        // 距离上一帧的时间，固定时间步长模式下 m_updateFunc 执行期间为步长，只在更新时访问，渲染请使用 m_renderDeltaTime
         float m_deltaTime = 0.0f;
 
+        // 渲染的这一帧距离上一帧的时间，在同步点从 m_deltaTime 复制过来，只在渲染时访问
+        float m_renderDeltaTime = 0.0f;
+
         LayerStack m_layerStack;
         bool m_isVSync = true;
 
-    private:
+        // 每一帧都要执行的、不需要上下文的工作
+        TaskGraph m_frameGraph;
 
+    private:
         TimePoint m_lastFrameTime;
+        bool m_frameBegun = false;
+
+        // 固定时间步长模式的累加器，为空表示每一帧执行一次 m_updateFunc
+        std::optional<FixedTimestep> m_fixedTimestep;
+        float m_interpolationAlpha = 1.0f;
+
+        // 每一帧执行渲染线程函数（上下文的派发器）的时间预算，为0表示不限制
+        std::chrono::microseconds m_renderThreadBudget { 0 };
+
+        // 上一次交换缓冲区之后分发给这个窗口的输入事件的时间戳，交换缓冲区之后交给 InputLatency 统计
+        std::vector<EventTimestamps> m_pendingInputs;
+
+        // 正在渲染的这一帧对应的输入事件的时间戳，同步点从 m_pendingInputs 交换过来，只在渲染时访问
+        std::vector<EventTimestamps> m_presentingInputs;
+
+        // 登记的双缓冲帧数据的交换函数，在同步点依次调用
+        std::vector<std::function<void()>> m_frameDataSwaps;
+
+        // 渲染这个窗口的渲染线程，为nullptr表示在主线程中渲染，由 Application 设置
+        RenderThread* m_renderThread = nullptr;
+
+        // 这个窗口专用的渲染线程（RenderMode::PerWindow），上下文一直绑定在它上面
+        UniqueRef<RenderThread> m_ownedRenderThread;
     };
 }
 
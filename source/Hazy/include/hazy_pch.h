@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <array>
 #include <queue>
 #include <stack>
 #include <set>
@@ -23,6 +24,10 @@
 #include <chrono>
 #include <utility>
 #include <type_traits>
+#include <optional>
+#include <coroutine>
+#include <span>
+#include <ranges>
 
 #include <spdlog/spdlog.h>
 #include <glm/glm.hpp>
@@ -42,4 +47,4 @@ using firstArg_t = typename std::function<
         )
 >::argument_type;
 
-#include "Hazy/Definition.h"
\ No newline at end of file
+#include "Hazy/Definition.h"
\ No newline at end of file
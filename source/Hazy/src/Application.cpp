@@ -6,6 +6,18 @@
 
 namespace Hazy {
     ThreadPool Application::s_threadPool;
+    AsyncIO Application::s_asyncIO(s_threadPool);
+    EventBus Application::s_eventBus;
+    uint64_t Application::s_frameIndex = 0;
+    UniqueRef<EventRecorder> Application::s_recorder;
+    UniqueRef<EventReplay> Application::s_replay;
+    uint64_t Application::s_replayStartFrame = 0;
+    TimerWheel Application::s_timers;
+    TimerWheel Application::s_frameTimers;
+    RenderMode Application::s_renderMode = RenderMode::Serial;
+    UniqueRef<RenderThread> Application::s_renderThread;
+    std::vector<Window*> Application::s_renderingWindows;
+    const std::chrono::steady_clock::time_point Application::s_timerEpoch = std::chrono::steady_clock::now();
     std::unordered_set<UniqueRef<Window>> Application::s_windows;
     std::shared_mutex Application::s_windowMutex;
     Window* Application::s_currentFocused = nullptr;
@@ -25,6 +37,13 @@ namespace Hazy {
     }
 
     Application::~Application() {
+        s_recorder.reset();
+        s_replay.reset();
+        // 先结束渲染线程，窗口销毁时要在主线程中绑定它们的上下文
+        s_renderThread.reset();
+        for (auto& window : s_windows) {
+            window->stopRenderThread();
+        }
         s_windows.clear();
         Logger::LogTrace("Application terminated");
     }
@@ -41,45 +60,214 @@ namespace Hazy {
                 break;
             }
 
+            // 使用渲染线程时交换缓冲区不再处理窗口系统的事件，由主线程在每一帧开始时处理
+            if (s_renderMode != RenderMode::Serial)
+                (*s_windows.begin())->m_context->PollEvents();
+
+            // 先触发到期的定时器，它们投递的事件在这一帧处理
+            AdvanceTimers();
+
             // 在首次进入主循环的时候，检查消息队列，
             // 因为此时有可能已经有窗口了，创建了窗口之后就会有消息进入消息队列
             // 所以在窗口更新状态之前就应该处理已经进入消息队列的事件
-            CheckEvents();
+            // 使用渲染线程时层的 update() 在渲染线程中执行，事件要等到同步点渲染线程空闲时再分发给层，见 PipelineFrame()
+            if (s_renderMode == RenderMode::Serial)
+                CheckEvents();
+
+            // 新的一帧，重置线程池中后台任务的时间预算
+            s_threadPool.beginFrame();
 
+            // 先启动所有窗口的帧任务图，让它们在线程池中并行执行，然后再逐个更新窗口
             for (auto& window : s_windows) {
-                window->update();
+                window->beginFrame();
             }
+            if (s_renderMode == RenderMode::Pipelined) {
+                PipelineFrame();
+            }
+            else if (s_renderMode == RenderMode::PerWindow) {
+                ParallelFrame();
+            }
+            else {
+                for (auto& window : s_windows) {
+                    window->update();
+                }
+            }
+            s_frameIndex++;
         }
+        WaitForRender();
         Hazy::Logger::LogInfo("================== Application exited =====================");
     }
 
+    void Application::setRenderMode(RenderMode mode) {
+        if (mode == s_renderMode)
+            return;
+        WaitForRender();
+        s_renderThread.reset();
+        s_renderingWindows.clear();
+        for (auto& window : s_windows) {
+            window->stopRenderThread();
+        }
+        if (mode == RenderMode::Pipelined)
+            s_renderThread.reset(new RenderThread("HazyRender"));
+        for (auto& window : s_windows) {
+            if (mode == RenderMode::PerWindow)
+                window->startRenderThread();
+            else
+                window->m_renderThread = s_renderThread.get();
+        }
+        s_renderMode = mode;
+    }
+
+    void Application::PipelineFrame() {
+        for (auto& window : s_windows) {
+            window->updateFrame();
+        }
+
+        // 同步点：渲染线程渲染完上一帧之后，更新和渲染都不在执行，交换这一帧的数据
+        s_renderThread->wait();
+
+        // 渲染线程空闲时分发事件，窗口和层的 onEvent() 不会和层的 update() 同时执行，
+        // 关闭的窗口也在这里销毁，不会再交给渲染线程
+        CheckEvents();
+
+        s_renderingWindows.clear();
+        for (auto& window : s_windows) {
+            window->m_renderThread = s_renderThread.get();
+            window->syncFrame();
+            s_renderingWindows.push_back(window.get());
+        }
+
+        s_renderThread->submit(
+            [] {
+                for (Window* window : s_renderingWindows) {
+                    window->renderFrame();
+                }
+            });
+    }
+
+    void Application::ParallelFrame() {
+        for (auto& window : s_windows) {
+            window->updateFrame();
+        }
+
+        // 事件可能分发给任何一个窗口的层，要等所有窗口的渲染线程都空闲之后再分发，然后逐个窗口同步、提交
+        WaitForRender();
+        CheckEvents();
+
+        for (auto& window : s_windows) {
+            window->startRenderThread();
+            window->syncFrame();
+            window->m_renderThread->submit([target = window.get()] { target->renderFrame(); });
+        }
+    }
+
+    void Application::WaitForRender() {
+        if (s_renderThread)
+            s_renderThread->wait();
+        for (auto& window : s_windows) {
+            if (window->m_ownedRenderThread)
+                window->m_ownedRenderThread->wait();
+        }
+    }
+
+    void Application::startRecording(const std::string& path) {
+        s_recorder.reset();
+        s_recorder.reset(new EventRecorder(path, s_frameIndex));
+    }
+
+    void Application::stopRecording() {
+        s_recorder.reset();
+    }
+
+    void Application::startReplay(const std::string& path) {
+        s_replay.reset(new EventReplay(path, [](std::string_view title) { return Application::getWindow(std::string(title)); }));
+        s_replayStartFrame = s_frameIndex;
+    }
+
+    void Application::stopReplay() {
+        s_replay.reset();
+    }
+
+    TimerWheel::Handle Application::addTimer(std::chrono::nanoseconds delay, TimerWheel::Callback callback, bool repeat) {
+        // 时间轮只在每一帧开始时前进，从现在开始计算延迟，不能从上一次前进的时间开始
+        uint64_t ticks = static_cast<uint64_t>(std::max<int64_t>((delay + s_timerResolution - std::chrono::nanoseconds(1)) / s_timerResolution, 1));
+        uint64_t delayFromWheel = CurrentTimerTick() - s_timers.now() + ticks;
+        if (repeat)
+            return s_timers.scheduleRepeating(ticks, std::move(callback), delayFromWheel);
+        return s_timers.schedule(delayFromWheel, std::move(callback));
+    }
+
+    TimerWheel::Handle Application::addFrameTimer(uint64_t frames, TimerWheel::Callback callback, bool repeat) {
+        uint64_t delay = s_frameIndex - s_frameTimers.now() + std::max<uint64_t>(frames, 1);
+        if (repeat)
+            return s_frameTimers.scheduleRepeating(frames, std::move(callback), delay);
+        return s_frameTimers.schedule(delay, std::move(callback));
+    }
+
+    bool Application::cancelTimer(TimerWheel::Handle handle) {
+        return s_timers.cancel(handle) || s_frameTimers.cancel(handle);
+    }
+
+    void Application::AdvanceTimers() {
+        s_frameTimers.advanceTo(s_frameIndex);
+        s_timers.advanceTo(CurrentTimerTick());
+    }
+
+    uint64_t Application::CurrentTimerTick() {
+        return static_cast<uint64_t>((std::chrono::steady_clock::now() - s_timerEpoch) / s_timerResolution);
+    }
+
     void Application::CheckEvents() {
-        while (true) {
-            auto e = EventQueue::pollEvent();
-            if (!e.has_value()) {
-                break;
+        // 先回放录制的这一帧的事件，它们代替了实际的输入
+        if (s_replay) {
+            s_replay->replayFrame(s_frameIndex - s_replayStartFrame,
+                [](Event& event) {
+                    if (event.getWindow() != nullptr)
+                        DispatchEvent(event);
+                });
+            if (s_replay->isFinished()) {
+                Logger::LogInfo("Event replay finished after {} frames", s_frameIndex - s_replayStartFrame + 1);
+                s_replay.reset();
             }
-            else {
-                Event& event = *e.value();
-                event.getWindow()->onEvent(event);  // 先将此事件转发给产生此事件的窗口，让窗口知道他们有什么事件
-                switch (event.getType()) {
-                case EventType::WindowClose:
-                    Application::OnWindowClose(static_cast<WindowCloseEvent&>(event));
-                    break;
-                case EventType::WindowFocus:
-                    s_currentFocused = static_cast<WindowFocusEvent&>(event).getWindow();
-                    break;
-                case EventType::WindowLostFocus:
-                    if (s_currentFocused != nullptr || s_currentFocused == static_cast<WindowLostFocusEvent&>(event).getWindow())
-                        s_currentFocused = nullptr;
-                    break;
-                default:
-                    break;
-                }
+        }
+
+        // 一次取出一批事件，处理的过程中新产生的事件（比如关闭子窗口）在下一批中处理
+        for (std::span<EventSlot> batch = EventQueue::drain(); !batch.empty(); batch = EventQueue::drain()) {
+            for (EventSlot& slot : batch) {
+                if (s_replay && slot->isInCategory(EventCategory::Input))
+                    continue;
+                DispatchEvent(*slot);
             }
         }
     }
 
+    void Application::DispatchEvent(Event& event) {
+        if (s_recorder)
+            s_recorder->record(event, s_frameIndex);
+
+        Window* window = event.getWindow();
+        event.markDispatched(EventClock::now());
+        window->onEvent(event);     // 先将此事件转发给产生此事件的窗口，让窗口知道他们有什么事件
+        s_eventBus.publish(event);  // 窗口没有处理的事件再交给订阅了它的其他系统
+        // 输入事件记在窗口上，等这个窗口下一次交换缓冲区时统计输入到呈现的延迟
+        if (event.isInCategory(EventCategory::Input) && InputLatency::isEnabled())
+            window->m_pendingInputs.push_back(event.getTimestamps());
+        switch (event.getType()) {
+        case EventType::WindowClose:
+            Application::OnWindowClose(static_cast<WindowCloseEvent&>(event));
+            break;
+        case EventType::WindowFocus:
+            s_currentFocused = static_cast<WindowFocusEvent&>(event).getWindow();
+            break;
+        case EventType::WindowLostFocus:
+            if (s_currentFocused != nullptr || s_currentFocused == static_cast<WindowLostFocusEvent&>(event).getWindow())
+                s_currentFocused = nullptr;
+            break;
+        default:
+            break;
+        }
+    }
+
     bool Application::OnWindowClose(WindowCloseEvent& e) {
 
         auto it = std::find_if(s_windows.begin(), s_windows.end(),
@@ -91,7 +279,9 @@ namespace Hazy {
             // 获取到要关闭的窗口
             UniqueRef<Window>& window = const_cast<UniqueRef<Window>&>(*it);
             if (window->m_props.childWindows.empty()) {
-                // 如果没有子窗口，直接销毁
+                // 如果没有子窗口，直接销毁，渲染线程可能还在渲染这个窗口，先等它渲染完，上下文回到主线程
+                WaitForRender();
+                window->stopRenderThread();
                 if (s_currentFocused == window.get()) {
                     s_currentFocused = nullptr;
                 }
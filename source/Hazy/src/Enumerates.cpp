@@ -126,7 +126,7 @@ namespace Hazy {
         }
     }
 
-    std::string MouseButtonToString(MouseButton button) {
+    std::string_view MouseButtonToString(MouseButton button) {
         switch (button) {
         case MouseButton::Left:        return "Left";
         case MouseButton::Right:       return "Right";
@@ -164,7 +164,7 @@ namespace Hazy {
         }
     }
 
-    std::string ModifierKeyToString(ModifierKey key) {
+    std::string_view ModifierKeyToString(ModifierKey key) {
         switch (key) {
         case ModifierKey::Shift: return "Shift";
         case ModifierKey::Control: return "Control";
@@ -176,7 +176,7 @@ namespace Hazy {
         }
     }
 
-    std::string KeyToString(Key key) {
+    std::string_view KeyToString(Key key) {
         switch (key) {
         case Key::Space:                return "Space";
         case Key::Apostrophe:           return "Apostrophe";
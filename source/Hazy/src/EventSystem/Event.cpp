@@ -1,8 +0,0 @@
-#include "Hazy/EventSystem/Event.h"
-
-namespace Hazy {
-    std::once_flag EventQueue::s_initialzed;
-    UniqueRef<EventQueue> EventQueue::s_eventQueue = nullptr;
-    std::mutex EventQueue::s_queueMutex;
-    std::queue<Ref<Event>> EventQueue::s_toDoList;
-}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "Hazy/EventSystem/EventBus.h"
+#include "Hazy/EventSystem/Event.h"
+
+namespace Hazy {
+    std::atomic<uint64_t> EventListener::s_subscriptionVersion = 0;
+
+    void EventListener::subscribe(EventType type) {
+        m_types |= typeBit(type);
+        s_subscriptionVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void EventListener::subscribe(EventCategory category) {
+        m_categories |= static_cast<uint8_t>(category);
+        s_subscriptionVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void EventListener::unsubscribe(EventType type) {
+        m_types &= ~typeBit(type);
+        s_subscriptionVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void EventListener::subscribeAll() {
+        m_types = s_allTypes;
+        s_subscriptionVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void EventListener::unsubscribeAll() {
+        m_types = 0;
+        m_categories = 0;
+        s_subscriptionVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void EventBus::attach(EventListener* listener, size_t position) {
+        if (position > m_listeners.size())
+            position = m_listeners.size();
+        m_listeners.insert(m_listeners.begin() + position, listener);
+        m_dirty = true;
+    }
+
+    void EventBus::detach(EventListener* listener) {
+        auto it = std::find(m_listeners.begin(), m_listeners.end(), listener);
+        if (it != m_listeners.end()) {
+            m_listeners.erase(it);
+            m_dirty = true;
+        }
+    }
+
+    bool EventBus::publish(Event& event) {
+        if (event.isHandled())
+            return true;
+        // 嵌套分发（监听者在 onEvent 中又分发了事件）时不能重建，外层还在遍历订阅者列表
+        if (m_publishing == 0 && (m_dirty || m_version != EventListener::getSubscriptionVersion()))
+            rebuild();
+
+        const EventType type = event.getType();
+        const size_t index = static_cast<size_t>(type);
+        if (index >= m_subscribers.size())
+            return false;
+
+        const EventCategory categories = event.getCategoryFlags();
+        struct Scope {
+            int& depth;
+            Scope(int& depth) : depth(depth) { depth++; }
+            ~Scope() { depth--; }
+        } scope { m_publishing };
+
+        // 分发过程中监听者可能被卸载或者修改订阅，订阅者列表只在下一次分发时重建，这里遍历的列表不会变化
+        for (EventListener* listener : m_subscribers[index]) {
+            if (listener->isListening() && listener->isSubscribed(type, categories)) {
+                listener->onEvent(event);
+                if (event.isHandled())
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    void EventBus::rebuild() {
+        for (size_t i = 0; i < m_subscribers.size(); i++) {
+            const EventType type = static_cast<EventType>(i);
+            std::vector<EventListener*>& subscribers = m_subscribers[i];
+            subscribers.clear();
+            for (EventListener* listener : m_listeners) {
+                // 事件的类别要到分发时才知道，按照类别订阅的监听者先放进所有列表
+                if (listener->isSubscribed(type, EventCategory::None) || listener->hasCategorySubscription())
+                    subscribers.push_back(listener);
+            }
+        }
+        m_version = EventListener::getSubscriptionVersion();
+        m_dirty = false;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "Hazy/EventSystem/EventQueue.h"
+
+namespace Hazy {
+    std::once_flag EventQueue::s_initialzed;
+    UniqueRef<EventQueue> EventQueue::s_eventQueue = nullptr;
+    MpscRing<EventSlot> EventQueue::s_ring(EventQueue::s_capacity);
+    std::atomic<EventQueue::OverflowPolicy> EventQueue::s_overflowPolicy = EventQueue::OverflowPolicy::DropNewest;
+    std::atomic<size_t> EventQueue::s_droppedCount = 0;
+    std::atomic<uint32_t> EventQueue::s_coalescingMask = 0;
+    std::atomic<size_t> EventQueue::s_coalescedCount = 0;
+    std::atomic<std::thread::id> EventQueue::s_consumerThread;
+    std::vector<EventSlot> EventQueue::s_batch =
+        [] {
+            std::vector<EventSlot> batch;
+            batch.reserve(EventQueue::s_capacity);
+            return batch;
+        }();
+
+    namespace {
+        struct LargeBlock {
+            alignas(std::max_align_t) unsigned char data[EventSlot::s_largeSize];
+        };
+
+        ObjectPool<LargeBlock>& LargeBlockPool() {
+            static ObjectPool<LargeBlock> pool(EventSlot::s_largePoolCapacity);
+            return pool;
+        }
+
+        /**
+         * @brief 较新的事件 later 能不能替换掉紧挨在它前面的较早的事件 earlier，能的话把需要保留的信息（滚动偏移量）累加到 later 上
+         */
+        bool Absorb(Event& later, const Event& earlier) {
+            if (later.getType() != earlier.getType() || later.getWindow() != earlier.getWindow())
+                return false;
+            if (later.getType() == EventType::MouseScrolled)
+                static_cast<MouseScrolledEvent&>(later).accumulate(static_cast<const MouseScrolledEvent&>(earlier));
+            later.markQueued(earlier.getTimestamps().queued);
+            return true;
+        }
+    }
+
+    void* EventSlot::acquireLargeBlock() {
+        LargeBlock* block = LargeBlockPool().acquire();
+        if (block == nullptr)
+            block = new LargeBlock;
+        return block;
+    }
+
+    void EventSlot::releaseLargeBlock(void* block) {
+        LargeBlock* large = static_cast<LargeBlock*>(block);
+        ObjectPool<LargeBlock>& pool = LargeBlockPool();
+        if (pool.owns(large))
+            pool.release(large);
+        else
+            delete large;
+    }
+
+    void EventQueue::setCoalescing(EventType type, bool enabled) {
+        switch (type) {
+        case EventType::MouseMoved:
+        case EventType::MouseScrolled:
+        case EventType::WindowResize:
+        case EventType::WindowMoved:
+            break;
+        default:
+            throw std::invalid_argument("Event type can not be coalesced");
+        }
+        uint32_t bit = 1u << static_cast<uint32_t>(type);
+        if (enabled)
+            s_coalescingMask.fetch_or(bit, std::memory_order_relaxed);
+        else
+            s_coalescingMask.fetch_and(~bit, std::memory_order_relaxed);
+    }
+
+    void EventQueue::coalesce(EventSlot& slot) {
+        size_t coalesced = 0;
+        for (EventSlot* next = s_ring.front(); next != nullptr && Absorb(**next, *slot); next = s_ring.front()) {
+            s_ring.tryPop(slot);
+            coalesced++;
+        }
+        if (coalesced != 0)
+            s_coalescedCount.fetch_add(coalesced, std::memory_order_relaxed);
+    }
+
+    std::span<EventSlot> EventQueue::drain() {
+        init();
+        registerConsumer();
+        s_batch.clear();
+
+        size_t coalesced = 0;
+        s_ring.popBatch(
+            [&coalesced](EventSlot&& slot) {
+                if (!s_batch.empty() && isCoalescing(slot->getType()) && Absorb(*slot, *s_batch.back())) {
+                    s_batch.back() = std::move(slot);
+                    coalesced++;
+                }
+                else {
+                    s_batch.push_back(std::move(slot));
+                }
+            });
+        if (coalesced != 0)
+            s_coalescedCount.fetch_add(coalesced, std::memory_order_relaxed);
+
+        EventClock::time_point now = EventClock::now();
+        for (EventSlot& slot : s_batch) {
+            slot->markDequeued(now);
+        }
+        return s_batch;
+    }
+
+    void EventQueue::onOverflow(EventSlot slot) {
+        std::thread::id consumer = s_consumerThread.load(std::memory_order_relaxed);
+        // 还没有线程取过事件，或者投递事件的就是取事件的线程，等待只会死锁
+        if (s_overflowPolicy.load(std::memory_order_relaxed) == OverflowPolicy::Block
+            && consumer != std::thread::id() && consumer != std::this_thread::get_id()) {
+            while (!s_ring.tryPush(std::move(slot))) {
+                std::this_thread::yield();
+            }
+            return;
+        }
+
+        // 只在丢弃数量为2的幂时打印，避免在事件风暴中刷屏
+        size_t dropped = s_droppedCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        if ((dropped & (dropped - 1)) == 0)
+            Logger::LogWarn("EventQueue is full ({} events), {} event(s) dropped so far", s_capacity, dropped);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include "Hazy/EventSystem/EventRecorder.h"
+#include <cstring>
+
+namespace Hazy {
+
+    namespace {
+        void WriteByte(std::vector<char>& buffer, uint8_t value) {
+            buffer.push_back(static_cast<char>(value));
+        }
+
+        // 无符号变长整数，每个字节存7位，最高位表示后面还有没有字节
+        void WriteVarint(std::vector<char>& buffer, uint64_t value) {
+            while (value >= 0x80) {
+                WriteByte(buffer, static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            WriteByte(buffer, static_cast<uint8_t>(value));
+        }
+
+        // 有符号变长整数，先做 zigzag 编码，绝对值小的负数也只占很少的字节
+        void WriteSignedVarint(std::vector<char>& buffer, int64_t value) {
+            WriteVarint(buffer, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        void WriteFloat(std::vector<char>& buffer, float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (int i = 0; i < 4; i++) {
+                WriteByte(buffer, static_cast<uint8_t>(bits >> (i * 8)));
+            }
+        }
+
+        /**
+         * @brief 从内存中依次读取录制文件的各个字段，数据不够时抛出异常
+         */
+        class Reader {
+        public:
+            explicit Reader(std::span<const char> data) : m_data(data) { }
+
+            inline bool atEnd() const { return m_position >= m_data.size(); }
+
+            uint8_t readByte() {
+                if (atEnd())
+                    throw std::runtime_error("Event recording is truncated");
+                return static_cast<uint8_t>(m_data[m_position++]);
+            }
+
+            uint64_t readVarint() {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    uint8_t byte = readByte();
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0)
+                        return value;
+                }
+                throw std::runtime_error("Event recording contains an invalid integer");
+            }
+
+            int64_t readSignedVarint() {
+                uint64_t value = readVarint();
+                return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+            }
+
+            float readFloat() {
+                uint32_t bits = 0;
+                for (int i = 0; i < 4; i++) {
+                    bits |= static_cast<uint32_t>(readByte()) << (i * 8);
+                }
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+
+            std::string_view readBytes(size_t count) {
+                if (count > m_data.size() - m_position)
+                    throw std::runtime_error("Event recording is truncated");
+                std::string_view bytes(m_data.data() + m_position, count);
+                m_position += count;
+                return bytes;
+            }
+
+        private:
+            std::span<const char> m_data;
+            size_t m_position = 0;
+        };
+    }
+
+    EventRecorder::EventRecorder(const std::string& path, uint64_t startFrame)
+        : m_path(path), m_file(path, std::ios::binary | std::ios::trunc), m_lastFrame(startFrame), m_start(EventClock::now()) {
+        if (!m_file.is_open())
+            throw std::runtime_error("Failed to open event recording: " + path);
+        m_buffer.reserve(s_flushThreshold * 2);
+        m_buffer.insert(m_buffer.end(), EventRecordFormat::s_magic.begin(), EventRecordFormat::s_magic.end());
+        WriteByte(m_buffer, EventRecordFormat::s_version);
+        Logger::LogInfo("Recording events to {}", path);
+    }
+
+    EventRecorder::~EventRecorder() {
+        try {
+            flush();
+        }
+        catch (const std::exception& e) {
+            Logger::LogError("{}", e.what());
+        }
+        Logger::LogInfo("Event recording {} closed: {} events recorded, {} skipped", m_path, m_recordedCount, m_skippedCount);
+    }
+
+    bool EventRecorder::record(const Event& event, uint64_t frame) {
+        switch (event.getType()) {
+        case EventType::WindowClose:
+        case EventType::WindowResize:
+        case EventType::WindowFocus:
+        case EventType::WindowLostFocus:
+        case EventType::WindowMoved:
+        case EventType::KeyPressed:
+        case EventType::KeyReleased:
+        case EventType::MouseButtonPressed:
+        case EventType::MouseButtonReleased:
+        case EventType::MouseMoved:
+        case EventType::MouseScrolled:
+            break;
+        default:
+            m_skippedCount++;
+            return false;
+        }
+
+        // 窗口记录要写在第一个属于它的事件之前
+        uint32_t window = windowId(event.getWindow());
+
+        EventClock::time_point queued = event.getTimestamps().queued;
+        int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            (queued == EventClock::time_point {} ? EventClock::now() : queued) - m_start).count();
+        uint64_t frameDelta = frame >= m_lastFrame ? frame - m_lastFrame : 0;
+
+        WriteByte(m_buffer, static_cast<uint8_t>(event.getType()));
+        WriteVarint(m_buffer, frameDelta);
+        WriteSignedVarint(m_buffer, time - m_lastTime);
+        WriteVarint(m_buffer, window);
+        m_lastFrame += frameDelta;
+        m_lastTime = time;
+
+        switch (event.getType()) {
+        case EventType::WindowResize: {
+            auto& resize = static_cast<const WindowResizeEvent&>(event);
+            WriteVarint(m_buffer, resize.getWidth());
+            WriteVarint(m_buffer, resize.getHeight());
+            break;
+        }
+        case EventType::WindowMoved: {
+            auto& moved = static_cast<const WindowMovedEvent&>(event);
+            WriteSignedVarint(m_buffer, moved.getX());
+            WriteSignedVarint(m_buffer, moved.getY());
+            break;
+        }
+        case EventType::KeyPressed: {
+            auto& pressed = static_cast<const KeyPressedEvent&>(event);
+            WriteByte(m_buffer, static_cast<uint8_t>(pressed.getKey()));
+            WriteByte(m_buffer, static_cast<uint8_t>(pressed.getMod()));
+            WriteSignedVarint(m_buffer, pressed.getRepeatCount());
+            break;
+        }
+        case EventType::KeyReleased: {
+            auto& released = static_cast<const KeyReleasedEvent&>(event);
+            WriteByte(m_buffer, static_cast<uint8_t>(released.getKey()));
+            WriteByte(m_buffer, static_cast<uint8_t>(released.getMod()));
+            break;
+        }
+        case EventType::MouseButtonPressed: {
+            auto& pressed = static_cast<const MouseButtonPressedEvent&>(event);
+            WriteByte(m_buffer, static_cast<uint8_t>(pressed.getMouseButton()));
+            WriteByte(m_buffer, static_cast<uint8_t>(pressed.getMod()));
+            break;
+        }
+        case EventType::MouseButtonReleased: {
+            auto& released = static_cast<const MouseButtonReleasedEvent&>(event);
+            WriteByte(m_buffer, static_cast<uint8_t>(released.getMouseButton()));
+            WriteByte(m_buffer, static_cast<uint8_t>(released.getMod()));
+            break;
+        }
+        case EventType::MouseMoved: {
+            auto& moved = static_cast<const MouseMovedEvent&>(event);
+            WriteFloat(m_buffer, moved.getX());
+            WriteFloat(m_buffer, moved.getY());
+            break;
+        }
+        case EventType::MouseScrolled: {
+            auto& scrolled = static_cast<const MouseScrolledEvent&>(event);
+            WriteFloat(m_buffer, scrolled.getXOffset());
+            WriteFloat(m_buffer, scrolled.getYOffset());
+            break;
+        }
+        default:
+            break;
+        }
+
+        m_recordedCount++;
+        if (m_buffer.size() >= s_flushThreshold)
+            flush();
+        return true;
+    }
+
+    void EventRecorder::flush() {
+        if (m_buffer.empty())
+            return;
+        m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_file.flush();
+        m_buffer.clear();
+        if (!m_file)
+            throw std::runtime_error("Failed to write event recording: " + m_path);
+    }
+
+    uint32_t EventRecorder::windowId(const Window* window) {
+        if (window == nullptr)
+            return 0;
+        auto [it, inserted] = m_windowIds.try_emplace(window, static_cast<uint32_t>(m_windowIds.size() + 1));
+        if (inserted) {
+            const std::string& title = window->getProps().title;
+            WriteByte(m_buffer, static_cast<uint8_t>(EventType::None));
+            WriteVarint(m_buffer, title.size());
+            m_buffer.insert(m_buffer.end(), title.begin(), title.end());
+        }
+        return it->second;
+    }
+
+    EventReplay::EventReplay(const std::string& path, WindowResolver resolver) : m_resolver(std::move(resolver)) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open event recording: " + path);
+        std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        Reader reader(data);
+        std::string_view magic = reader.readBytes(EventRecordFormat::s_magic.size());
+        if (!std::equal(magic.begin(), magic.end(), EventRecordFormat::s_magic.begin()))
+            throw std::runtime_error("Not an event recording: " + path);
+        uint8_t version = reader.readByte();
+        if (version != EventRecordFormat::s_version)
+            throw std::runtime_error("Unsupported event recording version " + std::to_string(version) + ": " + path);
+
+        uint64_t frame = 0;
+        int64_t time = 0;
+        while (!reader.atEnd()) {
+            EventType type = static_cast<EventType>(reader.readByte());
+            if (type == EventType::None) {
+                std::string_view title = reader.readBytes(reader.readVarint());
+                m_windowTitles.emplace_back(title);
+                continue;
+            }
+
+            Record record {};
+            frame += reader.readVarint();
+            time += reader.readSignedVarint();
+            record.frame = frame;
+            record.time = time;
+            record.type = type;
+            record.window = static_cast<uint32_t>(reader.readVarint());
+            if (record.window > m_windowTitles.size())
+                throw std::runtime_error("Event recording refers to an unknown window: " + path);
+
+            switch (type) {
+            case EventType::WindowClose:
+            case EventType::WindowFocus:
+            case EventType::WindowLostFocus:
+                break;
+            case EventType::WindowResize:
+                record.size.width = static_cast<uint32_t>(reader.readVarint());
+                record.size.height = static_cast<uint32_t>(reader.readVarint());
+                break;
+            case EventType::WindowMoved:
+                record.position.x = static_cast<int32_t>(reader.readSignedVarint());
+                record.position.y = static_cast<int32_t>(reader.readSignedVarint());
+                break;
+            case EventType::KeyPressed:
+                record.code = reader.readByte();
+                record.mod = reader.readByte();
+                record.repeatCount = static_cast<int32_t>(reader.readSignedVarint());
+                break;
+            case EventType::KeyReleased:
+            case EventType::MouseButtonPressed:
+            case EventType::MouseButtonReleased:
+                record.code = reader.readByte();
+                record.mod = reader.readByte();
+                break;
+            case EventType::MouseMoved:
+            case EventType::MouseScrolled:
+                record.offset.x = reader.readFloat();
+                record.offset.y = reader.readFloat();
+                break;
+            default:
+                throw std::runtime_error("Event recording contains an unknown event type " + std::to_string(static_cast<int>(type)) + ": " + path);
+            }
+            m_records.push_back(record);
+        }
+        Logger::LogInfo("Loaded event recording {}: {} events in {} frames", path, m_records.size(), getFrameCount());
+    }
+
+    bool EventReplay::construct(const Record& record) {
+        Window* window = nullptr;
+        if (record.window != 0) {
+            if (m_resolver)
+                window = m_resolver(m_windowTitles[record.window - 1]);
+            if (window == nullptr) {
+                m_skippedCount++;
+                return false;
+            }
+        }
+
+        Key key = static_cast<Key>(record.code);
+        MouseButton button = static_cast<MouseButton>(record.code);
+        ModifierKey mod = static_cast<ModifierKey>(record.mod);
+        switch (record.type) {
+        case EventType::WindowClose:         m_slot.emplace<WindowCloseEvent>(window); break;
+        case EventType::WindowResize:        m_slot.emplace<WindowResizeEvent>(record.size.width, record.size.height, window); break;
+        case EventType::WindowFocus:         m_slot.emplace<WindowFocusEvent>(window); break;
+        case EventType::WindowLostFocus:     m_slot.emplace<WindowLostFocusEvent>(window); break;
+        case EventType::WindowMoved:         m_slot.emplace<WindowMovedEvent>(record.position.x, record.position.y, window); break;
+        case EventType::KeyPressed:          m_slot.emplace<KeyPressedEvent>(key, record.repeatCount, mod, window); break;
+        case EventType::KeyReleased:         m_slot.emplace<KeyReleasedEvent>(key, mod, window); break;
+        case EventType::MouseButtonPressed:  m_slot.emplace<MouseButtonPressedEvent>(button, mod, window); break;
+        case EventType::MouseButtonReleased: m_slot.emplace<MouseButtonReleasedEvent>(button, mod, window); break;
+        case EventType::MouseMoved:          m_slot.emplace<MouseMovedEvent>(record.offset.x, record.offset.y, window); break;
+        case EventType::MouseScrolled:       m_slot.emplace<MouseScrolledEvent>(record.offset.x, record.offset.y, window); break;
+        default:
+            return false;
+        }
+
+        EventClock::time_point now = EventClock::now();
+        m_slot->markQueued(now);
+        m_slot->markDequeued(now);
+        m_recordedTime = std::chrono::nanoseconds(record.time);
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "Hazy/EventSystem/InputLatency.h"
+
+namespace Hazy {
+    std::atomic<bool> InputLatency::s_enabled = true;
+    std::mutex InputLatency::s_mutex;
+    std::vector<InputLatency::Sample> InputLatency::s_samples(InputLatency::s_sampleCapacity);
+    size_t InputLatency::s_total = 0;
+    std::vector<std::chrono::nanoseconds> InputLatency::s_sorted =
+        [] {
+            std::vector<std::chrono::nanoseconds> sorted;
+            sorted.reserve(InputLatency::s_sampleCapacity);
+            return sorted;
+        }();
+
+    void InputLatency::recordPresent(std::span<const EventTimestamps> events, EventClock::time_point presented) {
+        if (events.empty())
+            return;
+        std::lock_guard lock(s_mutex);
+        for (const EventTimestamps& event : events) {
+            Sample& sample = s_samples[s_total % s_sampleCapacity];
+            sample.stages[static_cast<size_t>(LatencyStage::QueueWait)] = event.dequeued - event.queued;
+            sample.stages[static_cast<size_t>(LatencyStage::DispatchDelay)] = event.dispatched - event.dequeued;
+            sample.stages[static_cast<size_t>(LatencyStage::Present)] = presented - event.dispatched;
+            sample.stages[static_cast<size_t>(LatencyStage::Total)] = presented - event.queued;
+            s_total++;
+        }
+    }
+
+    LatencyStats InputLatency::getStats(LatencyStage stage) {
+        std::lock_guard lock(s_mutex);
+        sortStage(stage);
+        LatencyStats stats;
+        stats.count = s_sorted.size();
+        if (!s_sorted.empty()) {
+            stats.p50 = pick(50.0);
+            stats.p90 = pick(90.0);
+            stats.p99 = pick(99.0);
+            stats.max = s_sorted.back();
+        }
+        return stats;
+    }
+
+    std::chrono::nanoseconds InputLatency::getPercentile(LatencyStage stage, double percentile) {
+        if (!(percentile >= 0.0 && percentile <= 100.0))
+            throw std::out_of_range("Percentile must be in [0, 100]");
+        std::lock_guard lock(s_mutex);
+        sortStage(stage);
+        return s_sorted.empty() ? std::chrono::nanoseconds { 0 } : pick(percentile);
+    }
+
+    size_t InputLatency::getSampleCount() {
+        std::lock_guard lock(s_mutex);
+        return s_total;
+    }
+
+    void InputLatency::reset() {
+        std::lock_guard lock(s_mutex);
+        s_total = 0;
+    }
+
+    void InputLatency::sortStage(LatencyStage stage) {
+        size_t count = std::min(s_total, s_sampleCapacity);
+        s_sorted.clear();
+        for (size_t i = 0; i < count; i++) {
+            s_sorted.push_back(s_samples[i].stages[static_cast<size_t>(stage)]);
+        }
+        std::sort(s_sorted.begin(), s_sorted.end());
+    }
+
+    std::chrono::nanoseconds InputLatency::pick(double percentile) {
+        // 最近秩：第 ceil(p / 100 * n) 个样本
+        double exact = percentile / 100.0 * static_cast<double>(s_sorted.size());
+        size_t rank = static_cast<size_t>(exact);
+        if (static_cast<double>(rank) < exact)
+            rank++;
+        return s_sorted[rank == 0 ? 0 : rank - 1];
+    }
+}
\ No newline at end of file
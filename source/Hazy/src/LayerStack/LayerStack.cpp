@@ -3,9 +3,7 @@
 
 namespace Hazy {
 
-    LayerStack::LayerStack() {
-        m_layerInsert = m_layers.begin();
-    }
+    LayerStack::LayerStack() = default;
 
     LayerStack::~LayerStack() {
         for (Layer* layer : m_layers) {
@@ -18,7 +16,8 @@ namespace Hazy {
      * @param layer 新的层
      */
     void LayerStack::pushLayer(Layer* layer) {
-        m_layerInsert = m_layers.emplace(m_layerInsert, layer);
+        m_layers.emplace(m_layers.begin() + m_layerInsertIndex, layer);
+        m_eventBus.attach(layer, m_layerInsertIndex);
     }
 
     /**
@@ -27,6 +26,7 @@ namespace Hazy {
      */
     void LayerStack::pushOverlay(Layer* overlay) {
         m_layers.emplace_back(overlay);
+        m_eventBus.attach(overlay);
     }
     
     /**
@@ -37,8 +37,10 @@ namespace Hazy {
     void LayerStack::popLayer(Layer* layer) {
         auto it = std::find(m_layers.begin(), m_layers.end(), layer);
         if (it != m_layers.end()) {
-            m_layerInsert = m_layers.erase(it);
-            m_layerInsert--;
+            m_eventBus.detach(layer);
+            size_t index = it - m_layers.begin();
+            m_layers.erase(it);
+            m_layerInsertIndex = index > 0 ? index - 1 : 0;
         }
     }
     
@@ -49,6 +51,7 @@ namespace Hazy {
     void LayerStack::popOverlay(Layer* overlay) {
         auto it = std::find(m_layers.begin(), m_layers.end(), overlay);
         if (it != m_layers.end()) {
+            m_eventBus.detach(overlay);
             m_layers.erase(it);
         }
     }
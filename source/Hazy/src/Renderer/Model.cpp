@@ -4,11 +4,128 @@
 #include "Hazy/Renderer/Buffer.h"
 #include "Hazy/Renderer/VertexArray.h"
 #include "Hazy/Renderer/Context.h"
+#include "Hazy/Application.h"
 #include <assimp/Importer.hpp>
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <filesystem>
+#include <cstring>
 
 namespace Hazy {
+
+    namespace {
+
+        /**
+         * @brief 持有一个 IOBuffer 的只读文件流，Assimp 从内存中解析模型
+         */
+        class BufferIOStream : public Assimp::IOStream {
+        public:
+            explicit BufferIOStream(IOBuffer buffer) : m_buffer(std::move(buffer)) { }
+
+            virtual size_t Read(void* buffer, size_t size, size_t count) override {
+                if (size == 0)
+                    return 0;
+                size_t available = (m_buffer.size() - m_position) / size;
+                count = std::min(count, available);
+                std::memcpy(buffer, m_buffer.data() + m_position, size * count);
+                m_position += size * count;
+                return count;
+            }
+
+            virtual size_t Write(const void*, size_t, size_t) override { return 0; }
+
+            virtual aiReturn Seek(size_t offset, aiOrigin origin) override {
+                size_t base = 0;
+                switch (origin) {
+                    case aiOrigin_SET: base = 0; break;
+                    case aiOrigin_CUR: base = m_position; break;
+                    case aiOrigin_END: base = m_buffer.size(); break;
+                    default: return aiReturn_FAILURE;
+                }
+                // aiOrigin_END 的偏移量是无符号数，向前偏移依赖回绕
+                size_t position = base + offset;
+                if (position > m_buffer.size())
+                    return aiReturn_FAILURE;
+                m_position = position;
+                return aiReturn_SUCCESS;
+            }
+
+            virtual size_t Tell() const override { return m_position; }
+            virtual size_t FileSize() const override { return m_buffer.size(); }
+            virtual void Flush() override { }
+
+        private:
+            IOBuffer m_buffer;
+            size_t m_position = 0;
+        };
+
+        /**
+         * @brief 让 Assimp 通过 AsyncIO 读取模型文件（包括 .obj 引用的 .mtl 这类附属文件）
+         * @note 只支持读取，以写入模式打开会失败
+         */
+        class AsyncIOSystem : public Assimp::IOSystem {
+        public:
+            virtual bool Exists(const char* file) const override {
+                std::error_code error;
+                return std::filesystem::is_regular_file(file, error);
+            }
+
+            virtual char getOsSeparator() const override {
+                return static_cast<char>(std::filesystem::path::preferred_separator);
+            }
+
+            virtual Assimp::IOStream* Open(const char* file, const char* mode = "rb") override {
+                if (std::strchr(mode, 'w') != nullptr || std::strchr(mode, 'a') != nullptr)
+                    return nullptr;
+                try {
+                    return new BufferIOStream(Application::getThreadPool().wait(Application::getAsyncIO().readFile(file, TaskPriority::Normal)));
+                }
+                catch (const std::runtime_error& e) {
+                    Logger::LogError("Failed to read model file: {}, because: {}", file, e.what());
+                    return nullptr;
+                }
+            }
+
+            virtual void Close(Assimp::IOStream* file) override {
+                delete file;
+            }
+        };
+
+    }
+
+    /**
+     * @brief 模型用到的纹理，在解析网格之前就交给线程池读取和解码，按照路径索引
+     */
+    struct PendingTextures {
+        struct Entry {
+            PooledFuture<ImageData> future;
+            ImageData image;
+        };
+
+        std::unordered_map<std::string, Entry> entries;
+
+        /**
+         * @brief 获取解码好的图片，同一张图片可能被多个材质使用，只有第一次需要等待
+         * @return const ImageData* 图片数据，没有预先加载这个路径时返回nullptr
+         */
+        const ImageData* get(const std::string& path) {
+            auto it = entries.find(path);
+            if (it == entries.end())
+                return nullptr;
+            if (it->second.future.valid())
+                it->second.image = Application::getThreadPool().wait(std::move(it->second.future));
+            return &it->second.image;
+        }
+    };
+
+    /**
+     * @brief 把场景中所有材质用到的纹理交给线程池读取和解码
+     * @param scene assimp场景数据
+     * @return PendingTextures 正在加载的纹理
+     */
+    PendingTextures PrefetchTextures(const aiScene* scene);
     /**
      * @brief 解析模型数据
      * @param context 上下文（此VertexBuffer属于哪一个上下文）
@@ -18,25 +135,29 @@ namespace Hazy {
      */
     VertexArray& ParseArray(Context& context, aiMesh* ai_mesh, const std::string& name);
     
+
     /**
      * @brief 解析模型数据
      * @param context 上下文（此材质属于哪一个上下文）
      * @param ai_mesh assimp模型数据
      * @param ai_scene assimp模型数据
      * @param name texture系列的名字
+     * @param textures 预先加载的纹理
      * @return Material
      */
-    Material ParseMaterial(Context& context, aiMesh* ai_mesh, const aiScene* ai_scene, const std::string& name);
+    Material ParseMaterial(Context& context, aiMesh* ai_mesh, const aiScene* ai_scene, const std::string& name, PendingTextures& textures);
     
+
     /**
      * @brief 加载纹理数据
      * @param context 上下文（此纹理属于哪一个上下文）
      * @param path 纹理文件路径
      * @param type 纹理数据类型
      * @param name 材质的名字
+     * @param textures 预先加载的纹理
      * @return Texture2D& 加载出来的纹理
      */
-    inline Texture2D& LoadTexture2D(Context& context, const std::string& path, TextureType type, const std::string& name);
+    inline Texture2D& LoadTexture2D(Context& context, const std::string& path, TextureType type, const std::string& name, PendingTextures& textures);
 
     /**
      * @brief 解析网格数据
@@ -44,35 +165,55 @@ namespace Hazy {
      * @param ai_mesh assimp网格数据
      * @param ai_scene assimp场景数据
      * @param name 网格的名字
+     * @param textures 预先加载的纹理
      * @return Mesh& 解析出来的网格
      */
-    inline Mesh& ParseMesh(Context& context, aiMesh* ai_mesh, const aiScene* ai_scene, const std::string& name);
+    inline Mesh& ParseMesh(Context& context, aiMesh* ai_mesh, const aiScene* ai_scene, const std::string& name, PendingTextures& textures);
 
 
 
     Model::Model(Context& context, const std::string& name, const std::string& path) {
         Assimp::Importer importer;
+        importer.SetIOHandler(new AsyncIOSystem()); // Importer 接管它的所有权
         const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
             Logger::LogError("Failed to load model: {}, because: {}", path, importer.GetErrorString());
             return;
         }
-        processNode(context, scene->mRootNode, scene, name);
+        PendingTextures textures = PrefetchTextures(scene);
+        processNode(context, scene->mRootNode, scene, name, textures);
     }
 
-    void Model::processNode(Context& context, aiNode* node, const aiScene* scene, const std::string& name) {
+    void Model::processNode(Context& context, aiNode* node, const aiScene* scene, const std::string& name, PendingTextures& textures) {
         for (size_t i = 0; i < node->mNumMeshes; i++) {
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            m_meshes.push_back(ParseMesh(context, mesh, scene, name));
+            m_meshes.push_back(ParseMesh(context, mesh, scene, name, textures));
         }
         for (size_t i = 0; i < node->mNumChildren; i++) {
-            processNode(context, node->mChildren[i], scene, name);
+            processNode(context, node->mChildren[i], scene, name, textures);
         }
     }
 
+    PendingTextures PrefetchTextures(const aiScene* scene) {
+        PendingTextures textures;
+        ThreadPool& pool = Application::getThreadPool();
+        for (uint32_t i = 0; i < scene->mNumMaterials; i++) {
+            aiMaterial* ai_material = scene->mMaterials[i];
+            for (aiTextureType type : { aiTextureType_AMBIENT, aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_NORMALS }) {
+                for (uint32_t j = 0; j < ai_material->GetTextureCount(type); j++) {
+                    aiString path;
+                    ai_material->GetTexture(type, j, &path);
+                    auto [it, inserted] = textures.entries.try_emplace(path.C_Str());
+                    if (inserted)
+                        it->second.future = pool.ExecutePooled([path = it->first] { return ImageData::load(path); });
+                }
+            }
+        }
+        return textures;
+    }
 
-    Mesh& ParseMesh(Context& context, aiMesh* ai_mesh, const aiScene* ai_scene, const std::string& name) {
-        return context.create<Mesh>(name, ParseArray(context, ai_mesh, name), ParseMaterial(context, ai_mesh, ai_scene, name));
+    Mesh& ParseMesh(Context& context, aiMesh* ai_mesh, const aiScene* ai_scene, const std::string& name, PendingTextures& textures) {
+        return context.create<Mesh>(name, ParseArray(context, ai_mesh, name), ParseMaterial(context, ai_mesh, ai_scene, name, textures));
     }
 
     VertexArray& ParseArray(Context& context, aiMesh* ai_mesh, const std::string& name) {
@@ -91,37 +232,40 @@ namespace Hazy {
         float* vertices = new float[vertexLength];
         uint32_t indexLength = ai_mesh->mNumFaces * 3;
         uint32_t* indices = new uint32_t[indexLength];
-        for (auto& element : layout.getElements()) {
-            if (element.name == "a_Position" && ai_mesh->HasPositions()) {
-                uint32_t offset = layout.getOffsetOf("a_Position");
-                for (uint32_t i = 0; i < ai_mesh->mNumVertices; i++) {
-                    vertices[i * layout.getStride() + offset + 0] = ai_mesh->mVertices[i].x;
-                    vertices[i * layout.getStride() + offset + 1] = ai_mesh->mVertices[i].y;
-                    vertices[i * layout.getStride() + offset + 2] = ai_mesh->mVertices[i].z;
+        // 逐顶点、逐面的拷贝互不相关，分块交给线程池并行执行
+        ThreadPool& pool = Application::getThreadPool();
+        const uint32_t stride = layout.getStride();
+        const bool hasPositions = ai_mesh->HasPositions();
+        const bool hasNormals = ai_mesh->HasNormals();
+        const bool hasTexCoords = ai_mesh->HasTextureCoords(0);
+        const uint32_t positionOffset = hasPositions ? layout.getOffsetOf("a_Position") : 0;
+        const uint32_t normalOffset = hasNormals ? layout.getOffsetOf("a_Normal") : 0;
+        const uint32_t texCoordOffset = hasTexCoords ? layout.getOffsetOf("a_TexCoord") : 0;
+
+        pool.parallelFor(0u, ai_mesh->mNumVertices, 4096u,
+            [&](uint32_t i) {
+                if (hasPositions) {
+                    vertices[i * stride + positionOffset + 0] = ai_mesh->mVertices[i].x;
+                    vertices[i * stride + positionOffset + 1] = ai_mesh->mVertices[i].y;
+                    vertices[i * stride + positionOffset + 2] = ai_mesh->mVertices[i].z;
                 }
-            }
-            else if (element.name == "a_Normal" && ai_mesh->HasNormals()) {
-                uint32_t offset = layout.getOffsetOf("a_Normal");
-                for (uint32_t i = 0; i < ai_mesh->mNumVertices; i++) {
-                    vertices[i * layout.getStride() + offset + 0] = ai_mesh->mNormals[i].x;
-                    vertices[i * layout.getStride() + offset + 1] = ai_mesh->mNormals[i].y;
-                    vertices[i * layout.getStride() + offset + 2] = ai_mesh->mNormals[i].z;
+                if (hasNormals) {
+                    vertices[i * stride + normalOffset + 0] = ai_mesh->mNormals[i].x;
+                    vertices[i * stride + normalOffset + 1] = ai_mesh->mNormals[i].y;
+                    vertices[i * stride + normalOffset + 2] = ai_mesh->mNormals[i].z;
                 }
-            }
-            else if (element.name == "a_TexCoord") {
-                uint32_t offset = layout.getOffsetOf("a_TexCoord");
-                for (uint32_t i = 0; i < ai_mesh->mNumVertices; i++) {
-                    vertices[i * layout.getStride() + offset + 0] = ai_mesh->mTextureCoords[0][i].x;
-                    vertices[i * layout.getStride() + offset + 1] = ai_mesh->mTextureCoords[0][i].y;
+                if (hasTexCoords) {
+                    vertices[i * stride + texCoordOffset + 0] = ai_mesh->mTextureCoords[0][i].x;
+                    vertices[i * stride + texCoordOffset + 1] = ai_mesh->mTextureCoords[0][i].y;
                 }
-            }
-        }
+            });
 
-        for (uint32_t i = 0; i < ai_mesh->mNumFaces; i++) {
-            indices[i * 3 + 0] = ai_mesh->mFaces[i].mIndices[0];
-            indices[i * 3 + 1] = ai_mesh->mFaces[i].mIndices[1];
-            indices[i * 3 + 2] = ai_mesh->mFaces[i].mIndices[2];
-        }
+        pool.parallelFor(0u, ai_mesh->mNumFaces, 4096u,
+            [&](uint32_t i) {
+                indices[i * 3 + 0] = ai_mesh->mFaces[i].mIndices[0];
+                indices[i * 3 + 1] = ai_mesh->mFaces[i].mIndices[1];
+                indices[i * 3 + 2] = ai_mesh->mFaces[i].mIndices[2];
+            });
 
         context.create<VertexArray>(name)
             .addVertexBuffer(context.create<VertexBuffer>(name, vertices, vertexLength, layout, BufferUsage::StaticDraw))
@@ -133,18 +277,20 @@ namespace Hazy {
     }
 
 
-    Texture2D& LoadTexture2D(Context& context, const std::string& path, TextureType type, const std::string& name) {
+    Texture2D& LoadTexture2D(Context& context, const std::string& path, TextureType type, const std::string& name, PendingTextures& textures) {
         try {
             return context.get<Texture2D>(name);
         }
         catch (const std::out_of_range&) {
-            return context.create<Texture2D>(name, path, type)
+            const ImageData* image = textures.get(path);
+            Texture2D& texture = image != nullptr ? context.create<Texture2D>(name, *image, type) : context.create<Texture2D>(name, path, type);
+            return texture
                 .setFilter(TextureFilter::LinearMipmapLinear)
                 .generateMipMap();
         }
     }
 
-    Material ParseMaterial(Context& context, aiMesh* ai_mesh, const aiScene* ai_scene, const std::string& name) {
+    Material ParseMaterial(Context& context, aiMesh* ai_mesh, const aiScene* ai_scene, const std::string& name, PendingTextures& textures) {
         aiMaterial* ai_material = ai_scene->mMaterials[ai_mesh->mMaterialIndex];
         size_t ambCount = ai_material->GetTextureCount(aiTextureType_AMBIENT);
         size_t difCount = ai_material->GetTextureCount(aiTextureType_DIFFUSE);
@@ -177,28 +323,28 @@ namespace Hazy {
             aiString path;
             std::string textureName = generateTextureName(name, aiTextureType_AMBIENT, i);
             ai_material->GetTexture(aiTextureType_AMBIENT, i, &path);
-            result.ambientMaps.push_back(&LoadTexture2D(context, path.C_Str(), TextureType::Ambient, textureName));
+            result.ambientMaps.push_back(&LoadTexture2D(context, path.C_Str(), TextureType::Ambient, textureName, textures));
         }
 
         for (size_t i = 0; i < difCount; i++) {
             aiString path;
             std::string textureName = generateTextureName(name, aiTextureType_DIFFUSE, i);
             ai_material->GetTexture(aiTextureType_DIFFUSE, i, &path);
-            result.diffuseMaps.push_back(&LoadTexture2D(context, path.C_Str(), TextureType::Diffuse, textureName));
+            result.diffuseMaps.push_back(&LoadTexture2D(context, path.C_Str(), TextureType::Diffuse, textureName, textures));
         }
 
         for (size_t i = 0; i < speCount; i++) {
             aiString path;
             std::string textureName = generateTextureName(name, aiTextureType_SPECULAR, i);
             ai_material->GetTexture(aiTextureType_SPECULAR, i, &path);
-            result.specularMaps.push_back(&LoadTexture2D(context, path.C_Str(), TextureType::Specular, textureName));
+            result.specularMaps.push_back(&LoadTexture2D(context, path.C_Str(), TextureType::Specular, textureName, textures));
         }
 
         for (size_t i = 0; i < norCount; i++) {
             aiString path;
             std::string textureName = generateTextureName(name, aiTextureType_NORMALS, i);
             ai_material->GetTexture(aiTextureType_NORMALS, i, &path);
-            result.normalMaps.push_back(&LoadTexture2D(context, path.C_Str(), TextureType::Normal, textureName));
+            result.normalMaps.push_back(&LoadTexture2D(context, path.C_Str(), TextureType::Normal, textureName, textures));
         }
 
         return result;
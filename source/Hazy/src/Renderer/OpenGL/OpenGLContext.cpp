@@ -24,6 +24,11 @@ void OpenGLInfoCallback(
 
 namespace Hazy {
 
+    namespace {
+        // 当前线程绑定的上下文，每一次 bind() 压入一个，栈顶是当前线程正在使用的上下文，嵌套的层数就是它在栈中出现的次数
+        thread_local std::vector<OpenGLContext*> t_bindStack;
+    }
+
     std::once_flag OpenGLContext::s_GLADInitialized;
     std::once_flag OpenGLContext::s_GLFWInitialized;
 
@@ -65,7 +70,15 @@ namespace Hazy {
     }
 
     void OpenGLContext::SwapBuffers() {
+        Present();
+        PollEvents();
+    }
+
+    void OpenGLContext::Present() {
         glfwSwapBuffers(m_nativeWindow);
+    }
+
+    void OpenGLContext::PollEvents() {
         glfwPollEvents();
     }
 
@@ -83,11 +96,36 @@ namespace Hazy {
     }
 
     void OpenGLContext::bind() {
+        // 在当前线程已经绑定的上下文中再次绑定（比如渲染线程函数中的 ContextLock）时不切换，
+        // 否则内层的解除绑定会让外层剩下的渲染失去上下文
+        if (!t_bindStack.empty() && t_bindStack.back() == this) {
+            t_bindStack.push_back(this);
+            return;
+        }
+
+        // 一个上下文同一时间只能是一个线程的当前上下文，其他线程（比如渲染线程）持有它时不能绑定，
+        // 否则当前线程只会在没有上下文的情况下执行 OpenGL 调用
+        std::thread::id owner;
+        const std::thread::id self = std::this_thread::get_id();
+        if (!m_owner.compare_exchange_strong(owner, self, std::memory_order_acquire) && owner != self)
+            throw std::logic_error("OpenGL context is bound to another thread, use Window::postToRenderThread() instead");
+
         glfwMakeContextCurrent(m_nativeWindow);
+        t_bindStack.push_back(this);
     }
 
     void OpenGLContext::unbind() {
-        glfwMakeContextCurrent(nullptr);
+        assert(!t_bindStack.empty() && t_bindStack.back() == this && "unbind() without a matching bind() on this thread");
+        if (t_bindStack.empty() || t_bindStack.back() != this)
+            return;
+        t_bindStack.pop_back();
+        if (!t_bindStack.empty() && t_bindStack.back() == this)
+            return;
+
+        // 切换回外层绑定的上下文，先让出当前线程的上下文，再让其他线程可以绑定它
+        glfwMakeContextCurrent(t_bindStack.empty() ? nullptr : t_bindStack.back()->m_nativeWindow);
+        if (std::find(t_bindStack.begin(), t_bindStack.end(), this) == t_bindStack.end())
+            m_owner.store(std::thread::id(), std::memory_order_release);
     }
 
     KeyAction OpenGLContext::getKeyState(Key key) {
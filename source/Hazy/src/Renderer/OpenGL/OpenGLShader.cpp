@@ -7,17 +7,45 @@
 #define CALL(x) x; assert(glGetError() == GL_NO_ERROR)
 
 namespace Hazy {
+
+    namespace {
+
+        /**
+         * @brief 等待着色器源码读取完毕，等待的时候帮忙执行线程池中的任务
+         * @throws std::runtime_error 文件打不开或者读取失败，错误信息中包含 AsyncIO 给出的原因
+         */
+        IOBuffer WaitSource(PooledFuture<IOBuffer>& source, const std::string& path) {
+            try {
+                return Application::getThreadPool().wait(std::move(source));
+            }
+            catch (const std::runtime_error& e) {
+                throw std::runtime_error("Failed to read shader file: " + path + ", because: " + e.what());
+            }
+        }
+
+    }
+
     OpenGLShader::OpenGLShader(const std::string& vertPath, const std::string& fragPath, const std::string& geomPath) {
-        uint32_t vertexShader = compileShader(vertPath, GL_VERTEX_SHADER);
-        uint32_t fragmentShader = compileShader(fragPath, GL_FRAGMENT_SHADER);
-        uint32_t geometryShader = compileShader(geomPath, GL_GEOMETRY_SHADER);
+        // 所有文件同时开始读取，读取的时候不需要上下文
+        AsyncIO& io = Application::getAsyncIO();
+        PooledFuture<IOBuffer> vertSource = io.readFile(vertPath, TaskPriority::Normal);
+        PooledFuture<IOBuffer> fragSource = io.readFile(fragPath, TaskPriority::Normal);
+        PooledFuture<IOBuffer> geomSource = io.readFile(geomPath, TaskPriority::Normal);
+
+        uint32_t vertexShader = compileShader(WaitSource(vertSource, vertPath).view(), GL_VERTEX_SHADER);
+        uint32_t fragmentShader = compileShader(WaitSource(fragSource, fragPath).view(), GL_FRAGMENT_SHADER);
+        uint32_t geometryShader = compileShader(WaitSource(geomSource, geomPath).view(), GL_GEOMETRY_SHADER);
 
         linkProgram(vertexShader, fragmentShader, geometryShader);
     }
 
     OpenGLShader::OpenGLShader(const std::string& vertPath, const std::string& fragPath) {
-        uint32_t vertexShader = compileShader(vertPath, GL_VERTEX_SHADER);
-        uint32_t fragmentShader = compileShader(fragPath, GL_FRAGMENT_SHADER);
+        AsyncIO& io = Application::getAsyncIO();
+        PooledFuture<IOBuffer> vertSource = io.readFile(vertPath, TaskPriority::Normal);
+        PooledFuture<IOBuffer> fragSource = io.readFile(fragPath, TaskPriority::Normal);
+
+        uint32_t vertexShader = compileShader(WaitSource(vertSource, vertPath).view(), GL_VERTEX_SHADER);
+        uint32_t fragmentShader = compileShader(WaitSource(fragSource, fragPath).view(), GL_FRAGMENT_SHADER);
 
         linkProgram(vertexShader, fragmentShader);
     }
@@ -111,21 +139,12 @@ namespace Hazy {
         return *this;
     }
 
-    uint32_t OpenGLShader::compileShader(const std::string& path, uint32_t type) {
-        std::ifstream file(path);
-        std::stringstream stream;
-        if (!file.is_open()) {
-            file.close();
-            throw std::runtime_error("Failed to open shader file: " + path);
-        }
-        stream << file.rdbuf();
-        file.close();
-        std::string source = stream.str();
-
+    uint32_t OpenGLShader::compileShader(std::string_view source, uint32_t type) {
         int success;
         uint32_t shader = glCreateShader(type);
-        const GLchar* src = (const GLchar*)source.c_str();
-        CALL(glShaderSource(shader, 1, &src, 0));
+        const GLchar* src = (const GLchar*)source.data();
+        const GLint length = static_cast<GLint>(source.size());
+        CALL(glShaderSource(shader, 1, &src, &length));
         CALL(glCompileShader(shader));
         CALL(glGetShaderiv(shader, GL_COMPILE_STATUS, &success));
         if (!success) {
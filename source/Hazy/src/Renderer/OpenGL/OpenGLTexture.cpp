@@ -5,21 +5,61 @@
 #include "Hazy/Util/Log.h"
 #include <stb_image.h>
 #include "Hazy/Renderer/Texture.h"
+#include "Hazy/Application.h"
 
 #include "assert.h"
 #define CALL(x) x; assert(glGetError() == GL_NO_ERROR)
 
 namespace Hazy {
 
+    void ImageData::PixelDeleter::operator()(uint8_t* pixels) const {
+        stbi_image_free(pixels);
+    }
+
+    ImageData ImageData::decode(std::span<const char> encoded) {
+        ImageData image;
+        // 不使用 stbi_set_flip_vertically_on_load，它是全局状态，多个线程同时解码的时候不安全
+        stbi_uc* data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(encoded.data()), static_cast<int>(encoded.size()),
+            &image.width, &image.height, &image.channels, 0);
+        if (data == nullptr)
+            return image;
+        image.pixels.reset(data);
+
+        size_t rowSize = static_cast<size_t>(image.width) * image.channels;
+        for (int top = 0, bottom = image.height - 1; top < bottom; top++, bottom--) {
+            std::swap_ranges(data + top * rowSize, data + (top + 1) * rowSize, data + bottom * rowSize);
+        }
+        return image;
+    }
+
+    ImageData ImageData::load(const std::string& path) {
+        try {
+            // 调用者（加载纹理、预取模型纹理的任务）会阻塞等待读取结果，读取不能排在后台车道
+            IOBuffer encoded = Application::getThreadPool().wait(Application::getAsyncIO().readFile(path, TaskPriority::Normal));
+            ImageData image = decode(encoded.span());
+            if (!image.valid())
+                Logger::LogError("Failed to decode image: {}, because: {}", path, stbi_failure_reason());
+            return image;
+        }
+        catch (const std::runtime_error& e) {
+            Logger::LogError("Failed to read image: {}, because: {}", path, e.what());
+            return ImageData();
+        }
+    }
+
     template<>
     OpenGLTexture<2>::OpenGLTexture(const std::string& path, TextureType type)
-        : m_lastSlot(0), m_type(type) {
-        stbi_set_flip_vertically_on_load(1);
-        stbi_uc* data = stbi_load(path.c_str(), &m_scale.x, &m_scale.y, &m_scale.z, 0);
-        if (data == nullptr) {
-            Logger::LogError("Failed to load texture: {0}", path);
+        : OpenGLTexture(ImageData::load(path), type) {
+    }
+
+    template<>
+    OpenGLTexture<2>::OpenGLTexture(const ImageData& image, TextureType type)
+        : m_textureID(0), m_lastSlot(0), m_type(type), m_scale(image.width, image.height, image.channels) {
+        if (!image.valid()) {
+            Logger::LogError("Failed to load texture: invalid image data");
             return;
         }
+        const stbi_uc* data = image.pixels.get();
 
         int openglFormat = 0, pictureFormat = 0;
         if (m_scale.z == 4) {
@@ -34,8 +74,6 @@ namespace Hazy {
         CALL(glTextureStorage2D(m_textureID, 1, openglFormat, m_scale.x, m_scale.y));
 
         CALL(glTextureSubImage2D(m_textureID, 0, 0, 0, m_scale.x, m_scale.y, pictureFormat, GL_UNSIGNED_BYTE, data));
-        
-        stbi_image_free(data);
     }
 
     template<>
@@ -80,6 +118,10 @@ namespace Hazy {
     OpenGLTexture<3>::OpenGLTexture(const std::string& , TextureType ) {
     }
 
+    template<>
+    OpenGLTexture<3>::OpenGLTexture(const ImageData& , TextureType ) {
+    }
+
     template<>
     OpenGLTexture<3>::~OpenGLTexture() {
     }
@@ -0,0 +1,95 @@
+#include "Hazy/Renderer/RenderThread.h"
+#include "Hazy/Util/Log.h"
+
+#if defined(__linux__)
+    #include <pthread.h>
+#endif
+
+namespace Hazy {
+
+    RenderThread::RenderThread(const std::string& name)
+        : m_thread(&RenderThread::run, this, name) {
+    }
+
+    RenderThread::~RenderThread() {
+        try {
+            wait();
+        }
+        catch (const std::exception& e) {
+            Logger::LogError("Render thread stopped with an unhandled exception: {}", e.what());
+        }
+        catch (...) {
+            Logger::LogError("Render thread stopped with an unhandled exception");
+        }
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_frameReady.notify_one();
+        m_thread.join();
+    }
+
+    void RenderThread::submit(std::function<void()> frame) {
+        wait();
+        {
+            std::lock_guard lock(m_mutex);
+            m_frame = std::move(frame);
+            m_busy = true;
+        }
+        m_frameReady.notify_one();
+    }
+
+    void RenderThread::wait() {
+        std::unique_lock lock(m_mutex);
+        if (m_busy) {
+            auto start = std::chrono::steady_clock::now();
+            m_frameDone.wait(lock, [this] { return !m_busy; });
+            m_lastWaitTime = std::chrono::steady_clock::now() - start;
+        }
+        else {
+            m_lastWaitTime = std::chrono::nanoseconds(0);
+        }
+        if (m_exception)
+            std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+
+    bool RenderThread::isBusy() const {
+        std::lock_guard lock(m_mutex);
+        return m_busy;
+    }
+
+    void RenderThread::run(std::string name) {
+#if defined(__linux__)
+        // Linux 的线程名字最多15个字符
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#endif
+        Logger::LogTrace("Render thread {} started", name);
+        std::unique_lock lock(m_mutex);
+        while (true) {
+            m_frameReady.wait(lock, [this] { return m_frame || m_stopping; });
+            if (!m_frame)
+                break;
+            std::function<void()> frame = std::move(m_frame);
+            m_frame = nullptr;
+            lock.unlock();
+
+            std::exception_ptr exception;
+            try {
+                frame();
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+            // 在解锁的状态下销毁这一帧捕获的对象，它们的析构函数可能很慢
+            frame = nullptr;
+
+            lock.lock();
+            m_exception = exception;
+            m_busy = false;
+            m_frameCount.fetch_add(1, std::memory_order_relaxed);
+            m_frameDone.notify_all();
+        }
+        Logger::LogTrace("Render thread {} stopped", name);
+    }
+
+}
\ No newline at end of file
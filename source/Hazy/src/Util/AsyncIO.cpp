@@ -0,0 +1,547 @@
+#include "Hazy/Util/AsyncIO.hpp"
+#include <deque>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #define HAZY_IO_URING 1
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <cstring>
+#else
+    #define HAZY_IO_URING 0
+#endif
+
+namespace Hazy {
+
+    namespace {
+
+        /**
+         * @brief 在当前线程同步读取，线程池读取和 io_uring 不可用时使用
+         * @return size_t 实际读取的字节数
+         * @throws std::runtime_error 文件打不开，或者读取失败
+         */
+        size_t ReadAt(const std::string& path, char* buffer, size_t size, uint64_t offset) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open())
+                throw std::runtime_error("Failed to open file: " + path);
+            file.seekg(static_cast<std::streamoff>(offset));
+            file.read(buffer, static_cast<std::streamsize>(size));
+            if (file.bad())
+                throw std::runtime_error("Failed to read file: " + path);
+            return static_cast<size_t>(file.gcount());
+        }
+
+        /**
+         * @brief 获取文件的大小
+         * @throws std::runtime_error 文件打不开
+         */
+        size_t FileSize(const std::string& path) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+                throw std::runtime_error("Failed to open file: " + path);
+            return static_cast<size_t>(file.tellg());
+        }
+
+    }
+
+    //////////////////////////////////////////////////////////
+
+    IOBuffer::IOBuffer(UniqueRef<char[]> storage, size_t capacity, size_t size, Ref<IOBufferPool> pool)
+        : m_storage(std::move(storage)), m_capacity(capacity), m_size(size), m_pool(std::move(pool)) { }
+
+    IOBuffer::IOBuffer(IOBuffer&& other) noexcept
+        : m_storage(std::move(other.m_storage)), m_capacity(std::exchange(other.m_capacity, 0)),
+          m_size(std::exchange(other.m_size, 0)), m_pool(std::move(other.m_pool)) { }
+
+    IOBuffer& IOBuffer::operator=(IOBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_storage = std::move(other.m_storage);
+            m_capacity = std::exchange(other.m_capacity, 0);
+            m_size = std::exchange(other.m_size, 0);
+            m_pool = std::move(other.m_pool);
+        }
+        return *this;
+    }
+
+    IOBuffer::~IOBuffer() {
+        reset();
+    }
+
+    void IOBuffer::resize(size_t size) {
+        if (size > m_capacity)
+            throw std::length_error("IOBuffer size exceeds its capacity");
+        m_size = size;
+    }
+
+    void IOBuffer::reset() {
+        if (m_storage && m_pool)
+            m_pool->release(std::move(m_storage), m_capacity);
+        m_storage.reset();
+        m_pool.reset();
+        m_capacity = 0;
+        m_size = 0;
+    }
+
+    IOBuffer IOBufferPool::acquire(size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto best = m_free.end();
+            for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+                if (it->capacity >= size && (best == m_free.end() || it->capacity < best->capacity))
+                    best = it;
+            }
+            if (best != m_free.end()) {
+                Block block = std::move(*best);
+                *best = std::move(m_free.back());
+                m_free.pop_back();
+                return IOBuffer(std::move(block.storage), block.capacity, size, shared_from_this());
+            }
+        }
+        // 容量向上取整到 64KB，让相近大小的文件可以复用同一个缓冲区
+        constexpr size_t granularity = 64 * 1024;
+        size_t capacity = std::max<size_t>(granularity, (size + granularity - 1) / granularity * granularity);
+        return IOBuffer(UniqueRef<char[]>(new char[capacity]), capacity, size, shared_from_this());
+    }
+
+    size_t IOBufferPool::getCachedCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_free.size();
+    }
+
+    void IOBufferPool::release(UniqueRef<char[]> storage, size_t capacity) {
+        if (capacity > m_maxBufferSize)
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.size() < m_maxCached)
+            m_free.push_back(Block { std::move(storage), capacity });
+    }
+
+    //////////////////////////////////////////////////////////
+
+    /**
+     * @brief 一次文件读取，被切成若干块，所有块都完成之后设置结果
+     */
+    struct AsyncIO::Request {
+        struct Chunk {
+            Request* request;
+            char* destination;
+            uint64_t offset;
+            uint32_t length;
+        };
+
+        explicit Request(FutureState* state) : promise(state) { }
+
+        int fd = -1;
+        std::string path;
+        char* destination = nullptr;
+        uint64_t offset = 0;
+        size_t length = 0;                      // 要读取的字节数，已经根据文件大小截断
+        std::vector<Chunk> chunks;
+        std::atomic<size_t> remaining = 0;      // 还没有完成的块的数量
+        std::atomic<size_t> bytesRead = 0;
+        std::atomic<int> error = 0;             // 第一个失败的块的错误码
+
+        FuturePromise promise;
+        std::optional<IOBuffer> buffer;         // readFile 的结果，read 读到调用者的缓冲区里，没有这个
+    };
+
+#if HAZY_IO_URING
+
+    namespace {
+
+        inline int IoUringSetup(unsigned entries, io_uring_params* params) {
+            return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        inline int IoUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+        }
+
+        template <typename T>
+        inline T LoadAcquire(T* pointer) { return std::atomic_ref<T>(*pointer).load(std::memory_order_acquire); }
+
+        template <typename T>
+        inline void StoreRelease(T* pointer, T value) { std::atomic_ref<T>(*pointer).store(value, std::memory_order_release); }
+
+    }
+
+    /**
+     * @brief io_uring 的状态，提交队列由 mutex 保护，完成队列只有完成线程访问
+     * @note 同时在内核中的请求数量不超过 depth，所以提交队列不会满，完成队列（容量是提交队列的两倍）也不会溢出，
+     * 超出的块先放在 backlog 里，完成线程每收割一批完成事件就补充提交
+     */
+    struct AsyncIO::Ring {
+        using Chunk = Request::Chunk;
+
+        ~Ring() {
+            if (thread.joinable()) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    stopping = true;
+                    // 提交一个空操作叫醒完成线程，user_data 为0
+                    if (hasSpaceLocked())
+                        pushLocked(nullptr);
+                    flushLocked(lock);
+                }
+                thread.join();
+            }
+            if (sqes != nullptr)
+                munmap(sqes, sqesSize);
+            if (cqPointer != nullptr && cqPointer != sqPointer)
+                munmap(cqPointer, cqSize);
+            if (sqPointer != nullptr)
+                munmap(sqPointer, sqSize);
+            if (fd >= 0)
+                close(fd);
+        }
+
+        /**
+         * @brief 创建 io_uring 并映射提交队列和完成队列
+         * @return int 成功返回0，失败返回错误码
+         */
+        int init(uint32_t queueDepth) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            fd = IoUringSetup(queueDepth, &params);
+            if (fd < 0)
+                return errno;
+            // IORING_OP_READ 从 5.6 开始支持，用同一版本引入的特性来判断
+            if (!(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_RW_CUR_POS))
+                return ENOSYS;
+
+            sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (singleMap)
+                sqSize = cqSize = std::max(sqSize, cqSize);
+
+            sqPointer = mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sqPointer == MAP_FAILED) {
+                sqPointer = nullptr;
+                return errno;
+            }
+            if (singleMap) {
+                cqPointer = sqPointer;
+            }
+            else {
+                cqPointer = mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cqPointer == MAP_FAILED) {
+                    cqPointer = nullptr;
+                    return errno;
+                }
+            }
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void* sqesPointer = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (sqesPointer == MAP_FAILED)
+                return errno;
+            sqes = static_cast<io_uring_sqe*>(sqesPointer);
+
+            char* sq = static_cast<char*>(sqPointer);
+            sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            sqEntries = params.sq_entries;
+
+            char* cq = static_cast<char*>(cqPointer);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            depth = std::min<uint32_t>(queueDepth, sqEntries);
+            return 0;
+        }
+
+        inline bool hasSpaceLocked() const { return *sqTail - LoadAcquire(sqHead) < sqEntries; }
+
+        /**
+         * @brief 把一个块写进提交队列，chunk 为nullptr时提交空操作，调用之前需要持有 mutex
+         */
+        void pushLocked(Chunk* chunk) {
+            unsigned tail = *sqTail;
+            unsigned index = tail & sqMask;
+            io_uring_sqe& sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            if (chunk != nullptr) {
+                sqe.opcode = IORING_OP_READ;
+                sqe.fd = chunk->request->fd;
+                sqe.addr = reinterpret_cast<uint64_t>(chunk->destination);
+                sqe.len = chunk->length;
+                sqe.off = chunk->offset;
+            }
+            else {
+                sqe.opcode = IORING_OP_NOP;
+            }
+            sqe.user_data = reinterpret_cast<uint64_t>(chunk);
+            sqArray[index] = index;
+            StoreRelease(sqTail, tail + 1);
+            inFlight++;
+        }
+
+        /**
+         * @brief 把 backlog 中的块补充到提交队列，然后一次系统调用全部提交，调用之前需要持有 mutex
+         * @note 内核暂时忙（EAGAIN/EBUSY）的时候，没有提交的块留在提交队列里：
+         * 内核里还有别的请求的话，完成线程收割之后会重新提交；内核里已经没有请求了的话，完成线程会一直阻塞在等待完成事件上，
+         * 没有人会重新提交，所以由调用者退避重试，等待期间释放锁
+         */
+        void flushLocked(std::unique_lock<std::mutex>& lock) {
+            auto backoff = std::chrono::microseconds(50);
+            while (true) {
+                while (!backlog.empty() && inFlight < depth && hasSpaceLocked()) {
+                    pushLocked(backlog.front());
+                    backlog.pop_front();
+                }
+                unsigned pending = *sqTail - LoadAcquire(sqHead);
+                if (pending == 0)
+                    return;
+                int result;
+                while ((result = IoUringEnter(fd, pending, 0, 0)) < 0 && errno == EINTR) { }
+                if (result < 0 && errno != EAGAIN && errno != EBUSY) {
+                    Logger::LogError("io_uring_enter failed: {}", std::strerror(errno));
+                    return;
+                }
+
+                // inFlight 包括还留在提交队列里的块，减去它们才是内核里的请求数量
+                unsigned unsubmitted = *sqTail - LoadAcquire(sqHead);
+                if (unsubmitted == 0 || inFlight > unsubmitted)
+                    return;
+                lock.unlock();
+                std::this_thread::sleep_for(backoff);
+                backoff = std::min(backoff * 2, std::chrono::microseconds(2000));
+                lock.lock();
+            }
+        }
+
+        void submit(std::vector<Chunk>& chunks) {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (Chunk& chunk : chunks) {
+                backlog.push_back(&chunk);
+            }
+            flushLocked(lock);
+        }
+
+        /**
+         * @brief 完成线程的主循环，收割完成事件，处理短读，请求的所有块都完成之后设置结果
+         */
+        void complete() {
+            std::vector<Chunk*> retry;
+            while (true) {
+                if (IoUringEnter(fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    Logger::LogError("io_uring_enter failed while waiting for completions: {}", std::strerror(errno));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                unsigned head = *cqHead;
+                unsigned tail = LoadAcquire(cqTail);
+                uint32_t reaped = 0;
+                for (; head != tail; head++, reaped++) {
+                    const io_uring_cqe& cqe = cqes[head & cqMask];
+                    Chunk* chunk = reinterpret_cast<Chunk*>(cqe.user_data);
+                    if (chunk == nullptr)
+                        continue;
+                    if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+                        retry.push_back(chunk);
+                    }
+                    else if (cqe.res < 0) {
+                        int expected = 0;
+                        chunk->request->error.compare_exchange_strong(expected, -cqe.res);
+                        finishChunk(chunk);
+                    }
+                    else {
+                        uint32_t count = static_cast<uint32_t>(cqe.res);
+                        chunk->request->bytesRead.fetch_add(count, std::memory_order_relaxed);
+                        // 短读：剩下的部分重新提交；读到0个字节说明已经到达文件末尾（文件在读取的过程中变短了）
+                        if (count > 0 && count < chunk->length) {
+                            chunk->destination += count;
+                            chunk->offset += count;
+                            chunk->length -= count;
+                            retry.push_back(chunk);
+                        }
+                        else {
+                            finishChunk(chunk);
+                        }
+                    }
+                }
+                StoreRelease(cqHead, head);
+
+                std::unique_lock<std::mutex> lock(mutex);
+                inFlight -= reaped;
+                for (Chunk* chunk : retry) {
+                    backlog.push_front(chunk);
+                }
+                retry.clear();
+                flushLocked(lock);
+                if (stopping && inFlight == 0 && backlog.empty())
+                    return;
+            }
+        }
+
+        static void finishChunk(Chunk* chunk) {
+            Request* request = chunk->request;
+            if (request->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+
+            close(request->fd);
+            int error = request->error.load();
+            if (error != 0) {
+                request->promise.setException(std::make_exception_ptr(
+                    std::runtime_error("Failed to read file: " + request->path + ", because: " + std::strerror(error))));
+            }
+            else if (request->buffer) {
+                request->buffer->resize(request->bytesRead.load());
+                request->promise.setValue(std::move(*request->buffer));
+            }
+            else {
+                request->promise.setValue(request->bytesRead.load());
+            }
+            delete request;
+        }
+
+        int fd = -1;
+        void* sqPointer = nullptr;
+        void* cqPointer = nullptr;
+        size_t sqSize = 0;
+        size_t cqSize = 0;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqesSize = 0;
+
+        unsigned* sqHead = nullptr;
+        unsigned* sqTail = nullptr;
+        unsigned* sqArray = nullptr;
+        unsigned sqMask = 0;
+        unsigned sqEntries = 0;
+
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_cqe* cqes = nullptr;
+
+        std::mutex mutex;
+        std::deque<Chunk*> backlog;
+        uint32_t inFlight = 0;
+        uint32_t depth = 0;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+#else
+
+    struct AsyncIO::Ring { };
+
+#endif
+
+    AsyncIO::AsyncIO(ThreadPool& pool, uint32_t queueDepth, bool useIoUring)
+        : m_pool(pool), m_bufferPool(std::make_shared<IOBufferPool>()) {
+#if HAZY_IO_URING
+        if (useIoUring) {
+            UniqueRef<Ring> ring(new Ring());
+            int error = ring->init(std::max<uint32_t>(queueDepth, 1));
+            if (error == 0) {
+                Ring* raw = ring.get();
+                ring->thread = std::thread([raw] {
+                    pthread_setname_np(pthread_self(), "HazyIO");
+                    raw->complete();
+                });
+                m_ring = std::move(ring);
+                Logger::LogTrace("Async I/O using io_uring with queue depth {}", m_ring->depth);
+            }
+            else {
+                Logger::LogWarn("io_uring is not available ({}), falling back to thread pool I/O", std::strerror(error));
+            }
+        }
+#else
+        (void)queueDepth;
+        (void)useIoUring;
+#endif
+    }
+
+    AsyncIO::~AsyncIO() = default;
+
+    PooledFuture<IOBuffer> AsyncIO::readFile(const std::string& path, TaskPriority priority) {
+#if HAZY_IO_URING
+        if (m_ring) {
+            FutureState* state = FutureState::acquire();
+            PooledFuture<IOBuffer> future(state);
+            UniqueRef<Request> request(new Request(state));
+            request->path = path;
+            request->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat status;
+            if (request->fd < 0 || fstat(request->fd, &status) != 0) {
+                if (request->fd >= 0)
+                    close(request->fd);
+                request->promise.setException(std::make_exception_ptr(std::runtime_error("Failed to open file: " + path)));
+                return future;
+            }
+            request->length = static_cast<size_t>(status.st_size);
+            request->buffer.emplace(m_bufferPool->acquire(request->length));
+            request->destination = request->buffer->data();
+            submit(request.release());
+            return future;
+        }
+#endif
+        return m_pool.ExecutePooled(priority,
+            [path, bufferPool = m_bufferPool] {
+                size_t size = FileSize(path);
+                IOBuffer buffer = bufferPool->acquire(size);
+                buffer.resize(ReadAt(path, buffer.data(), size, 0));
+                return buffer;
+            });
+    }
+
+    PooledFuture<size_t> AsyncIO::read(const std::string& path, std::span<char> buffer, uint64_t offset, TaskPriority priority) {
+#if HAZY_IO_URING
+        if (m_ring) {
+            FutureState* state = FutureState::acquire();
+            PooledFuture<size_t> future(state);
+            UniqueRef<Request> request(new Request(state));
+            request->path = path;
+            request->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat status;
+            if (request->fd < 0 || fstat(request->fd, &status) != 0) {
+                if (request->fd >= 0)
+                    close(request->fd);
+                request->promise.setException(std::make_exception_ptr(std::runtime_error("Failed to open file: " + path)));
+                return future;
+            }
+            uint64_t fileSize = static_cast<uint64_t>(status.st_size);
+            request->offset = offset;
+            request->length = offset < fileSize ? static_cast<size_t>(std::min<uint64_t>(buffer.size(), fileSize - offset)) : 0;
+            request->destination = buffer.data();
+            submit(request.release());
+            return future;
+        }
+#endif
+        return m_pool.ExecutePooled(priority,
+            [path, buffer, offset] { return ReadAt(path, buffer.data(), buffer.size(), offset); });
+    }
+
+    void AsyncIO::submit(Request* request) {
+#if HAZY_IO_URING
+        if (request->length == 0) {
+            request->chunks.push_back(Request::Chunk { request, request->destination, request->offset, 0 });
+            request->remaining.store(1);
+            Ring::finishChunk(&request->chunks.back());
+            return;
+        }
+        size_t count = (request->length + s_chunkSize - 1) / s_chunkSize;
+        request->chunks.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            size_t begin = i * s_chunkSize;
+            uint32_t length = static_cast<uint32_t>(std::min(s_chunkSize, request->length - begin));
+            request->chunks.push_back(Request::Chunk { request, request->destination + begin, request->offset + begin, length });
+        }
+        request->remaining.store(count);
+        m_ring->submit(request->chunks);
+#else
+        (void)request;
+#endif
+    }
+
+}
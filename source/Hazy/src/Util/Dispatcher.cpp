@@ -0,0 +1,71 @@
+#include "Hazy/Util/Dispatcher.hpp"
+
+namespace Hazy {
+
+    Dispatcher::Dispatcher() : m_nodePool(s_nodePoolCapacity) {
+        Node* stub = acquireNode();
+        m_head.store(stub, std::memory_order_relaxed);
+        m_tail = stub;
+    }
+
+    Dispatcher::~Dispatcher() {
+        // 还没有执行的函数直接销毁，等待它们的 future 会得到 broken_promise
+        while (Node* node = pop()) {
+            node->job.reset();
+        }
+        releaseNode(m_tail);
+    }
+
+    Dispatcher::Node* Dispatcher::acquireNode() {
+        Node* node = m_nodePool.acquire();
+        if (node == nullptr)
+            node = new Node();
+        node->next.store(nullptr, std::memory_order_relaxed);
+        return node;
+    }
+
+    void Dispatcher::releaseNode(Node* node) {
+        if (m_nodePool.owns(node))
+            m_nodePool.release(node);
+        else
+            delete node;
+    }
+
+    void Dispatcher::push(Node* node) {
+        m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+        Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    Dispatcher::Node* Dispatcher::pop() {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return nullptr;
+        m_tail = next;
+        releaseNode(tail);
+        m_pendingCount.fetch_sub(1, std::memory_order_relaxed);
+        return next;
+    }
+
+    size_t Dispatcher::drain(std::chrono::microseconds budget) {
+        auto deadline = std::chrono::steady_clock::now() + budget;
+        size_t executed = 0;
+        while (Node* node = pop()) {
+            try {
+                node->job.run();
+            }
+            catch (const std::exception& e) {
+                Logger::LogError("Unhandled exception in dispatched function: {}", e.what());
+            }
+            catch (...) {
+                Logger::LogError("Unhandled exception in dispatched function");
+            }
+            executed++;
+            if (budget.count() > 0 && std::chrono::steady_clock::now() >= deadline)
+                break;
+        }
+        return executed;
+    }
+
+}
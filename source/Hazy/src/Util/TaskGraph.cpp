@@ -0,0 +1,171 @@
+#include "Hazy/Util/TaskGraph.h"
+#include "Hazy/Util/ThreadPool.hpp"
+
+namespace Hazy {
+
+    TaskGraph::~TaskGraph() {
+        // 节点还在线程池里执行的时候不能销毁图
+        if (m_running) {
+            try {
+                wait();
+            }
+            catch (...) {
+                Logger::LogError("TaskGraph destroyed with an unhandled exception");
+            }
+        }
+    }
+
+    TaskGraph::NodeID TaskGraph::addNode(const std::string& name, std::function<void()> work) {
+        checkNotRunning();
+        m_nodes.push_back(Node { name, std::move(work), {}, 0 });
+        m_compiled = false;
+        return static_cast<NodeID>(m_nodes.size() - 1);
+    }
+
+    TaskGraph& TaskGraph::precede(NodeID before, NodeID after) {
+        checkNotRunning();
+        if (before >= m_nodes.size() || after >= m_nodes.size())
+            throw std::out_of_range("TaskGraph node does not exist");
+        m_nodes[before].successors.push_back(after);
+        m_nodes[after].dependencyCount++;
+        m_compiled = false;
+        return *this;
+    }
+
+    void TaskGraph::compile() {
+        checkNotRunning();
+        size_t count = m_nodes.size();
+
+        m_successors.clear();
+        m_successorOffsets.clear();
+        m_roots.clear();
+        m_successorOffsets.reserve(count + 1);
+        for (const Node& node : m_nodes) {
+            m_successorOffsets.push_back(static_cast<uint32_t>(m_successors.size()));
+            m_successors.insert(m_successors.end(), node.successors.begin(), node.successors.end());
+            if (node.dependencyCount == 0)
+                m_roots.push_back(static_cast<NodeID>(&node - m_nodes.data()));
+        }
+        m_successorOffsets.push_back(static_cast<uint32_t>(m_successors.size()));
+
+        // 拓扑排序检查有没有环
+        std::vector<uint32_t> dependencies(count);
+        for (size_t i = 0; i < count; i++) {
+            dependencies[i] = m_nodes[i].dependencyCount;
+        }
+        std::vector<NodeID> ready(m_roots.begin(), m_roots.end());
+        size_t visited = 0;
+        while (!ready.empty()) {
+            NodeID node = ready.back();
+            ready.pop_back();
+            visited++;
+            for (uint32_t i = m_successorOffsets[node]; i < m_successorOffsets[node + 1]; i++) {
+                if (--dependencies[m_successors[i]] == 0)
+                    ready.push_back(m_successors[i]);
+            }
+        }
+        if (visited != count)
+            throw std::logic_error("TaskGraph contains a cycle");
+
+        m_pending.reset(new std::atomic<uint32_t>[count]);
+        m_compiled = true;
+    }
+
+    void TaskGraph::launch(ThreadPool& pool, TaskPriority priority) {
+        checkNotRunning();
+        if (!m_compiled)
+            compile();
+        if (m_nodes.empty())
+            return;
+
+        // 重置计数器，不需要重新分配任何内存
+        for (size_t i = 0; i < m_nodes.size(); i++) {
+            m_pending[i].store(m_nodes[i].dependencyCount, std::memory_order_relaxed);
+        }
+        m_pool = &pool;
+        m_priority = priority;
+        m_exception = nullptr;
+        m_failed.store(false, std::memory_order_relaxed);
+        m_remaining.store(static_cast<uint32_t>(m_nodes.size()));
+        m_running = true;
+
+        for (NodeID root : m_roots) {
+            submit(root);
+        }
+    }
+
+    void TaskGraph::wait() {
+        if (!m_running)
+            return;
+        // 等待的时候帮忙执行线程池里的任务，在线程池的任务里等待另一个图也不会死锁
+        m_pool->wait(Completion { m_remaining });
+        m_running = false;
+        if (m_exception)
+            std::rethrow_exception(m_exception);
+    }
+
+    void TaskGraph::clear() {
+        checkNotRunning();
+        m_nodes.clear();
+        m_successors.clear();
+        m_successorOffsets.clear();
+        m_roots.clear();
+        m_pending.reset();
+        m_compiled = false;
+    }
+
+    void TaskGraph::submit(NodeID node) {
+        try {
+            m_pool->Submit(m_priority, [this, node] { execute(node); });
+        }
+        catch (...) {
+            // 提交失败（比如线程池已经停止）时记下异常，然后在当前线程把这个节点当作失败的节点走完，
+            // 它和它的后继节点都不会执行，但是都会被计为完成，wait() 不会一直等下去
+            fail(std::current_exception());
+            execute(node);
+        }
+    }
+
+    void TaskGraph::fail(std::exception_ptr exception) {
+        if (!m_failed.exchange(true))
+            m_exception = exception;
+    }
+
+    void TaskGraph::execute(NodeID node) {
+        while (true) {
+            if (!m_failed.load(std::memory_order_relaxed)) {
+                try {
+                    m_nodes[node].work();
+                }
+                catch (...) {
+                    fail(std::current_exception());
+                }
+            }
+
+            // 释放后继节点，第一个就绪的后继节点留在当前线程继续执行，省去一次调度
+            NodeID next = static_cast<NodeID>(m_nodes.size());
+            for (uint32_t i = m_successorOffsets[node]; i < m_successorOffsets[node + 1]; i++) {
+                NodeID successor = m_successors[i];
+                if (m_pending[successor].fetch_sub(1) == 1) {
+                    if (next == m_nodes.size())
+                        next = successor;
+                    else
+                        submit(successor);
+                }
+            }
+
+            // 最后一个节点完成之后，等待者随时可能销毁这个图，之后不能再访问任何成员。
+            // 这一次不是最后一个的话，其他线程也可能紧接着完成最后一个节点，所以要在递减之前判断有没有后继节点
+            const bool hasNext = next != m_nodes.size();
+            if (m_remaining.fetch_sub(1) == 1 || !hasNext)
+                return;
+            node = next;
+        }
+    }
+
+    void TaskGraph::checkNotRunning() const {
+        if (m_running)
+            throw std::logic_error("TaskGraph is running, call wait() first");
+    }
+
+}
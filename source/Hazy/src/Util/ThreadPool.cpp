@@ -1,12 +1,229 @@
 #include "Hazy/Util/ThreadPool.hpp"
+#include <limits>
+
+#ifdef WINDOWS_PLATFORM
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+    #define HAZY_CPU_RELAX() _mm_pause()
+#else
+    #define HAZY_CPU_RELAX() std::this_thread::yield()
+#endif
 
 namespace Hazy {
 
-    ThreadPool::ThreadPool(int threadCount)
-        : m_stopped(false) {
-        Logger::LogTrace("Creating thread pool with {} threads", threadCount);
+    namespace {
+        // 当前线程所属的线程池和它在线程池中的序号，不是工作线程的话为nullptr
+        thread_local ThreadPool* t_currentPool = nullptr;
+        thread_local size_t t_workerIndex = 0;
+        thread_local uint32_t t_randomState = 0x9E3779B9u;
+
+        constexpr size_t s_noWorker = static_cast<size_t>(-1);
+
+        // 可以固定到的核心序号的上限（不包含），由各个平台的亲和性掩码的大小决定
+#ifdef WINDOWS_PLATFORM
+        constexpr int s_coreLimit = static_cast<int>(sizeof(DWORD_PTR) * 8);
+#elif defined(__linux__)
+        constexpr int s_coreLimit = CPU_SETSIZE;
+#else
+        constexpr int s_coreLimit = std::numeric_limits<int>::max();
+#endif
+
+        inline bool IsValidCore(int core) {
+            return core >= 0 && core < s_coreLimit;
+        }
+
+        // PooledFuture 的共享状态是全局共享的，这样 future 的生命周期可以比线程池更长
+        ObjectPool<FutureState>& FutureStatePool() {
+            static ObjectPool<FutureState> pool(4096);
+            return pool;
+        }
+
+        // ExecuteBatch 使用的任务指针数组，每个线程缓存一个
+        thread_local std::vector<ThreadPool::Job*> t_jobList;
+
+        void SetCurrentThreadName(const std::string& name) {
+#ifdef WINDOWS_PLATFORM
+            std::wstring wideName(name.begin(), name.end());
+            if (FAILED(SetThreadDescription(GetCurrentThread(), wideName.c_str())))
+                Logger::LogWarn("Failed to set thread name: {}", name);
+#elif defined(__linux__)
+            // Linux 的线程名字最多15个字符
+            if (pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) != 0)
+                Logger::LogWarn("Failed to set thread name: {}", name);
+#elif defined(__APPLE__)
+            pthread_setname_np(name.c_str());
+#endif
+        }
+
+        void PinCurrentThread(int core) {
+            if (!IsValidCore(core)) {
+                Logger::LogWarn("Core {} is out of range [0, {}), thread will not be pinned", core, s_coreLimit);
+                return;
+            }
+#ifdef WINDOWS_PLATFORM
+            if (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) == 0)
+                Logger::LogWarn("Failed to pin thread to core {}", core);
+#elif defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core, &set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+                Logger::LogWarn("Failed to pin thread to core {}", core);
+#else
+            Logger::LogWarn("Thread affinity is not supported on this platform, core {} ignored", core);
+#endif
+        }
+
+        ThreadPoolConfig MakeConfig(int threadCount, ThreadPoolMode mode) {
+            ThreadPoolConfig config;
+            config.threadCount = threadCount;
+            config.mode = mode;
+            return config;
+        }
+
+        /**
+         * @brief 计算同时执行后台任务的线程数量上限，给帧任务留出一个线程
+         * @note 只有一个工作线程时留不出线程，上限仍然是1，否则后台任务永远不会执行；
+         * 这时帧任务由调用 ThreadPool::wait() 等待它的线程亲自执行
+         */
+        size_t BackgroundLimit(int threadCount) {
+            if (threadCount <= 1) {
+                Logger::LogTrace("Thread pool has a single worker, frame tasks rely on the waiting thread while background work is running");
+                return 1;
+            }
+            return static_cast<size_t>(threadCount - 1);
+        }
+
+        /**
+         * @brief 根据配置计算每一个工作线程固定到哪一个核心上，超出范围的核心会被忽略
+         * @return std::vector<int> 每个工作线程的核心，为空表示不固定
+         */
+        std::vector<int> AssignCores(const ThreadPoolConfig& config) {
+            std::vector<int> cores;
+            for (int core : config.cpuCores) {
+                if (IsValidCore(core))
+                    cores.push_back(core);
+                else
+                    Logger::LogWarn("Core {} is out of range [0, {}), ignored", core, s_coreLimit);
+            }
+            if (cores.empty() && !config.cpuCores.empty()) {
+                Logger::LogWarn("None of the given cores is valid, worker threads will not be pinned");
+                return {};
+            }
+            if (cores.empty() && config.pinWorkers) {
+                int hardware = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, s_coreLimit);
+                for (int core = 0; core < hardware; core++) {
+                    bool reserved = core == config.mainThreadCore
+                        || std::find(config.reservedCores.begin(), config.reservedCores.end(), core) != config.reservedCores.end();
+                    if (!reserved)
+                        cores.push_back(core);
+                }
+                if (cores.empty()) {
+                    Logger::LogWarn("All cores are reserved, worker threads will not be pinned");
+                    return {};
+                }
+            }
+            if (cores.empty())
+                return {};
+
+            std::vector<int> assigned(std::max(0, config.threadCount));
+            for (size_t i = 0; i < assigned.size(); i++) {
+                assigned[i] = cores[i % cores.size()];
+            }
+            return assigned;
+        }
+
+        // xorshift，用于随机选择被窃取的线程
+        inline uint32_t NextRandom() {
+            uint32_t x = t_randomState;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            t_randomState = x;
+            return x;
+        }
+    }
+
+    FutureState* FutureState::acquire() {
+        FutureState* state = FutureStatePool().acquire();
+        if (state == nullptr)
+            state = new FutureState();
+        state->m_status.store(static_cast<uint32_t>(Status::Pending), std::memory_order_relaxed);
+        state->m_references.store(2, std::memory_order_relaxed);
+        return state;
+    }
+
+    void FutureState::release() {
+        if (m_references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        if (m_destroyValue != nullptr) {
+            m_destroyValue(*this);
+            m_destroyValue = nullptr;
+        }
+        m_exception = nullptr;
+        if (FutureStatePool().owns(this))
+            FutureStatePool().release(this);
+        else
+            delete this;
+    }
+
+    ObjectPool<TaskGroup::State>& TaskGroup::State::Pool() {
+        // 和 FutureState 一样是全局共享的
+        static ObjectPool<State> pool(1024);
+        return pool;
+    }
+
+    TaskGroup::State* TaskGroup::State::acquire(size_t count) {
+        State* state = Pool().acquire();
+        if (state == nullptr)
+            state = new State();
+        state->remaining.store(count, std::memory_order_relaxed);
+        state->references.store(count > 0 ? 2 : 1, std::memory_order_relaxed);
+        state->failed.store(false, std::memory_order_relaxed);
+        state->size = count;
+        return state;
+    }
+
+    void TaskGroup::State::release() {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        exception = nullptr;
+        if (Pool().owns(this))
+            Pool().release(this);
+        else
+            delete this;
+    }
+
+    ThreadPool::ThreadPool(int threadCount, ThreadPoolMode mode)
+        : ThreadPool(MakeConfig(threadCount, mode)) {
+    }
+
+    ThreadPool::ThreadPool(const ThreadPoolConfig& config)
+        : m_jobPool(s_jobPoolCapacity), m_backgroundLimit(BackgroundLimit(config.threadCount)), m_stopped(false),
+        m_config(config), m_mode(config.mode) {
+        int threadCount = std::max(0, config.threadCount);
+        Logger::LogTrace("Creating thread pool with {} threads ({})", threadCount,
+            m_mode == ThreadPoolMode::WorkStealing ? "work stealing" : "shared queue");
+        if (config.mainThreadCore >= 0)
+            PinCurrentThread(config.mainThreadCore);
+
+        std::vector<int> cores = AssignCores(config);
+        if (m_mode == ThreadPoolMode::WorkStealing) {
+            for (int i = 0; i < threadCount; i++) {
+                m_workers.emplace_back(new Worker());
+            }
+        }
         for (int i = 0; i < threadCount; i++) {
-            m_threads.emplace_back(std::thread(&ThreadPool::Work, this));
+            int core = cores.empty() ? -1 : cores[i];
+            m_threads.emplace_back(std::thread(&ThreadPool::Work, this, static_cast<size_t>(i), core));
         }
     }
 
@@ -22,30 +239,330 @@ namespace Hazy {
         Logger::LogTrace("Destroyed thread pool");
     }
 
+    ThreadPool::Job* ThreadPool::acquireJob() {
+        Job* job = m_jobPool.acquire();
+        // 任务对象用完了，说明提交的速度超过了执行的速度，提交者先帮忙执行几个任务
+        for (int i = 0; job == nullptr && i < 64; i++) {
+            if (!runPendingJob())
+                std::this_thread::yield();
+            job = m_jobPool.acquire();
+        }
+        if (job == nullptr)
+            job = new Job();
+        return job;
+    }
 
-    void ThreadPool::Work() {
-        while (true) {
-            // 声明一个函数类型的变量
-            std::function<void()> task;
-            // 从任务队列中获取任务
-            {
-                std::unique_lock<std::mutex> lock(m_queueMutex);
-                // 如果现在没下班且任务队列为空，摸鱼等待任务
-                // 如果现在没下班且任务队列不为空，取任务
-                // 如果现在下班了，往下执行，直接下班了
-                m_cv.wait(lock,
-                    [this] {
-                        return m_stopped || !m_taskQueue.empty();
-                    });
-                // 如果任务队列为空，且线程池停止，返回
-                if (m_stopped && m_taskQueue.empty())
-                    return;
-                task = std::move(m_taskQueue.front());
-                m_taskQueue.pop();
+    void ThreadPool::releaseJob(Job* job) {
+        if (m_jobPool.owns(job))
+            m_jobPool.release(job);
+        else
+            delete job;
+    }
+
+    std::vector<ThreadPool::Job*> ThreadPool::acquireJobList(size_t capacity) {
+        std::vector<Job*> jobs = std::move(t_jobList);
+        jobs.clear();
+        jobs.reserve(capacity);
+        return jobs;
+    }
+
+    void ThreadPool::releaseJobList(std::vector<Job*>&& jobs) {
+        // 嵌套提交时留下容量更大的那一个
+        if (jobs.capacity() > t_jobList.capacity())
+            t_jobList = std::move(jobs);
+    }
+
+    void ThreadPool::runJob(Job* job) {
+        bool background = job->getPriority() == TaskPriority::Background;
+        auto begin = background ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        try {
+            job->run();
+        }
+        catch (const std::exception& e) {
+            Logger::LogError("Unhandled exception in thread pool: {}", e.what());
+        }
+        catch (...) {
+            Logger::LogError("Unhandled exception in thread pool");
+        }
+        releaseJob(job);
+
+        if (background) {
+            m_backgroundSpent.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+            m_backgroundRunning.fetch_sub(1);
+            // 腾出了一个执行后台任务的名额，叫醒一个线程来接着执行
+            if (m_globalCount[lane(TaskPriority::Background)].load() > 0)
+                notifyWorkers();
+        }
+    }
+
+    bool ThreadPool::runPendingJob(bool allowBackground) {
+        Job* job = findJob(t_currentPool == this ? t_workerIndex : s_noWorker, allowBackground);
+        if (job == nullptr)
+            return false;
+        runJob(job);
+        return true;
+    }
+
+    bool ThreadPool::runBlockedBackgroundJob() {
+        Job* job = popGlobal(TaskPriority::Background);
+        if (job == nullptr)
+            return false;
+        // 和 findJob() 一样占一个后台名额，runJob() 执行完之后归还
+        m_backgroundRunning.fetch_add(1);
+        runJob(job);
+        return true;
+    }
+
+    void ThreadPool::idle(uint32_t& idleRounds) {
+        if (idleRounds < s_blockedIdleRounds) {
+            idleRounds++;
+            std::this_thread::yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    void ThreadPool::JobRing::push(Job* job) {
+        if (size == buffer.size()) {
+            // 环形缓冲区满了，扩容为原来的两倍，并把元素按顺序搬到开头
+            std::vector<Job*> grown(buffer.size() * 2, nullptr);
+            for (size_t i = 0; i < size; i++) {
+                grown[i] = buffer[(head + i) % buffer.size()];
             }
+            buffer.swap(grown);
+            head = 0;
+        }
+        buffer[(head + size) % buffer.size()] = job;
+        size++;
+    }
+
+    ThreadPool::Job* ThreadPool::JobRing::pop() {
+        if (size == 0)
+            return nullptr;
+        Job* job = buffer[head];
+        head = (head + 1) % buffer.size();
+        size--;
+        return job;
+    }
+
+    void ThreadPool::rejectJobs(Job* const* jobs, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            jobs[i]->reset();
+            releaseJob(jobs[i]);
+        }
+        throw std::runtime_error("ThreadPool has been stopped.");
+    }
+
+    void ThreadPool::enqueue(Job* job) {
+        // 外部线程提交的任务要在同一把锁里检查 m_stopped 并放进队列，否则和析构函数赛跑时，
+        // 工作线程可能在任务放进队列之前就下班了，任务永远不会执行；
+        // 工作线程自己提交时它还活着，下班之前一定会把队列里的任务做完，所以只需要提前检查一次
+        bool worker = t_currentPool == this;
+        if (worker && m_stopped)
+            rejectJobs(&job, 1);
+
+        TaskPriority priority = job->getPriority();
+        bool background = priority == TaskPriority::Background;
+
+        // 工作线程自己提交的 Normal 任务优先放进自己的队列，队列满了再放进全局队列
+        if (priority == TaskPriority::Normal && worker && m_mode == ThreadPoolMode::WorkStealing
+            && m_workers[t_workerIndex]->deque.push(job)) {
+            m_pendingCount.fetch_add(1);
+        }
+        else {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            if (!worker && m_stopped) {
+                lock.unlock();
+                rejectJobs(&job, 1);
+            }
+            m_taskQueue[lane(priority)].push(job);
+            m_globalCount[lane(priority)].fetch_add(1);
+            // 后台任务不计入 m_pendingCount，它们能不能执行还要看预算，由 backgroundRunnable() 判断；
+            // 计数也要在锁里增加，工作线程在锁里检查计数决定是否下班
+            if (!background)
+                m_pendingCount.fetch_add(1);
+        }
+        notifyWorkers();
+    }
+
+    void ThreadPool::enqueueBatch(Job* const* jobs, size_t count, TaskPriority priority) {
+        // 和 enqueue() 一样，外部线程在放进全局队列的同一把锁里检查 m_stopped
+        bool worker = t_currentPool == this;
+        if (worker && m_stopped)
+            rejectJobs(jobs, count);
+
+        // 工作线程自己提交的 Normal 任务优先放进自己的队列，放不下的部分放进全局队列
+        size_t local = 0;
+        if (priority == TaskPriority::Normal && worker && m_mode == ThreadPoolMode::WorkStealing) {
+            WorkStealingDeque<Job*>& deque = m_workers[t_workerIndex]->deque;
+            while (local < count && deque.push(jobs[local])) {
+                local++;
+            }
+            m_pendingCount.fetch_add(local);
+        }
+        if (local < count) {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            if (!worker && m_stopped) {
+                lock.unlock();
+                rejectJobs(jobs, count);
+            }
+            JobRing& ring = m_taskQueue[lane(priority)];
+            for (size_t i = local; i < count; i++) {
+                ring.push(jobs[i]);
+            }
+            m_globalCount[lane(priority)].fetch_add(count - local);
+            if (priority != TaskPriority::Background)
+                m_pendingCount.fetch_add(count - local);
+        }
+        notifyWorkers(count);
+    }
+
+    void ThreadPool::beginFrame() {
+        m_backgroundSpent.store(0);
+        // 上一帧因为预算用完而睡觉的线程，现在可以继续执行后台任务了
+        if (m_globalCount[lane(TaskPriority::Background)].load() > 0 && m_sleepingCount.load() > 0) {
+            { std::lock_guard<std::mutex> lock(m_queueMutex); }
+            m_cv.notify_all();
+        }
+    }
+
+    size_t ThreadPool::getQueueDepth(TaskPriority priority) const {
+        size_t depth = m_globalCount[lane(priority)].load(std::memory_order_relaxed);
+        if (priority == TaskPriority::Normal) {
+            for (const UniqueRef<Worker>& worker : m_workers) {
+                depth += worker->deque.size();
+            }
+        }
+        return depth;
+    }
+
+    bool ThreadPool::backgroundRunnable() const {
+        if (m_globalCount[lane(TaskPriority::Background)].load() == 0)
+            return false;
+        if (m_backgroundRunning.load() >= m_backgroundLimit)
+            return false;
+        // 线程池停止之后不再限制预算，让剩下的后台任务尽快执行完
+        int64_t budget = m_backgroundBudget.load(std::memory_order_relaxed);
+        return m_stopped || budget <= 0 || m_backgroundSpent.load(std::memory_order_relaxed) < budget;
+    }
+
+    void ThreadPool::notifyWorkers(size_t count) {
+        // 和 Work() 中的 m_sleepingCount 配合：两边都使用顺序一致的原子操作，
+        // 所以要么提交者看到有线程在睡觉，要么睡觉的线程看到新的任务，不会丢失唤醒
+        int sleeping = m_sleepingCount.load();
+        if (sleeping > 0) {
+            { std::lock_guard<std::mutex> lock(m_queueMutex); }
+            if (count >= static_cast<size_t>(sleeping)) {
+                m_cv.notify_all();
+            }
+            else {
+                for (size_t i = 0; i < count; i++) {
+                    m_cv.notify_one();
+                }
+            }
+        }
+    }
+
+    ThreadPool::Job* ThreadPool::popGlobal(TaskPriority priority) {
+        size_t index = lane(priority);
+        if (m_globalCount[index].load(std::memory_order_relaxed) == 0)
+            return nullptr;
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        Job* job = m_taskQueue[index].pop();
+        if (job != nullptr)
+            m_globalCount[index].fetch_sub(1);
+        return job;
+    }
+
+    ThreadPool::Job* ThreadPool::steal(size_t thief) {
+        size_t count = m_workers.size();
+        if (count == 0)
+            return nullptr;
+        size_t start = NextRandom() % count;
+        for (size_t i = 0; i < count; i++) {
+            size_t victim = (start + i) % count;
+            if (victim == thief)
+                continue;
+            if (Job* job = m_workers[victim]->deque.steal())
+                return job;
+        }
+        return nullptr;
+    }
+
+    ThreadPool::Job* ThreadPool::findJob(size_t index, bool allowBackground) {
+        Job* job = popGlobal(TaskPriority::Critical);
+        if (m_mode == ThreadPoolMode::WorkStealing) {
+            if (job == nullptr && index != s_noWorker) job = m_workers[index]->deque.pop();
+            if (job == nullptr) job = popGlobal(TaskPriority::Normal);
+            if (job == nullptr) job = steal(index);
+        }
+        else if (job == nullptr) {
+            job = popGlobal(TaskPriority::Normal);
+        }
+        if (job != nullptr) {
+            m_pendingCount.fetch_sub(1);
+            return job;
+        }
+
+        // 没有更高优先级的任务了，先占一个后台名额，再去取后台任务
+        if (allowBackground && backgroundRunnable()) {
+            if (m_backgroundRunning.fetch_add(1) < m_backgroundLimit)
+                job = popGlobal(TaskPriority::Background);
+            if (job == nullptr)
+                m_backgroundRunning.fetch_sub(1);
+        }
+        return job;
+    }
+
+    bool ThreadPool::spinForWork() const {
+        if (m_config.spinDuration.count() <= 0)
+            return false;
+        auto deadline = std::chrono::steady_clock::now() + m_config.spinDuration;
+        do {
+            for (int i = 0; i < 64; i++) {
+                if (m_stopped.load(std::memory_order_relaxed))
+                    return false;
+                if (m_pendingCount.load(std::memory_order_relaxed) > 0 || backgroundRunnable())
+                    return true;
+                HAZY_CPU_RELAX();
+            }
+        } while (std::chrono::steady_clock::now() < deadline);
+        return false;
+    }
+
+    void ThreadPool::Work(size_t index, int core) {
+        t_currentPool = this;
+        t_workerIndex = index;
+        t_randomState = static_cast<uint32_t>(index) * 2654435761u + 1u;
+        if (!m_config.name.empty())
+            SetCurrentThreadName(m_config.name + "-" + std::to_string(index));
+        if (core >= 0)
+            PinCurrentThread(core);
+
+        while (true) {
             // 上班
-            task();
+            if (Job* job = findJob(index)) {
+                runJob(job);
+                continue;
+            }
+
+            // 没有任务了，先自旋一会儿，这段时间里提交的任务不需要唤醒就能被马上取走
+            if (spinForWork())
+                continue;
+
+            // 没有任务可以做了，摸鱼等待任务
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_sleepingCount.fetch_add(1);
+            m_cv.wait(lock,
+                [this] {
+                    return m_stopped || m_pendingCount.load() > 0 || backgroundRunnable();
+                });
+            m_sleepingCount.fetch_sub(1);
+            // 如果所有任务（包括后台任务）都做完了，且线程池停止，下班
+            if (m_stopped && m_pendingCount.load() == 0 && m_globalCount[lane(TaskPriority::Background)].load() == 0)
+                return;
         }
     }
 
-}
\ No newline at end of file
+}
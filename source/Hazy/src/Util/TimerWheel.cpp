@@ -0,0 +1,179 @@
+#include "Hazy/Util/TimerWheel.h"
+
+namespace Hazy {
+
+    TimerWheel::TimerWheel() : m_nodes(s_sentinelCount + 1) {
+        for (uint32_t i = 0; i <= s_sentinelCount; i++) {
+            m_nodes[i].prev = i;
+            m_nodes[i].next = i;
+        }
+    }
+
+    TimerWheel::Handle TimerWheel::add(uint64_t delay, uint64_t interval, Callback callback) {
+        uint32_t index;
+        if (m_freeHead != s_nil) {
+            index = m_freeHead;
+            m_freeHead = m_nodes[index].next;
+        }
+        else {
+            index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+        }
+
+        Node& node = m_nodes[index];
+        node.prev = index;
+        node.next = index;
+        node.active = true;
+        node.expiry = m_now + std::max<uint64_t>(delay, 1);
+        node.interval = interval;
+        node.callback = std::move(callback);
+        place(index);
+        m_size++;
+        return Handle { this, index, node.generation };
+    }
+
+    bool TimerWheel::cancel(Handle handle) {
+        if (!isPending(handle))
+            return false;
+        // 正在触发的重复定时器不在任何链表中，unlink() 什么也不做
+        unlink(handle.index);
+        release(handle.index);
+        return true;
+    }
+
+    bool TimerWheel::isPending(Handle handle) const {
+        return handle.owner == this && handle.index > s_scratch && handle.index < m_nodes.size()
+            && m_nodes[handle.index].generation == handle.generation && m_nodes[handle.index].active;
+    }
+
+    size_t TimerWheel::advance(uint64_t ticks) {
+        // 没有定时器的时候直接跳过去
+        if (m_size == 0) {
+            m_now += ticks;
+            return 0;
+        }
+        size_t fired = 0;
+        for (uint64_t i = 0; i < ticks; i++) {
+            fired += tick();
+            if (m_size == 0) {
+                m_now += ticks - i - 1;
+                break;
+            }
+        }
+        return fired;
+    }
+
+    size_t TimerWheel::tick() {
+        m_now++;
+
+        // 高层的槽转到了，把里面的定时器分散到低层，先处理高层，分散下来的定时器可能还要继续往下分散
+        for (uint32_t level = s_levelCount - 1; level > 0; level--) {
+            uint64_t span = uint64_t(1) << (level * s_slotBits);
+            if ((m_now & (span - 1)) == 0)
+                cascade(level, static_cast<uint32_t>((m_now >> (level * s_slotBits)) & (s_slotCount - 1)));
+        }
+
+        size_t fired = 0;
+        uint32_t sentinel = static_cast<uint32_t>(m_now & (s_slotCount - 1));
+        for (uint32_t index = m_nodes[sentinel].next; index != sentinel; index = m_nodes[sentinel].next) {
+            unlink(index);
+            if (m_nodes[index].expiry > m_now) {
+                place(index);
+                continue;
+            }
+
+            fired++;
+            if (m_nodes[index].interval == 0) {
+                // 一次性定时器在回调之前就结束了，回调中取消它会失败，节点可以被回调中添加的定时器复用
+                Callback callback = std::move(m_nodes[index].callback);
+                release(index);
+                callback();
+                continue;
+            }
+
+            // 重复定时器先放到下一次触发的位置，回调中可以取消它
+            Node& node = m_nodes[index];
+            uint32_t generation = node.generation;
+            node.expiry += node.interval;
+            place(index);
+            Callback callback = std::move(node.callback);
+            // 回调中可能添加定时器导致 m_nodes 扩容，回调结束之后（包括抛出异常）重新查找节点
+            struct Restore {
+                TimerWheel& wheel;
+                uint32_t index;
+                uint32_t generation;
+                Callback& callback;
+                ~Restore() {
+                    Node& node = wheel.m_nodes[index];
+                    if (node.generation == generation && node.active)
+                        node.callback = std::move(callback);
+                }
+            } restore { *this, index, generation, callback };
+            callback();
+        }
+        return fired;
+    }
+
+    void TimerWheel::place(uint32_t index) {
+        Node& node = m_nodes[index];
+        uint64_t delta = node.expiry > m_now ? node.expiry - m_now : 0;
+        for (uint32_t level = 0; level < s_levelCount; level++) {
+            if (delta < (uint64_t(1) << ((level + 1) * s_slotBits))) {
+                uint64_t slot = (node.expiry >> (level * s_slotBits)) & (s_slotCount - 1);
+                linkBefore(level * s_slotCount + static_cast<uint32_t>(slot), index);
+                return;
+            }
+        }
+        // 超出了时间轮的范围，放到最高层最后转到的那个槽，转到时再重新放置
+        uint32_t top = s_levelCount - 1;
+        uint64_t slot = ((m_now >> (top * s_slotBits)) + s_slotCount - 1) & (s_slotCount - 1);
+        linkBefore(top * s_slotCount + static_cast<uint32_t>(slot), index);
+    }
+
+    void TimerWheel::cascade(uint32_t level, uint32_t slot) {
+        uint32_t sentinel = level * s_slotCount + slot;
+        if (m_nodes[sentinel].next == sentinel)
+            return;
+
+        // 整个链表先接到暂存的哨兵上，避免重新放置时又放回这个槽
+        Node& scratch = m_nodes[s_scratch];
+        scratch.next = m_nodes[sentinel].next;
+        scratch.prev = m_nodes[sentinel].prev;
+        m_nodes[scratch.next].prev = s_scratch;
+        m_nodes[scratch.prev].next = s_scratch;
+        m_nodes[sentinel].next = sentinel;
+        m_nodes[sentinel].prev = sentinel;
+
+        for (uint32_t index = m_nodes[s_scratch].next; index != s_scratch; index = m_nodes[s_scratch].next) {
+            unlink(index);
+            place(index);
+        }
+    }
+
+    void TimerWheel::linkBefore(uint32_t sentinel, uint32_t index) {
+        uint32_t last = m_nodes[sentinel].prev;
+        m_nodes[index].prev = last;
+        m_nodes[index].next = sentinel;
+        m_nodes[last].next = index;
+        m_nodes[sentinel].prev = index;
+    }
+
+    void TimerWheel::unlink(uint32_t index) {
+        Node& node = m_nodes[index];
+        m_nodes[node.prev].next = node.next;
+        m_nodes[node.next].prev = node.prev;
+        node.prev = index;
+        node.next = index;
+    }
+
+    void TimerWheel::release(uint32_t index) {
+        Node& node = m_nodes[index];
+        node.active = false;
+        node.callback = nullptr;
+        node.generation++;
+        node.next = m_freeHead;
+        m_freeHead = index;
+        m_size--;
+    }
+
+}
\ No newline at end of file
@@ -2,11 +2,24 @@
 #include <hazy_pch.h>
 #include "Hazy/Util/Log.h"
 #include "Hazy/EventSystem.h"
+#include "Hazy/Application.h"
 
 namespace Hazy {
 
+    namespace {
+        // 当前线程正在哪一个窗口的上下文中执行 update()
+        thread_local const Window* t_renderingWindow = nullptr;
+
+        // 在作用域内把当前线程标记为 window 的渲染线程，离开作用域时恢复
+        struct RenderingWindowScope {
+            explicit RenderingWindowScope(const Window* window) : previous(std::exchange(t_renderingWindow, window)) { }
+            ~RenderingWindowScope() { t_renderingWindow = previous; }
+            const Window* previous;
+        };
+    }
+
     Window::Window(WindowProps& props, API api)
-        : m_props(std::move(props)), m_api(api), m_updateFunc([] { }), m_renderFunc([this] { m_renderer->clear(); }) {
+        : m_props(std::move(props)), m_api(api), m_updateFunc([] { }), m_renderFunc([this] { m_renderer->clear(); }), m_syncFunc([] { }) {
         if (api == API::OpenGL) {
             {
                 m_context = Context::create<API::OpenGL>(this, m_props.title, m_props.width, m_props.height);
@@ -28,7 +41,7 @@ namespace Hazy {
     }
 
     Window::Window(WindowProps&& props, API api)
-        : m_props(std::move(props)), m_api(api), m_updateFunc([] { }), m_renderFunc([this] { m_renderer->clear();}) {
+        : m_props(std::move(props)), m_api(api), m_updateFunc([] { }), m_renderFunc([this] { m_renderer->clear();}), m_syncFunc([] { }) {
         if (api == API::OpenGL) {
             {
                 m_context = Context::create<API::OpenGL>(this, m_props.title, m_props.width, m_props.height);
@@ -50,6 +63,8 @@ namespace Hazy {
     }
 
     Window::~Window() {
+        // 正常情况下 Application 在销毁窗口之前已经结束了专用的渲染线程，这时派生类已经析构，只能尽量让上下文回到主线程
+        stopRenderThread();
         // 通知父子窗口，我被销毁了，你们自由了
         if (this->m_props.parrentWindow != nullptr) {
             this->m_props.parrentWindow->m_props.childWindows.erase(this);
@@ -59,20 +74,68 @@ namespace Hazy {
                 child->m_props.parrentWindow = nullptr;
             }
         }
+        // 派生类已经析构了，还在等待渲染线程的函数不能再执行，等待这个窗口的协程也不会再被恢复
+        if (m_context && m_context->getDispatcher().getPendingCount() > 0)
+            Logger::LogWarn("Window {} destroyed with {} pending render thread functions", m_props.title, m_context->getDispatcher().getPendingCount());
         Logger::LogTrace("Window destroyed: {} ", m_props.title);
     }
 
-    void Window::update() {
+    bool Window::isInRenderThread() const {
+        return t_renderingWindow == this;
+    }
+
+    void Window::beginFrame() {
+        if (m_frameBegun)
+            return;
         m_deltaTime = m_lastFrameTime.MoveOn();
-        m_updateFunc();
+        if (!m_frameGraph.empty())
+            m_frameGraph.launch(Application::getThreadPool(), TaskPriority::Critical);
+        m_frameBegun = true;
+    }
 
+    void Window::update() {
+        updateFrame();
+        syncFrame();
+        renderFrame();
+        m_context->PollEvents();
+    }
+
+    void Window::updateFrame() {
+        beginFrame();
+        if (m_fixedTimestep) {
+            const float frameDeltaTime = m_deltaTime;
+            const uint32_t steps = m_fixedTimestep->advance(frameDeltaTime);
+            m_deltaTime = m_fixedTimestep->getStep();
+            for (uint32_t i = 0; i < steps; i++)
+                m_updateFunc();
+            m_deltaTime = frameDeltaTime;
+        }
+        else {
+            m_updateFunc();
+        }
+        m_frameGraph.wait();
+        m_frameBegun = false;
+    }
+
+    void Window::syncFrame() {
+        for (const std::function<void()>& swap : m_frameDataSwaps) {
+            swap();
+        }
+        m_syncFunc();
+        m_renderDeltaTime = m_deltaTime;
+        m_interpolationAlpha = m_fixedTimestep ? m_fixedTimestep->getAlpha() : 1.0f;
+        // 这一帧之前分发的输入事件，在这一帧交换缓冲区之后统计延迟
+        m_presentingInputs.insert(m_presentingInputs.end(), m_pendingInputs.begin(), m_pendingInputs.end());
+        m_pendingInputs.clear();
+    }
+
+    void Window::renderFrame() {
         // 上下文锁，保证在调用上下文相关的函数时，上下文是有效的
         ContextLock contentLock(*m_context);
+        RenderingWindowScope scope(this);
 
-        while (!m_contentUpdateQueue.empty()) {
-            m_contentUpdateQueue.front()(); // 调用添加的需要上下文的函数
-            m_contentUpdateQueue.pop();     // 移除已经调用的函数
-        }
+        // 执行其他线程交给渲染线程的函数，比如调整视口大小、上传资源
+        m_context->getDispatcher().drain(m_renderThreadBudget);
 
         m_renderFunc();
 
@@ -80,7 +143,46 @@ namespace Hazy {
             layer->update();
         }
 
-        m_context->SwapBuffers();
+        m_context->Present();
+
+        if (!m_presentingInputs.empty()) {
+            InputLatency::recordPresent(m_presentingInputs, EventClock::now());
+            m_presentingInputs.clear();
+        }
+    }
+
+    void Window::startRenderThread() {
+        if (m_ownedRenderThread)
+            return;
+        m_ownedRenderThread.reset(new RenderThread(m_props.title));
+        // 上下文一直绑定在这个线程上，每一帧渲染时的 ContextLock 只是嵌套绑定，不会再切换上下文
+        m_ownedRenderThread->submit([this] { m_context->bind(); });
+        m_renderThread = m_ownedRenderThread.get();
+    }
+
+    void Window::stopRenderThread() {
+        if (!m_ownedRenderThread)
+            return;
+        try {
+            m_ownedRenderThread->wait();
+        }
+        catch (const std::exception& e) {
+            Logger::LogError("Render thread of window {} failed: {}", m_props.title, e.what());
+        }
+        catch (...) {
+            Logger::LogError("Render thread of window {} failed with an unknown exception", m_props.title);
+        }
+        m_ownedRenderThread->submit([this] { m_context->unbind(); });
+        m_ownedRenderThread.reset();
+        m_renderThread = nullptr;
+    }
+
+    void Window::setVSync(bool enabled) {
+        // 渲染线程持有上下文时，主线程不能绑定它
+        if (m_renderThread != nullptr)
+            postToRenderThread([this, enabled] { m_context->enableVSync(enabled); });
+        else
+            m_context->enableVSync(enabled);
     }
 
     void Window::onEvent(Event& e) {
@@ -89,7 +191,8 @@ namespace Hazy {
         case EventType::WindowResize:
             m_props.width = static_cast<WindowResizeEvent&>(e).getWidth();
             m_props.height = static_cast<WindowResizeEvent&>(e).getHeight();
-            m_contentUpdateQueue.emplace([this] { m_renderer->resize(m_props.width, m_props.height); });
+            // 按值捕获，渲染线程执行的时候主线程可能已经在处理下一次调整大小了
+            postToRenderThread([renderer = m_renderer, width = m_props.width, height = m_props.height] { renderer->resize(width, height); });
             break;
         default:
             break;
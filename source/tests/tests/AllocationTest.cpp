@@ -0,0 +1,163 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+    // 统计整个测试程序中调用全局 operator new 的次数
+    std::atomic<size_t> g_allocations = 0;
+
+    void WaitFor(const std::atomic<int>& counter, int expected) {
+        while (counter.load() < expected) {
+            std::this_thread::yield();
+        }
+    }
+
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+TEST(AllocationTest, SubmitDoesNotAllocateInSteadyState) {
+    constexpr int taskCount = 100000;
+    Hazy::ThreadPool pool(4);
+    std::atomic<int> counter = 0;
+
+    // 预热：让全局队列增长到稳定的容量
+    for (int i = 0; i < taskCount; i++) {
+        pool.Submit([&counter] { counter.fetch_add(1); });
+    }
+    WaitFor(counter, taskCount);
+
+    for (int frame = 0; frame < 5; frame++) {
+        counter = 0;
+        size_t before = g_allocations.load();
+        for (int i = 0; i < taskCount; i++) {
+            pool.Submit([&counter](int value) { counter.fetch_add(value); }, 1);
+        }
+        WaitFor(counter, taskCount);
+        EXPECT_EQ(g_allocations.load() - before, 0u) << "frame " << frame;
+    }
+}
+
+TEST(AllocationTest, NestedSubmitDoesNotAllocateInSteadyState) {
+    constexpr int taskCount = 1000;
+    Hazy::ThreadPool pool(4);
+    std::atomic<int> counter = 0;
+
+    auto frame = [&] {
+        counter = 0;
+        pool.Submit([&] {
+            for (int i = 0; i < taskCount; i++) {
+                pool.Submit([&counter] { counter.fetch_add(1); });
+            }
+        });
+        WaitFor(counter, taskCount);
+    };
+    frame();
+
+    size_t before = g_allocations.load();
+    for (int i = 0; i < 10; i++) {
+        frame();
+    }
+    EXPECT_EQ(g_allocations.load() - before, 0u);
+}
+
+TEST(AllocationTest, PooledFutureDoesNotAllocateInSteadyState) {
+    constexpr int taskCount = 1000;
+    Hazy::ThreadPool pool(4);
+    std::vector<Hazy::PooledFuture<int>> futures(taskCount);
+
+    auto frame = [&] {
+        for (int i = 0; i < taskCount; i++) {
+            futures[i] = pool.ExecutePooled([](int value) { return value * 2; }, i);
+        }
+        for (int i = 0; i < taskCount; i++) {
+            EXPECT_EQ(futures[i].get(), i * 2);
+        }
+    };
+    frame();
+
+    size_t before = g_allocations.load();
+    for (int i = 0; i < 10; i++) {
+        frame();
+    }
+    EXPECT_EQ(g_allocations.load() - before, 0u);
+}
+
+TEST(AllocationTest, PooledFuturePropagatesException) {
+    Hazy::ThreadPool pool(2);
+    auto future = pool.ExecutePooled([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(future.get(), std::runtime_error);
+    EXPECT_FALSE(future.valid());
+}
+
+TEST(AllocationTest, LargeCallableFallsBackToHeap) {
+    Hazy::ThreadPool pool(2);
+    std::array<int, 64> values {};
+    values.fill(3);
+    auto future = pool.ExecutePooled([values] {
+        int sum = 0;
+        for (int value : values) {
+            sum += value;
+        }
+        return sum;
+    });
+    EXPECT_EQ(future.get(), 192);
+}
+
+TEST(AllocationTest, EventQueueDoesNotAllocate) {
+    // 预热：创建事件队列的单例
+    Hazy::EventQueue::emplaceEvent<Hazy::WindowFocusEvent>(nullptr);
+    Hazy::EventQueue::pollEvent();
+
+    size_t before = g_allocations.load();
+    for (int frame = 0; frame < 100; frame++) {
+        for (int i = 0; i < 64; i++) {
+            Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(i), 0.0f, nullptr);
+            Hazy::EventQueue::emplaceEvent<Hazy::KeyPressedEvent>(Hazy::Key::A, 0, Hazy::ModifierKey::None, nullptr);
+        }
+        int count = 0;
+        if (frame % 2 == 0) {
+            while (Hazy::EventSlot slot = Hazy::EventQueue::pollEvent()) {
+                count += slot->getType() == Hazy::EventType::MouseMoved ? 1 : 0;
+            }
+        }
+        else {
+            for (Hazy::EventSlot& slot : Hazy::EventQueue::drain()) {
+                count += slot->getType() == Hazy::EventType::MouseMoved ? 1 : 0;
+            }
+        }
+        EXPECT_EQ(count, 64);
+    }
+    EXPECT_EQ(g_allocations.load() - before, 0u);
+}
+
+
+TEST(AllocationTest, EventFormattingDoesNotAllocate) {
+    Hazy::MouseMovedEvent moved(12.5f, 7.0f, nullptr);
+    Hazy::KeyPressedEvent pressed(Hazy::Key::Enter, 1, Hazy::ModifierKey::Control, nullptr);
+    fmt::memory_buffer buffer;  // 内部有 500 字节的缓冲区，和 Logger 使用的一样
+
+    size_t before = g_allocations.load();
+    for (int i = 0; i < 100; i++) {
+        buffer.clear();
+        fmt::format_to(fmt::appender(buffer), "{} {} {}", moved, pressed, Hazy::MouseButton::Middle);
+    }
+    EXPECT_EQ(g_allocations.load() - before, 0u);
+    EXPECT_GT(buffer.size(), 0u);
+}
\ No newline at end of file
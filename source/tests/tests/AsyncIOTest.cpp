@@ -0,0 +1,109 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+
+namespace {
+
+    std::string MakeContent(size_t size, unsigned seed) {
+        std::string content(size, '\0');
+        for (size_t i = 0; i < size; i++) {
+            content[i] = static_cast<char>((i * 31 + seed) & 0xFF);
+        }
+        return content;
+    }
+
+    std::string WriteFile(const std::string& name, const std::string& content) {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / ("HazyAsyncIOTest_" + name);
+        std::ofstream file(path, std::ios::binary);
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+        return path.string();
+    }
+
+    // 参数为true时使用 io_uring（不可用时自动退回到线程池），为false时总是使用线程池
+    class AsyncIOTest : public testing::TestWithParam<bool> { };
+
+}
+
+TEST_P(AsyncIOTest, ReadSmallAndLargeFiles) {
+    Hazy::ThreadPool pool(2);
+    Hazy::AsyncIO io(pool, 16, GetParam());
+    if (!GetParam()) {
+        EXPECT_EQ(io.getBackend(), Hazy::AsyncIO::Backend::ThreadPool);
+    }
+
+    std::string small = MakeContent(100, 1);
+    // 大于一个块，并且不是块大小的整数倍，会被切成多个请求
+    std::string large = MakeContent(Hazy::AsyncIO::s_chunkSize * 5 + 123, 2);
+    std::string empty;
+    std::string smallPath = WriteFile("small", small);
+    std::string largePath = WriteFile("large", large);
+    std::string emptyPath = WriteFile("empty", empty);
+
+    auto smallFuture = io.readFile(smallPath);
+    auto largeFuture = io.readFile(largePath);
+    auto emptyFuture = io.readFile(emptyPath);
+    EXPECT_EQ(pool.wait(std::move(smallFuture)).view(), small);
+    EXPECT_EQ(pool.wait(std::move(largeFuture)).view(), large);
+    EXPECT_TRUE(pool.wait(std::move(emptyFuture)).empty());
+}
+
+TEST_P(AsyncIOTest, ReadIntoCallerBuffer) {
+    Hazy::ThreadPool pool(2);
+    Hazy::AsyncIO io(pool, 16, GetParam());
+    std::string content = MakeContent(4096, 3);
+    std::string path = WriteFile("offset", content);
+
+    std::vector<char> buffer(1000);
+    EXPECT_EQ(io.read(path, buffer, 100).get(), 1000u);
+    EXPECT_EQ(std::string(buffer.data(), 1000), content.substr(100, 1000));
+
+    // 到达文件末尾时只读取剩下的部分
+    EXPECT_EQ(io.read(path, buffer, 3596).get(), 500u);
+    EXPECT_EQ(std::string(buffer.data(), 500), content.substr(3596));
+    EXPECT_EQ(io.read(path, buffer, 5000).get(), 0u);
+}
+
+TEST_P(AsyncIOTest, MissingFileThrows) {
+    Hazy::ThreadPool pool(2);
+    Hazy::AsyncIO io(pool, 16, GetParam());
+    EXPECT_THROW(io.readFile("/this/file/does/not/exist").get(), std::runtime_error);
+}
+
+TEST_P(AsyncIOTest, ManyFilesInFlight) {
+    Hazy::ThreadPool pool(2);
+    // 队列深度比请求数量小得多，超出的块要排队等待
+    Hazy::AsyncIO io(pool, 4, GetParam());
+    std::vector<std::string> contents;
+    std::vector<std::string> paths;
+    for (unsigned i = 0; i < 64; i++) {
+        contents.push_back(MakeContent(1000 + i * 997, i));
+        paths.push_back(WriteFile("many" + std::to_string(i), contents.back()));
+    }
+
+    std::vector<Hazy::PooledFuture<Hazy::IOBuffer>> futures;
+    for (const std::string& path : paths) {
+        futures.push_back(io.readFile(path));
+    }
+    for (size_t i = 0; i < futures.size(); i++) {
+        EXPECT_EQ(futures[i].get().view(), contents[i]);
+    }
+}
+
+TEST_P(AsyncIOTest, BuffersAreReused) {
+    Hazy::ThreadPool pool(2);
+    Hazy::AsyncIO io(pool, 16, GetParam());
+    std::string path = WriteFile("reuse", MakeContent(10000, 4));
+
+    const char* first;
+    {
+        Hazy::IOBuffer buffer = io.readFile(path).get();
+        first = buffer.data();
+    }
+    EXPECT_EQ(io.getBufferPool().getCachedCount(), 1u);
+    Hazy::IOBuffer buffer = io.readFile(path).get();
+    EXPECT_EQ(buffer.data(), first);
+    EXPECT_EQ(io.getBufferPool().getCachedCount(), 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, AsyncIOTest, testing::Values(true, false),
+    [](const testing::TestParamInfo<bool>& info) { return info.param ? "IoUring" : "ThreadPool"; });
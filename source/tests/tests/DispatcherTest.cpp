@@ -0,0 +1,105 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+TEST(DispatcherTest, RunsInSubmissionOrder) {
+    Hazy::Dispatcher dispatcher;
+    std::vector<int> order;
+    for (int i = 0; i < 100; i++) {
+        dispatcher.Submit([&order, i] { order.push_back(i); });
+    }
+    EXPECT_EQ(dispatcher.getPendingCount(), 100u);
+    EXPECT_EQ(dispatcher.drain(), 100u);
+    EXPECT_EQ(dispatcher.getPendingCount(), 0u);
+    ASSERT_EQ(order.size(), 100u);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(order[i], i);
+    }
+    EXPECT_EQ(dispatcher.drain(), 0u);
+}
+
+TEST(DispatcherTest, MultipleProducers) {
+    constexpr int producerCount = 4;
+    constexpr int perProducer = 5000;
+    Hazy::Dispatcher dispatcher;
+    std::vector<std::vector<int>> received(producerCount);
+    std::atomic<int> finished = 0;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerCount; p++) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < perProducer; i++) {
+                dispatcher.Submit([&received, p, i] { received[p].push_back(i); });
+            }
+            finished++;
+        });
+    }
+
+    // 生产者还在投递的时候同时消费
+    while (finished.load() < producerCount) {
+        dispatcher.drain();
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    dispatcher.drain();
+
+    for (int p = 0; p < producerCount; p++) {
+        ASSERT_EQ(received[p].size(), static_cast<size_t>(perProducer));
+        for (int i = 0; i < perProducer; i++) {
+            EXPECT_EQ(received[p][i], i);
+        }
+    }
+}
+
+TEST(DispatcherTest, BudgetLeavesRemainder) {
+    Hazy::Dispatcher dispatcher;
+    int executed = 0;
+    for (int i = 0; i < 10; i++) {
+        dispatcher.Submit([&executed] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            executed++;
+        });
+    }
+
+    // 预算很小的时候也至少执行一个
+    size_t first = dispatcher.drain(std::chrono::microseconds(1));
+    EXPECT_EQ(first, 1u);
+    EXPECT_EQ(executed, 1);
+    EXPECT_EQ(dispatcher.getPendingCount(), 9u);
+
+    dispatcher.drain();
+    EXPECT_EQ(executed, 10);
+}
+
+TEST(DispatcherTest, ExecuteReturnsResult) {
+    Hazy::Dispatcher dispatcher;
+    auto value = dispatcher.Execute([] { return 42; });
+    auto failed = dispatcher.Execute([]() -> int { throw std::runtime_error("boom"); });
+    auto moved = dispatcher.Execute([data = std::make_unique<int>(7)] { return *data; });
+    EXPECT_FALSE(value.isReady());
+
+    std::thread consumer([&] { dispatcher.drain(); });
+    consumer.join();
+
+    EXPECT_EQ(value.get(), 42);
+    EXPECT_THROW(failed.get(), std::runtime_error);
+    EXPECT_EQ(moved.get(), 7);
+}
+
+TEST(DispatcherTest, DroppedFunctionsBreakTheirFutures) {
+    Hazy::PooledFuture<int> future;
+    {
+        Hazy::Dispatcher dispatcher;
+        future = dispatcher.Execute([] { return 1; });
+    }
+    EXPECT_THROW(future.get(), std::future_error);
+}
+
+TEST(DispatcherTest, ExceptionsDoNotStopDrain) {
+    Hazy::Dispatcher dispatcher;
+    bool after = false;
+    dispatcher.Submit([] { throw std::runtime_error("boom"); });
+    dispatcher.Submit([&after] { after = true; });
+    EXPECT_EQ(dispatcher.drain(), 2u);
+    EXPECT_TRUE(after);
+}
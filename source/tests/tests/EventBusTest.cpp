@@ -0,0 +1,130 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+    /**
+     * @brief 记录收到的事件，可以选择把事件标记为已处理
+     */
+    class RecordingListener : public Hazy::EventListener {
+    public:
+        RecordingListener(std::vector<std::string>& log, std::string name, bool handle = false)
+            : m_log(log), m_name(std::move(name)), m_handle(handle) { }
+
+        void onEvent(Hazy::Event& event) override {
+            m_log.push_back(m_name);
+            if (m_handle)
+                event.markDone();
+        }
+
+        bool isListening() const override { return m_listening; }
+
+        bool m_listening = true;
+
+    private:
+        std::vector<std::string>& m_log;
+        std::string m_name;
+        bool m_handle;
+    };
+
+    class RecordingLayer : public Hazy::Layer {
+    public:
+        RecordingLayer(std::vector<std::string>& log, std::string name) : Hazy::Layer(nullptr), m_log(log), m_name(std::move(name)) { }
+
+        void onEvent(Hazy::Event&) override { m_log.push_back(m_name); }
+
+    private:
+        std::vector<std::string>& m_log;
+        std::string m_name;
+    };
+
+    using Log = std::vector<std::string>;
+
+}
+
+TEST(EventBusTest, SubscribeByTypeAndCategory) {
+    Log log;
+    RecordingListener all(log, "all");
+    RecordingListener mouse(log, "mouse");
+    RecordingListener keyboard(log, "keyboard");
+    mouse.unsubscribeAll();
+    mouse.subscribe(Hazy::EventType::MouseMoved);
+    keyboard.unsubscribeAll();
+    keyboard.subscribe(Hazy::EventCategory::Keyboard);
+
+    Hazy::EventBus bus;
+    bus.attach(&all);
+    bus.attach(&mouse);
+    bus.attach(&keyboard);
+
+    Hazy::MouseMovedEvent moved(1.0f, 2.0f, nullptr);
+    EXPECT_FALSE(bus.publish(moved));
+    EXPECT_EQ(log, (Log { "all", "mouse" }));
+
+    log.clear();
+    Hazy::KeyPressedEvent key(Hazy::Key::A, 0, Hazy::ModifierKey::None, nullptr);
+    bus.publish(key);
+    EXPECT_EQ(log, (Log { "all", "keyboard" }));
+
+    // 修改订阅之后下一次分发生效
+    log.clear();
+    all.unsubscribe(Hazy::EventType::MouseScrolled);
+    mouse.subscribe(Hazy::EventType::MouseScrolled);
+    Hazy::MouseScrolledEvent scrolled(0.0f, 1.0f, nullptr);
+    bus.publish(scrolled);
+    EXPECT_EQ(log, (Log { "mouse" }));
+}
+
+TEST(EventBusTest, HandledEventsStopPropagating) {
+    Log log;
+    RecordingListener first(log, "first");
+    RecordingListener handler(log, "handler", true);
+    RecordingListener last(log, "last");
+
+    Hazy::EventBus bus;
+    bus.attach(&last);
+    bus.attach(&first, 0);
+    bus.attach(&handler, 1);
+
+    Hazy::WindowResizeEvent resize(800, 600, nullptr);
+    EXPECT_TRUE(bus.publish(resize));
+    EXPECT_EQ(log, (Log { "first", "handler" }));
+
+    // 已经处理过的事件不会再分发
+    log.clear();
+    EXPECT_TRUE(bus.publish(resize));
+    EXPECT_TRUE(log.empty());
+
+    // 不在接收事件的监听者会被跳过，卸载之后不再收到事件
+    log.clear();
+    handler.m_listening = false;
+    bus.detach(&first);
+    Hazy::WindowResizeEvent again(800, 600, nullptr);
+    EXPECT_FALSE(bus.publish(again));
+    EXPECT_EQ(log, (Log { "last" }));
+    EXPECT_EQ(bus.size(), 2u);
+}
+
+TEST(EventBusTest, LayerStackDispatchesToSubscribers) {
+    Log log;
+    Hazy::LayerStack stack;
+    auto* background = new RecordingLayer(log, "background");
+    auto* game = new RecordingLayer(log, "game");
+    auto* overlay = new RecordingLayer(log, "overlay");
+    stack.pushOverlay(overlay);
+    stack.pushLayer(background);
+    stack.pushLayer(game);
+
+    overlay->unsubscribeAll();
+    overlay->subscribe(Hazy::EventCategory::Mouse);
+
+    Hazy::KeyPressedEvent key(Hazy::Key::A, 0, Hazy::ModifierKey::None, nullptr);
+    stack.onEvent(key);
+    EXPECT_EQ(log, (Log { "game", "background" }));
+
+    log.clear();
+    game->disable();
+    Hazy::MouseMovedEvent moved(1.0f, 2.0f, nullptr);
+    stack.onEvent(moved);
+    EXPECT_EQ(log, (Log { "background", "overlay" }));
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+    class CustomEvent : public Hazy::Event {
+    public:
+        CustomEvent(int value) : Hazy::Event(nullptr), m_value(value) { }
+
+        inline int getValue() const { return m_value; }
+
+        static constexpr Hazy::EventType getStaticType() { return Hazy::EventType::AppUpdate; }
+        inline Hazy::EventType getType() const override { return Hazy::EventType::AppUpdate; }
+        inline Hazy::EventCategory getCategoryFlags() const override { return Hazy::EventCategory::Application; }
+
+    private:
+        int m_value;
+    };
+
+    // getStaticType() 不是 constexpr 的自定义事件
+    class RuntimeTypeEvent : public Hazy::Event {
+    public:
+        RuntimeTypeEvent() : Hazy::Event(nullptr) { }
+
+        inline static Hazy::EventType getStaticType() { return Hazy::EventType::AppTick; }
+        inline Hazy::EventType getType() const override { return Hazy::EventType::AppTick; }
+        inline Hazy::EventCategory getCategoryFlags() const override { return Hazy::EventCategory::Application; }
+    };
+
+    /**
+     * @brief 一个处理三种事件的分发，返回被调用的处理方法的序号，没有处理方法被调用时返回-1
+     */
+    int DispatchAll(Hazy::Event& event, bool result) {
+        int called = -1;
+        Hazy::EventDispatcher(event).dispatch<Hazy::WindowResizeEvent, Hazy::MouseMovedEvent, CustomEvent>(
+            [&](Hazy::WindowResizeEvent& e) { called = 0; EXPECT_EQ(e.getWidth(), 800u); return result; },
+            [&](Hazy::MouseMovedEvent& e) { called = 1; EXPECT_EQ(e.getX(), 3.0f); return result; },
+            [&](CustomEvent& e) { called = 2; EXPECT_EQ(e.getValue(), 42); return result; });
+        return called;
+    }
+
+}
+
+TEST(EventDispatcherTest, RoutesByType) {
+    Hazy::WindowResizeEvent resize(800, 600, nullptr);
+    Hazy::MouseMovedEvent moved(3.0f, 4.0f, nullptr);
+    CustomEvent custom(42);
+    Hazy::KeyPressedEvent key(Hazy::Key::A, 0, Hazy::ModifierKey::None, nullptr);
+
+    EXPECT_EQ(DispatchAll(resize, true), 0);
+    EXPECT_EQ(DispatchAll(moved, false), 1);
+    EXPECT_EQ(DispatchAll(custom, true), 2);
+    EXPECT_EQ(DispatchAll(key, true), -1);
+
+    EXPECT_TRUE(resize.isHandled());
+    EXPECT_FALSE(moved.isHandled());    // 处理方法返回 false，事件继续传播
+    EXPECT_TRUE(custom.isHandled());
+    EXPECT_FALSE(key.isHandled());
+}
+
+TEST(EventDispatcherTest, HandledEventsAreSkipped) {
+    Hazy::MouseMovedEvent moved(3.0f, 4.0f, nullptr);
+    moved.markDone();
+    EXPECT_EQ(DispatchAll(moved, true), -1);
+    EXPECT_TRUE(Hazy::EventDispatcher(moved).dispatch<Hazy::MouseMovedEvent>([](Hazy::MouseMovedEvent&) { return false; }));
+}
+
+TEST(EventDispatcherTest, FunctionObjectsAndPointers) {
+    struct Counter {
+        int* count;
+        bool operator()(Hazy::MouseScrolledEvent& e) const { *count += static_cast<int>(e.getYOffset()); return true; }
+    };
+    int count = 0;
+    Hazy::MouseScrolledEvent scrolled(0.0f, 2.0f, nullptr);
+    bool (*never)(Hazy::KeyReleasedEvent&) = [](Hazy::KeyReleasedEvent&) { return true; };
+
+    EXPECT_TRUE((Hazy::EventDispatcher(scrolled).dispatch<Hazy::KeyReleasedEvent, Hazy::MouseScrolledEvent>(never, Counter { &count })));
+    EXPECT_EQ(count, 2);
+
+    // 原来的 std::function 版本仍然可以使用
+    Hazy::MouseScrolledEvent again(0.0f, 1.0f, nullptr);
+    std::function<bool(Hazy::MouseScrolledEvent&)> handler = Counter { &count };
+    EXPECT_TRUE(Hazy::EventDispatcher(again).dispatch<Hazy::MouseScrolledEvent>(handler));
+    EXPECT_EQ(count, 3);
+}
+
+TEST(EventDispatcherTest, NonConstexprStaticType) {
+    // 不能生成跳转表的事件类型用 lambda 分发时，退回到 std::function 版本
+    static_assert(!Hazy::StaticEventType<RuntimeTypeEvent>);
+    static_assert(Hazy::StaticEventType<CustomEvent>);
+    RuntimeTypeEvent event;
+    bool called = false;
+    EXPECT_TRUE(Hazy::EventDispatcher(event).dispatch<RuntimeTypeEvent>([&](RuntimeTypeEvent&) { called = true; return true; }));
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(event.isHandled());
+}
\ No newline at end of file
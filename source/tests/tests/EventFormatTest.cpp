@@ -0,0 +1,75 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+    /**
+     * @brief 自定义事件只需要重写 formatTo()
+     */
+    class CustomEvent : public Hazy::Event {
+    public:
+        explicit CustomEvent(int value) : Hazy::Event(nullptr), m_value(value) { }
+        Hazy::EventType getType() const override { return Hazy::EventType::AppUpdate; }
+        Hazy::EventCategory getCategoryFlags() const override { return Hazy::EventCategory::Application; }
+        fmt::format_context::iterator formatTo(fmt::format_context::iterator out) const override {
+            return fmt::format_to(out, "CustomEvent -- value: {}", m_value);
+        }
+
+    private:
+        int m_value;
+    };
+
+    /**
+     * @brief 没有重写 formatTo() 的自定义事件
+     */
+    class PlainEvent : public Hazy::Event {
+    public:
+        PlainEvent() : Hazy::Event(nullptr) { }
+        Hazy::EventType getType() const override { return Hazy::EventType::AppTick; }
+        Hazy::EventCategory getCategoryFlags() const override { return Hazy::EventCategory::Application; }
+    };
+
+}
+
+TEST(EventFormatTest, BuiltInEvents)
+{
+    EXPECT_EQ(fmt::format("{}", Hazy::MouseMovedEvent(1.5f, 2.0f, nullptr)), "MouseMovedEvent -- X: 1.5 Y: 2 window: null");
+    EXPECT_EQ(fmt::format("{}", Hazy::MouseScrolledEvent(0.0f, -1.0f, nullptr)), "MouseScrolledEvent -- XOffset: 0 YOffset: -1 window: null");
+    EXPECT_EQ(fmt::format("{}", Hazy::MouseButtonPressedEvent(Hazy::MouseButton::Left, Hazy::ModifierKey::Shift, nullptr)),
+        "MouseButtonPressedEvent -- Button: Left Mod: Shift window: null");
+    EXPECT_EQ(fmt::format("{}", Hazy::KeyPressedEvent(Hazy::Key::A, 0, Hazy::ModifierKey::None, nullptr)), "KeyPressedEvent -- Key: A Mod: None window: null");
+    EXPECT_EQ(fmt::format("{}", Hazy::KeyPressedEvent(Hazy::Key::Space, 2, Hazy::ModifierKey::Control, nullptr)),
+        "KeyPressedEvent -- RepeatCount: 2 Key: Space Mod: Control window: null");
+    EXPECT_EQ(fmt::format("{}", Hazy::KeyReleasedEvent(Hazy::Key::Esc, Hazy::ModifierKey::None, nullptr)), "KeyReleasedEvent -- Key: Escape Mod: None window: null");
+    EXPECT_EQ(fmt::format("{}", Hazy::WindowResizeEvent(800, 600, nullptr)), "WindowResizeEvent -- Window: null width: 800 height: 600");
+    EXPECT_EQ(fmt::format("{}", Hazy::WindowMovedEvent(-10, 20, nullptr)), "WindowMovedEvent -- Window: null x: -10 y: 20");
+    EXPECT_EQ(fmt::format("{}", Hazy::WindowCloseEvent(nullptr)), "WindowCloseEvent -- Window: null");
+
+    // 通过基类的引用格式化时调用的是派生类的 formatTo()
+    Hazy::WindowFocusEvent focus(nullptr);
+    const Hazy::Event& event = focus;
+    EXPECT_EQ(fmt::format("{}", event), "WindowFocusEvent -- Window: null");
+    EXPECT_EQ(event.toString(), "WindowFocusEvent -- Window: null");
+}
+
+TEST(EventFormatTest, CustomEventsAndEnums)
+{
+    EXPECT_EQ(fmt::format("{}", CustomEvent(42)), "CustomEvent -- value: 42");
+    EXPECT_EQ(CustomEvent(7).toString(), "CustomEvent -- value: 7");
+    EXPECT_EQ(fmt::format("{}", PlainEvent()), "AppTickEvent -- window: null");
+
+    EXPECT_EQ(fmt::format("{}", Hazy::Key::F12), "F12");
+    EXPECT_EQ(fmt::format("[{:>6}]", Hazy::MouseButton::Right), "[ Right]");
+    EXPECT_EQ(fmt::format("{}", Hazy::ModifierKey::Alt), "Alt");
+}
+
+TEST(EventFormatTest, FormatIntoBuffer)
+{
+    // 事件直接写入调用者的缓冲区，和 Logger 一样
+    fmt::memory_buffer buffer;
+    Hazy::MouseMovedEvent moved(3.0f, 4.0f, nullptr);
+    fmt::format_to(fmt::appender(buffer), "event: {} / {}", moved, Hazy::KeyReleasedEvent(Hazy::Key::B, Hazy::ModifierKey::None, nullptr));
+    EXPECT_EQ(fmt::to_string(buffer), "event: MouseMovedEvent -- X: 3 Y: 4 window: null / KeyReleasedEvent -- Key: B Mod: None window: null");
+
+    Hazy::Logger::LogInfo("{}", moved);
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+    /**
+     * @brief 原来的事件队列：事件在堆上分配，放进 std::queue，每投递或者取出一个事件都要加锁
+     */
+    class MutexEventQueue {
+    public:
+        void push(Hazy::Ref<Hazy::Event> event) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.emplace(std::move(event));
+        }
+
+        std::optional<Hazy::Ref<Hazy::Event>> poll() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_queue.empty())
+                return std::nullopt;
+            Hazy::Ref<Hazy::Event> front = std::move(m_queue.front());
+            m_queue.pop();
+            return front;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::queue<Hazy::Ref<Hazy::Event>> m_queue;
+    };
+
+    /**
+     * @brief producerCount 个线程一共投递 totalEvents 个事件，当前线程作为唯一的消费者把它们全部取出
+     * @param poll 取出事件，返回这一次取出了多少个事件
+     * @return double 吞吐量，单位为百万事件每秒
+     */
+    template <typename Push, typename Poll>
+    double Throughput(int producerCount, int totalEvents, Push push, Poll poll) {
+        const int eventsPerProducer = totalEvents / producerCount;
+        std::atomic<bool> start = false;
+        std::vector<std::thread> producers;
+        for (int i = 0; i < producerCount; i++) {
+            producers.emplace_back(
+                [&] {
+                    while (!start.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    for (int j = 0; j < eventsPerProducer; j++) {
+                        push(static_cast<float>(j));
+                    }
+                });
+        }
+
+        const int expected = eventsPerProducer * producerCount;
+        size_t received = 0;
+        auto begin = std::chrono::steady_clock::now();
+        start.store(true, std::memory_order_release);
+        while (received < static_cast<size_t>(expected)) {
+            size_t count = poll();
+            if (count == 0)
+                std::this_thread::yield();
+            received += count;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        return expected / seconds / 1e6;
+    }
+
+}
+
+TEST(EventQueueBenchmark, ProducerThroughput) {
+    constexpr int totalEvents = 1 << 20;
+
+    // 生产者比消费者快的时候等待而不是丢弃，保证两边处理的事件数量相同
+    // 等待需要知道消费者是哪个线程，所以先在当前线程上取一次事件
+    Hazy::EventQueue::setOverflowPolicy(Hazy::EventQueue::OverflowPolicy::Block);
+    Hazy::EventQueue::pollEvent();
+    Hazy::Logger::LogInfo("EventQueue: {} MouseMovedEvent, single consumer", totalEvents);
+    for (int producers : { 1, 4, 16 }) {
+        MutexEventQueue mutexQueue;
+        double locked = Throughput(producers, totalEvents,
+            [&](float x) { mutexQueue.push(Hazy::Ref<Hazy::Event>(new Hazy::MouseMovedEvent(x, 0.0f, nullptr))); },
+            [&] { return mutexQueue.poll().has_value() ? 1u : 0u; });
+        double lockFree = Throughput(producers, totalEvents,
+            [](float x) { Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(x, 0.0f, nullptr); },
+            [] { return Hazy::EventQueue::pollEvent() ? 1u : 0u; });
+        double batched = Throughput(producers, totalEvents,
+            [](float x) { Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(x, 0.0f, nullptr); },
+            [] { return Hazy::EventQueue::drain().size(); });
+        Hazy::Logger::LogInfo("|> {:>2} producers  mutex {:>6.2f} M/s  lock-free ring {:>6.2f} M/s ({:>5.2f}x)  batched drain {:>6.2f} M/s ({:>5.2f}x)",
+            producers, locked, lockFree, lockFree / locked, batched, batched / locked);
+    }
+    Hazy::EventQueue::setOverflowPolicy(Hazy::EventQueue::OverflowPolicy::DropNewest);
+
+    EXPECT_TRUE(Hazy::EventQueue::isEmpty());
+    EXPECT_EQ(Hazy::EventQueue::getDroppedCount(), 0);
+}
\ No newline at end of file
@@ -7,8 +7,8 @@ TEST(EventQueueTest, EmplaceEventTest)
     Hazy::EventQueue::emplaceEvent<Hazy::KeyPressedEvent>(Hazy::Key::A, 0, Hazy::ModifierKey::None, nullptr);
     while (true) {
         auto event = Hazy::EventQueue::pollEvent();
-        if (event.has_value()) {
-            Hazy::Logger::LogInfo("{}", static_cast<int>(event.value()->getType()));
+        if (event) {
+            Hazy::Logger::LogInfo("{}", static_cast<int>(event->getType()));
         }
         else {
             break;
@@ -42,11 +42,11 @@ TEST(EventQueueTest, MultiThreadTest)
     int mouseMoveCount = 0;
     while (true) {
         auto event = Hazy::EventQueue::pollEvent();
-        if (event.has_value()) {
-            if (event.value()->getType() == Hazy::EventType::WindowLostFocus) {
+        if (event) {
+            if (event->getType() == Hazy::EventType::WindowLostFocus) {
                 windowLostFocusCount++;
             }
-            else if (event.value()->getType() == Hazy::EventType::MouseMoved) {
+            else if (event->getType() == Hazy::EventType::MouseMoved) {
                 mouseMoveCount++;
             }
         }
@@ -87,32 +87,318 @@ TEST(EventQueueTest, ThreadPoolAndEventQueueTest) {
     EXPECT_EQ(futures.size(), 30);
     futures.clear();
 
-    std::mutex window_mutex;
     int windowLostFocusCount = 0;
-    std::mutex mouse_mutex;
     int mouseMoveCount = 0;
 
-    for (int i = 0; i < 30; i++) {
-        pool.Execute(
-            [&]() {
+    // 事件队列只有一个消费者，在同一个任务中取出所有事件
+    pool.Execute(
+        [&]() {
+            while (true) {
                 auto event = Hazy::EventQueue::pollEvent();
-                if (event.has_value()) {
-                    if (event.value()->getType() == Hazy::EventType::WindowLostFocus) {
-                        std::lock_guard<std::mutex> lock(window_mutex);
-                        windowLostFocusCount++;
-                    }
-                    else if (event.value()->getType() == Hazy::EventType::MouseMoved) {
-                        std::lock_guard<std::mutex> lock(mouse_mutex);
-                        mouseMoveCount++;
-                    }
+                if (!event)
+                    break;
+                if (event->getType() == Hazy::EventType::WindowLostFocus) {
+                    windowLostFocusCount++;
+                }
+                else if (event->getType() == Hazy::EventType::MouseMoved) {
+                    mouseMoveCount++;
                 }
             }
-        );
-    }
+        }
+    ).wait();
 
     Hazy::Logger::LogCritical("{}", windowLostFocusCount);
     Hazy::Logger::LogCritical("{}", mouseMoveCount);
 
     EXPECT_EQ(windowLostFocusCount, 10);
     EXPECT_EQ(mouseMoveCount, 20);
+}
+
+TEST(EventQueueTest, DropNewestOnOverflow)
+{
+    Hazy::EventQueue::setOverflowPolicy(Hazy::EventQueue::OverflowPolicy::DropNewest);
+    size_t droppedBefore = Hazy::EventQueue::getDroppedCount();
+    for (size_t i = 0; i < Hazy::EventQueue::s_capacity + 10; i++) {
+        Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(i), 0.0f, nullptr);
+    }
+    EXPECT_EQ(Hazy::EventQueue::getDroppedCount() - droppedBefore, 10);
+
+    // 留在队列中的是最早的那些事件
+    size_t count = 0;
+    while (auto event = Hazy::EventQueue::pollEvent()) {
+        EXPECT_EQ(static_cast<Hazy::MouseMovedEvent&>(*event).getX(), static_cast<float>(count));
+        count++;
+    }
+    EXPECT_EQ(count, Hazy::EventQueue::s_capacity);
+}
+
+TEST(EventQueueTest, BlockOnOverflow)
+{
+    Hazy::EventQueue::setOverflowPolicy(Hazy::EventQueue::OverflowPolicy::Block);
+    EXPECT_TRUE(Hazy::EventQueue::pollEvent().empty());    // 让当前线程成为消费者
+
+    constexpr size_t total = Hazy::EventQueue::s_capacity * 3;
+    size_t droppedBefore = Hazy::EventQueue::getDroppedCount();
+    std::thread producer(
+        [] {
+            for (size_t i = 0; i < total; i++) {
+                Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(i), 0.0f, nullptr);
+            }
+        });
+
+    size_t count = 0;
+    while (count < total) {
+        auto event = Hazy::EventQueue::pollEvent();
+        if (!event) {
+            std::this_thread::yield();
+            continue;
+        }
+        EXPECT_EQ(static_cast<Hazy::MouseMovedEvent&>(*event).getX(), static_cast<float>(count));
+        count++;
+    }
+    producer.join();
+
+    EXPECT_EQ(Hazy::EventQueue::getDroppedCount(), droppedBefore);
+    EXPECT_TRUE(Hazy::EventQueue::isEmpty());
+    Hazy::EventQueue::setOverflowPolicy(Hazy::EventQueue::OverflowPolicy::DropNewest);
+}
+
+namespace {
+
+    /**
+     * @brief 放不进 EventSlot 内部的自定义事件，记录自己被销毁了多少次
+     */
+    template <size_t PayloadSize>
+    class PayloadEvent : public Hazy::Event {
+    public:
+        PayloadEvent(int value, std::atomic<int>& destroyed) : Hazy::Event(nullptr), m_value(value), m_destroyed(&destroyed) {
+            m_payload.fill(static_cast<char>(value));
+        }
+        PayloadEvent(PayloadEvent&& other) noexcept
+            : Hazy::Event(std::move(other)), m_value(other.m_value), m_payload(other.m_payload), m_destroyed(std::exchange(other.m_destroyed, nullptr)) { }
+        ~PayloadEvent() {
+            if (m_destroyed != nullptr)
+                m_destroyed->fetch_add(1);
+        }
+
+        inline int getValue() const { return m_value; }
+        inline char getPayload(size_t index) const { return m_payload[index]; }
+
+        inline static Hazy::EventType getStaticType() { return Hazy::EventType::AppUpdate; }
+        inline Hazy::EventType getType() const override { return Hazy::EventType::AppUpdate; }
+        inline Hazy::EventCategory getCategoryFlags() const override { return Hazy::EventCategory::Application; }
+
+    private:
+        int m_value;
+        std::array<char, PayloadSize> m_payload;
+        std::atomic<int>* m_destroyed;
+    };
+
+}
+
+TEST(EventQueueTest, LargeCustomEvents)
+{
+    using PooledEvent = PayloadEvent<128>;     // 放在大块对象池中
+    using HeapEvent = PayloadEvent<1024>;      // 超过了对象池的块大小，在堆上分配
+    static_assert(sizeof(PooledEvent) > Hazy::EventSlot::s_inlineSize && sizeof(PooledEvent) <= Hazy::EventSlot::s_largeSize);
+    static_assert(sizeof(HeapEvent) > Hazy::EventSlot::s_largeSize);
+
+    std::atomic<int> destroyed = 0;
+    for (int i = 0; i < 8; i++) {
+        Hazy::EventQueue::emplaceEvent<PooledEvent>(i, destroyed);
+        Hazy::EventQueue::emplaceEvent<HeapEvent>(i, destroyed);
+        Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(i), 0.0f, nullptr);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        auto pooled = Hazy::EventQueue::pollEvent();
+        ASSERT_TRUE(pooled);
+        EXPECT_EQ(static_cast<PooledEvent&>(*pooled).getValue(), i);
+        EXPECT_EQ(static_cast<PooledEvent&>(*pooled).getPayload(127), static_cast<char>(i));
+
+        auto heap = Hazy::EventQueue::pollEvent();
+        ASSERT_TRUE(heap);
+        EXPECT_EQ(static_cast<HeapEvent&>(*heap).getPayload(1023), static_cast<char>(i));
+
+        auto moved = Hazy::EventQueue::pollEvent();
+        ASSERT_TRUE(moved);
+        EXPECT_EQ(moved->getType(), Hazy::EventType::MouseMoved);
+    }
+    EXPECT_TRUE(Hazy::EventQueue::isEmpty());
+    EXPECT_EQ(destroyed.load(), 16);
+}
+
+TEST(EventQueueTest, CoalesceAdjacentEvents)
+{
+    // 事件队列只比较窗口指针，不会访问窗口，用两个不同的地址代表两个窗口
+    std::array<std::byte, 2> windows;
+    Hazy::Window* first = reinterpret_cast<Hazy::Window*>(&windows[0]);
+    Hazy::Window* second = reinterpret_cast<Hazy::Window*>(&windows[1]);
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::MouseMoved, true);
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::MouseScrolled, true);
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::WindowResize, true);
+    size_t coalescedBefore = Hazy::EventQueue::getCoalescedCount();
+
+    for (int i = 1; i <= 100; i++) {
+        Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(i), 0.0f, first);
+    }
+    Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(-1.0f, 0.0f, second);     // 其他窗口的事件不会被合并进来
+    Hazy::EventQueue::emplaceEvent<Hazy::MouseButtonPressedEvent>(Hazy::MouseButton::Left, Hazy::ModifierKey::None, first);
+    Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(200.0f, 0.0f, first);     // 按键之后的移动保持在按键之后
+    for (int i = 0; i < 10; i++) {
+        Hazy::EventQueue::emplaceEvent<Hazy::MouseScrolledEvent>(0.5f, 1.0f, first);
+    }
+    for (unsigned int i = 1; i <= 10; i++) {
+        Hazy::EventQueue::emplaceEvent<Hazy::WindowResizeEvent>(i * 100, i * 50, first);
+    }
+
+    auto moved = Hazy::EventQueue::pollEvent();
+    ASSERT_TRUE(moved);
+    EXPECT_EQ(static_cast<Hazy::MouseMovedEvent&>(*moved).getX(), 100.0f);
+    EXPECT_EQ(moved->getWindow(), first);
+
+    auto other = Hazy::EventQueue::pollEvent();
+    ASSERT_TRUE(other);
+    EXPECT_EQ(other->getWindow(), second);
+
+    auto pressed = Hazy::EventQueue::pollEvent();
+    ASSERT_TRUE(pressed);
+    EXPECT_EQ(pressed->getType(), Hazy::EventType::MouseButtonPressed);
+
+    auto movedAfter = Hazy::EventQueue::pollEvent();
+    ASSERT_TRUE(movedAfter);
+    EXPECT_EQ(static_cast<Hazy::MouseMovedEvent&>(*movedAfter).getX(), 200.0f);
+
+    auto scrolled = Hazy::EventQueue::pollEvent();
+    ASSERT_TRUE(scrolled);
+    EXPECT_FLOAT_EQ(static_cast<Hazy::MouseScrolledEvent&>(*scrolled).getXOffset(), 5.0f);
+    EXPECT_FLOAT_EQ(static_cast<Hazy::MouseScrolledEvent&>(*scrolled).getYOffset(), 10.0f);
+
+    auto resized = Hazy::EventQueue::pollEvent();
+    ASSERT_TRUE(resized);
+    EXPECT_EQ(static_cast<Hazy::WindowResizeEvent&>(*resized).getWidth(), 1000u);
+    EXPECT_EQ(static_cast<Hazy::WindowResizeEvent&>(*resized).getHeight(), 500u);
+
+    EXPECT_TRUE(Hazy::EventQueue::pollEvent().empty());
+    EXPECT_EQ(Hazy::EventQueue::getCoalescedCount() - coalescedBefore, 99u + 9u + 9u);
+
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::MouseMoved, false);
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::MouseScrolled, false);
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::WindowResize, false);
+
+    // 关闭之后每一个事件都会被单独取出
+    for (int i = 0; i < 3; i++) {
+        Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(i), 0.0f, first);
+    }
+    int count = 0;
+    while (Hazy::EventQueue::pollEvent()) {
+        count++;
+    }
+    EXPECT_EQ(count, 3);
+
+    EXPECT_THROW(Hazy::EventQueue::setCoalescing(Hazy::EventType::KeyPressed, true), std::invalid_argument);
+}
+
+TEST(EventQueueTest, DrainBatch)
+{
+    EXPECT_TRUE(Hazy::EventQueue::drain().empty());
+
+    for (int i = 0; i < 100; i++) {
+        Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(i), 0.0f, nullptr);
+        Hazy::EventQueue::emplaceEvent<Hazy::KeyPressedEvent>(Hazy::Key::A, i, Hazy::ModifierKey::None, nullptr);
+    }
+
+    std::span<Hazy::EventSlot> batch = Hazy::EventQueue::drain();
+    ASSERT_EQ(batch.size(), 200u);
+    EXPECT_TRUE(Hazy::EventQueue::isEmpty());
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(static_cast<Hazy::MouseMovedEvent&>(*batch[i * 2]).getX(), static_cast<float>(i));
+        EXPECT_EQ(static_cast<Hazy::KeyPressedEvent&>(*batch[i * 2 + 1]).getRepeatCount(), i);
+    }
+
+    // 处理这一批的时候投递的事件留到下一批
+    Hazy::EventQueue::emplaceEvent<Hazy::WindowFocusEvent>(nullptr);
+    EXPECT_EQ(batch.size(), 200u);
+    batch = Hazy::EventQueue::drain();
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_EQ(batch[0]->getType(), Hazy::EventType::WindowFocus);
+
+    // 合并同样适用于整批取出
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::MouseScrolled, true);
+    for (int i = 0; i < 50; i++) {
+        Hazy::EventQueue::emplaceEvent<Hazy::MouseScrolledEvent>(0.0f, 1.0f, nullptr);
+    }
+    batch = Hazy::EventQueue::drain();
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_FLOAT_EQ(static_cast<Hazy::MouseScrolledEvent&>(*batch[0]).getYOffset(), 50.0f);
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::MouseScrolled, false);
+
+    EXPECT_TRUE(Hazy::EventQueue::drain().empty());
+}
+
+TEST(EventQueueTest, DrainWhileProducing)
+{
+    constexpr int producerCount = 4;
+    constexpr int eventsPerProducer = 20000;
+    Hazy::EventQueue::setOverflowPolicy(Hazy::EventQueue::OverflowPolicy::Block);
+    Hazy::EventQueue::drain();  // 让当前线程成为消费者
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerCount; p++) {
+        producers.emplace_back(
+            [p] {
+                for (int i = 0; i < eventsPerProducer; i++) {
+                    Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(p), static_cast<float>(i), nullptr);
+                }
+            });
+    }
+
+    // 每一个生产者的事件在每一批中都保持投递的顺序
+    std::array<int, producerCount> next {};
+    int received = 0;
+    while (received < producerCount * eventsPerProducer) {
+        for (Hazy::EventSlot& slot : Hazy::EventQueue::drain()) {
+            auto& moved = static_cast<Hazy::MouseMovedEvent&>(*slot);
+            int producer = static_cast<int>(moved.getX());
+            EXPECT_EQ(static_cast<int>(moved.getY()), next[producer]);
+            next[producer]++;
+            received++;
+        }
+        std::this_thread::yield();
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    Hazy::EventQueue::setOverflowPolicy(Hazy::EventQueue::OverflowPolicy::DropNewest);
+    EXPECT_TRUE(Hazy::EventQueue::drain().empty());
+}
+
+TEST(EventQueueTest, Timestamps)
+{
+    using namespace std::chrono_literals;
+    Hazy::EventClock::time_point before = Hazy::EventClock::now();
+    Hazy::EventQueue::emplaceEvent<Hazy::KeyPressedEvent>(Hazy::Key::A, 0, Hazy::ModifierKey::None, nullptr);
+    std::this_thread::sleep_for(1ms);
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::MouseMoved, true);
+    Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(1.0f, 0.0f, nullptr);
+    Hazy::EventClock::time_point firstMove = Hazy::EventClock::now();
+    std::this_thread::sleep_for(1ms);
+    Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(2.0f, 0.0f, nullptr);
+    Hazy::EventClock::time_point beforeDrain = Hazy::EventClock::now();
+
+    std::span<Hazy::EventSlot> batch = Hazy::EventQueue::drain();
+    ASSERT_EQ(batch.size(), 2u);
+    const Hazy::EventTimestamps& key = batch[0]->getTimestamps();
+    EXPECT_GE(key.queued, before);
+    EXPECT_LT(key.queued, firstMove);
+    EXPECT_GE(key.dequeued, beforeDrain);
+
+    // 合并之后保留最早的投递时间
+    const Hazy::EventTimestamps& moved = batch[1]->getTimestamps();
+    EXPECT_EQ(static_cast<Hazy::MouseMovedEvent&>(*batch[1]).getX(), 2.0f);
+    EXPECT_LE(moved.queued, firstMove);
+    EXPECT_GT(moved.queued, key.queued);
+    EXPECT_EQ(moved.dequeued, key.dequeued);
+    EXPECT_EQ(moved.dispatched, Hazy::EventClock::time_point {});
+    Hazy::EventQueue::setCoalescing(Hazy::EventType::MouseMoved, false);
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+
+namespace {
+
+    std::string TempPath(const std::string& name) {
+        return (std::filesystem::temp_directory_path() / ("HazyEventRecorderTest_" + name)).string();
+    }
+
+    /**
+     * @brief 录制时的帧数据的回放结果
+     */
+    struct Replayed {
+        std::vector<Hazy::EventType> types;
+        std::vector<std::string> details;
+    };
+
+    Replayed ReplayFrame(Hazy::EventReplay& replay, uint64_t frame) {
+        Replayed replayed;
+        replay.replayFrame(frame,
+            [&](Hazy::Event& event) {
+                replayed.types.push_back(event.getType());
+                switch (event.getType()) {
+                case Hazy::EventType::MouseMoved: {
+                    auto& moved = static_cast<Hazy::MouseMovedEvent&>(event);
+                    replayed.details.push_back(std::to_string(moved.getX()) + "," + std::to_string(moved.getY()));
+                    break;
+                }
+                case Hazy::EventType::KeyPressed: {
+                    auto& pressed = static_cast<Hazy::KeyPressedEvent&>(event);
+                    replayed.details.push_back(std::to_string(static_cast<int>(pressed.getKey())) + "," + std::to_string(pressed.getRepeatCount())
+                        + "," + std::to_string(static_cast<int>(pressed.getMod())));
+                    break;
+                }
+                case Hazy::EventType::WindowResize: {
+                    auto& resize = static_cast<Hazy::WindowResizeEvent&>(event);
+                    replayed.details.push_back(std::to_string(resize.getWidth()) + "x" + std::to_string(resize.getHeight()));
+                    break;
+                }
+                case Hazy::EventType::WindowMoved: {
+                    auto& moved = static_cast<Hazy::WindowMovedEvent&>(event);
+                    replayed.details.push_back(std::to_string(moved.getX()) + "," + std::to_string(moved.getY()));
+                    break;
+                }
+                case Hazy::EventType::MouseButtonReleased: {
+                    auto& released = static_cast<Hazy::MouseButtonReleasedEvent&>(event);
+                    replayed.details.push_back(std::to_string(static_cast<int>(released.getMouseButton())));
+                    break;
+                }
+                default:
+                    replayed.details.push_back("");
+                    break;
+                }
+                EXPECT_EQ(event.getWindow(), nullptr);
+            });
+        return replayed;
+    }
+
+    /**
+     * @brief 不能录制的自定义事件
+     */
+    class CustomEvent : public Hazy::Event {
+    public:
+        CustomEvent() : Hazy::Event(nullptr) { }
+        Hazy::EventType getType() const override { return Hazy::EventType::AppTick; }
+        Hazy::EventCategory getCategoryFlags() const override { return Hazy::EventCategory::Application; }
+    };
+
+}
+
+TEST(EventRecorderTest, RecordAndReplayFrames)
+{
+    const std::string path = TempPath("frames.bin");
+    {
+        Hazy::EventRecorder recorder(path, 100);
+        EXPECT_TRUE(recorder.record(Hazy::MouseMovedEvent(1.5f, -2.0f, nullptr), 100));
+        EXPECT_TRUE(recorder.record(Hazy::KeyPressedEvent(Hazy::Key::A, 3, Hazy::ModifierKey::Shift, nullptr), 100));
+        EXPECT_TRUE(recorder.record(Hazy::WindowResizeEvent(1920, 1080, nullptr), 101));
+        EXPECT_FALSE(recorder.record(CustomEvent(), 101));
+        EXPECT_TRUE(recorder.record(Hazy::WindowMovedEvent(-40, 30, nullptr), 103));
+        EXPECT_TRUE(recorder.record(Hazy::MouseButtonReleasedEvent(Hazy::MouseButton::Right, Hazy::ModifierKey::None, nullptr), 103));
+        EXPECT_TRUE(recorder.record(Hazy::WindowCloseEvent(nullptr), 103));
+        EXPECT_EQ(recorder.getRecordedCount(), 6u);
+        EXPECT_EQ(recorder.getSkippedCount(), 1u);
+    }
+
+    // 每个事件只占十几个字节
+    EXPECT_LT(std::filesystem::file_size(path), 6u * 16u);
+
+    Hazy::EventReplay replay(path);
+    EXPECT_EQ(replay.getEventCount(), 6u);
+    EXPECT_EQ(replay.getFrameCount(), 4u);
+
+    Replayed frame0 = ReplayFrame(replay, 0);
+    EXPECT_EQ(frame0.types, (std::vector { Hazy::EventType::MouseMoved, Hazy::EventType::KeyPressed }));
+    EXPECT_EQ(frame0.details[0], std::to_string(1.5f) + "," + std::to_string(-2.0f));
+    EXPECT_EQ(frame0.details[1], std::to_string(static_cast<int>(Hazy::Key::A)) + ",3," + std::to_string(static_cast<int>(Hazy::ModifierKey::Shift)));
+
+    Replayed frame1 = ReplayFrame(replay, 1);
+    EXPECT_EQ(frame1.types, (std::vector { Hazy::EventType::WindowResize }));
+    EXPECT_EQ(frame1.details[0], "1920x1080");
+
+    EXPECT_TRUE(ReplayFrame(replay, 2).types.empty());
+    EXPECT_FALSE(replay.isFinished());
+
+    Replayed frame3 = ReplayFrame(replay, 3);
+    EXPECT_EQ(frame3.types, (std::vector { Hazy::EventType::WindowMoved, Hazy::EventType::MouseButtonReleased, Hazy::EventType::WindowClose }));
+    EXPECT_EQ(frame3.details[0], "-40,30");
+    EXPECT_EQ(frame3.details[1], std::to_string(static_cast<int>(Hazy::MouseButton::Right)));
+    EXPECT_TRUE(replay.isFinished());
+
+    std::filesystem::remove(path);
+}
+
+TEST(EventRecorderTest, RecordsQueuedEvents)
+{
+    const std::string path = TempPath("queue.bin");
+    constexpr int frames = 50;
+    {
+        Hazy::EventRecorder recorder(path);
+        for (int frame = 0; frame < frames; frame++) {
+            for (int i = 0; i <= frame % 3; i++) {
+                Hazy::EventQueue::emplaceEvent<Hazy::MouseMovedEvent>(static_cast<float>(frame), static_cast<float>(i), nullptr);
+            }
+            for (Hazy::EventSlot& slot : Hazy::EventQueue::drain()) {
+                recorder.record(*slot, frame);
+            }
+        }
+    }
+
+    // 回放出来的事件和录制时逐帧相同，录制的投递时间单调递增
+    Hazy::EventReplay replay(path);
+    std::chrono::nanoseconds last { -1 };
+    for (int frame = 0; frame < frames; frame++) {
+        int count = 0;
+        replay.replayFrame(frame,
+            [&](Hazy::Event& event) {
+                auto& moved = static_cast<Hazy::MouseMovedEvent&>(event);
+                EXPECT_EQ(moved.getX(), static_cast<float>(frame));
+                EXPECT_EQ(moved.getY(), static_cast<float>(count));
+                EXPECT_GE(replay.getRecordedTime(), last);
+                last = replay.getRecordedTime();
+                count++;
+            });
+        EXPECT_EQ(count, frame % 3 + 1);
+    }
+    EXPECT_TRUE(replay.isFinished());
+
+    std::filesystem::remove(path);
+}
+
+TEST(EventRecorderTest, RejectsInvalidFiles)
+{
+    EXPECT_THROW(Hazy::EventReplay(TempPath("missing.bin")), std::runtime_error);
+
+    const std::string path = TempPath("invalid.bin");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "not a recording";
+    }
+    EXPECT_THROW(Hazy::EventReplay { path }, std::runtime_error);
+
+    // 截断的文件
+    {
+        Hazy::EventRecorder recorder(path);
+        recorder.record(Hazy::MouseScrolledEvent(0.0f, 1.0f, nullptr), 0);
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 2);
+    EXPECT_THROW(Hazy::EventReplay { path }, std::runtime_error);
+
+    std::filesystem::remove(path);
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+TEST(FixedTimestepTest, StepsAndAlpha)
+{
+    // 以 2 的幂作为步长，避免浮点误差影响断言
+    Hazy::FixedTimestep timestep(32.0f, 4);
+    EXPECT_FLOAT_EQ(timestep.getStep(), 1.0f / 32.0f);
+
+    // 渲染比更新快：大部分帧不执行更新，插值系数逐渐增大
+    EXPECT_EQ(timestep.advance(1.0f / 128.0f), 0u);
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.25f);
+    EXPECT_EQ(timestep.advance(1.0f / 128.0f), 0u);
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.5f);
+    EXPECT_EQ(timestep.advance(1.0f / 64.0f), 1u);
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.0f);
+
+    // 渲染比更新慢：一帧执行多次更新，剩下的时间留给下一帧
+    EXPECT_EQ(timestep.advance(5.0f / 64.0f), 2u);
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.5f);
+    EXPECT_EQ(timestep.advance(-1.0f), 0u);
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.5f);
+    EXPECT_EQ(timestep.getDroppedSteps(), 0u);
+}
+
+TEST(FixedTimestepTest, CatchUpIsBounded)
+{
+    Hazy::FixedTimestep timestep(32.0f, 4);
+    timestep.advance(1.0f / 64.0f);
+
+    // 卡顿了一秒：只补 4 次更新，其余的丢弃，插值的相位保持不变
+    EXPECT_EQ(timestep.advance(1.0f), 4u);
+    EXPECT_EQ(timestep.getDroppedSteps(), 28u);
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.5f);
+
+    EXPECT_EQ(timestep.advance(1.0f / 64.0f), 1u);
+    timestep.advance(1.0f / 64.0f);
+    timestep.reset();
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.0f);
+}
+
+TEST(FixedTimestepTest, InvalidArguments)
+{
+    EXPECT_THROW(Hazy::FixedTimestep(0.0f), std::invalid_argument);
+    EXPECT_THROW(Hazy::FixedTimestep(-30.0f), std::invalid_argument);
+    EXPECT_THROW(Hazy::FixedTimestep(30.0f, 0), std::invalid_argument);
+    EXPECT_FLOAT_EQ(Hazy::FixedTimestep(30.0f).getTickRate(), 30.0f);
+    EXPECT_EQ(Hazy::FixedTimestep(30.0f).getMaxCatchUpSteps(), 5u);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+    /**
+     * @brief 构造一个事件的时间戳，各个阶段的耗时由参数指定
+     */
+    Hazy::EventTimestamps MakeTimestamps(Hazy::EventClock::time_point queued, std::chrono::nanoseconds wait, std::chrono::nanoseconds delay) {
+        Hazy::EventTimestamps timestamps;
+        timestamps.queued = queued;
+        timestamps.dequeued = queued + wait;
+        timestamps.dispatched = queued + wait + delay;
+        return timestamps;
+    }
+
+}
+
+TEST(InputLatencyTest, Percentiles)
+{
+    Hazy::InputLatency::reset();
+    EXPECT_EQ(Hazy::InputLatency::getStats().count, 0u);
+    EXPECT_EQ(Hazy::InputLatency::getPercentile(Hazy::LatencyStage::Total, 50.0), 0ns);
+
+    // 100 帧，第 i 帧的输入在呈现之前 i 毫秒投递
+    Hazy::EventClock::time_point start = Hazy::EventClock::now();
+    for (int i = 1; i <= 100; i++) {
+        Hazy::EventClock::time_point presented = start + std::chrono::milliseconds(i * 1000);
+        Hazy::EventTimestamps event = MakeTimestamps(presented - std::chrono::milliseconds(i), 100us, 10us);
+        Hazy::InputLatency::recordPresent(std::span(&event, 1), presented);
+    }
+
+    Hazy::LatencyStats total = Hazy::InputLatency::getStats(Hazy::LatencyStage::Total);
+    EXPECT_EQ(total.count, 100u);
+    EXPECT_EQ(total.p50, 50ms);
+    EXPECT_EQ(total.p90, 90ms);
+    EXPECT_EQ(total.p99, 99ms);
+    EXPECT_EQ(total.max, 100ms);
+    EXPECT_EQ(Hazy::InputLatency::getPercentile(Hazy::LatencyStage::Total, 0.0), 1ms);
+    EXPECT_EQ(Hazy::InputLatency::getPercentile(Hazy::LatencyStage::Total, 100.0), 100ms);
+
+    Hazy::LatencyStats wait = Hazy::InputLatency::getStats(Hazy::LatencyStage::QueueWait);
+    EXPECT_EQ(wait.p50, 100us);
+    EXPECT_EQ(wait.max, 100us);
+    EXPECT_EQ(Hazy::InputLatency::getStats(Hazy::LatencyStage::DispatchDelay).p99, 10us);
+    EXPECT_EQ(Hazy::InputLatency::getStats(Hazy::LatencyStage::Present).p50, 50ms - 110us);
+
+    EXPECT_THROW(Hazy::InputLatency::getPercentile(Hazy::LatencyStage::Total, 101.0), std::out_of_range);
+    Hazy::InputLatency::reset();
+}
+
+TEST(InputLatencyTest, KeepsMostRecentSamples)
+{
+    Hazy::InputLatency::reset();
+    Hazy::EventClock::time_point presented = Hazy::EventClock::now();
+
+    // 一帧中呈现的一批事件，旧的样本被新的覆盖
+    std::vector<Hazy::EventTimestamps> old(Hazy::InputLatency::s_sampleCapacity, MakeTimestamps(presented - 1s, 0ns, 0ns));
+    Hazy::InputLatency::recordPresent(old, presented);
+    std::vector<Hazy::EventTimestamps> recent(Hazy::InputLatency::s_sampleCapacity, MakeTimestamps(presented - 5ms, 0ns, 0ns));
+    Hazy::InputLatency::recordPresent(recent, presented);
+
+    Hazy::LatencyStats stats = Hazy::InputLatency::getStats();
+    EXPECT_EQ(stats.count, Hazy::InputLatency::s_sampleCapacity);
+    EXPECT_EQ(stats.max, 5ms);
+    EXPECT_EQ(Hazy::InputLatency::getSampleCount(), Hazy::InputLatency::s_sampleCapacity * 2);
+    Hazy::InputLatency::reset();
+}
\ No newline at end of file
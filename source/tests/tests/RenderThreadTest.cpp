@@ -0,0 +1,75 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+TEST(RenderThreadTest, FramesRunInOrderOnRenderThread)
+{
+    Hazy::RenderThread renderThread;
+    std::vector<int> frames;
+    std::thread::id renderThreadId;
+    EXPECT_FALSE(renderThread.isCurrentThread());
+
+    for (int i = 0; i < 100; i++) {
+        // submit() 先等待上一帧完成，所以这里修改 frames 不会和渲染线程冲突
+        renderThread.submit(
+            [&, i] {
+                frames.push_back(i);
+                renderThreadId = std::this_thread::get_id();
+                EXPECT_TRUE(renderThread.isCurrentThread());
+            });
+    }
+    renderThread.wait();
+
+    ASSERT_EQ(frames.size(), 100u);
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(frames[i], i);
+    EXPECT_NE(renderThreadId, std::this_thread::get_id());
+    EXPECT_EQ(renderThread.getFrameCount(), 100u);
+    EXPECT_FALSE(renderThread.isBusy());
+}
+
+TEST(RenderThreadTest, OneFrameInFlight)
+{
+    Hazy::RenderThread renderThread;
+    std::atomic<bool> release = false;
+    std::atomic<int> rendered = 0;
+
+    // 第一帧还没有完成时 submit() 立即返回，主线程可以继续更新下一帧
+    renderThread.submit(
+        [&] {
+            while (!release.load())
+                std::this_thread::yield();
+            rendered++;
+        });
+    EXPECT_TRUE(renderThread.isBusy());
+    EXPECT_EQ(rendered.load(), 0);
+
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release = true;
+    });
+    // 第二帧要等第一帧完成之后才能提交
+    renderThread.submit([&] { EXPECT_EQ(rendered.load(), 1); rendered++; });
+    EXPECT_GE(rendered.load(), 1);
+    EXPECT_GT(renderThread.getLastWaitTime().count(), 0);
+    renderThread.wait();
+    EXPECT_EQ(rendered.load(), 2);
+    releaser.join();
+}
+
+TEST(RenderThreadTest, ExceptionsAreRethrownOnWait)
+{
+    Hazy::RenderThread renderThread;
+    renderThread.submit([] { throw std::runtime_error("render failed"); });
+    EXPECT_THROW(renderThread.wait(), std::runtime_error);
+
+    // 异常只抛出一次，之后可以继续提交
+    EXPECT_NO_THROW(renderThread.wait());
+    bool rendered = false;
+    renderThread.submit([&] { rendered = true; });
+    renderThread.wait();
+    EXPECT_TRUE(rendered);
+
+    renderThread.submit([] { throw std::logic_error("render failed again"); });
+    EXPECT_THROW(renderThread.submit([] { }), std::logic_error);
+    EXPECT_EQ(renderThread.getFrameCount(), 3u);
+}
\ No newline at end of file
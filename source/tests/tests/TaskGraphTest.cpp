@@ -0,0 +1,140 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+TEST(TaskGraphTest, DependencyOrder) {
+    Hazy::ThreadPool pool;
+    Hazy::TaskGraph graph;
+    std::mutex m;
+    std::vector<std::string> order;
+    auto record = [&](const char* name) {
+        return [&, name] {
+            std::lock_guard<std::mutex> lock(m);
+            order.push_back(name);
+        };
+    };
+
+    // input -> update -> (cull, animate) -> record -> upload
+    auto input   = graph.addNode("input", record("input"));
+    auto update  = graph.addNode("update", record("update"));
+    auto cull    = graph.addNode("cull", record("cull"));
+    auto animate = graph.addNode("animate", record("animate"));
+    auto draw    = graph.addNode("record", record("record"));
+    auto upload  = graph.addNode("upload", record("upload"));
+    graph.precede(input, update)
+        .precede(update, cull)
+        .precede(update, animate)
+        .precede(cull, draw)
+        .precede(animate, draw)
+        .precede(draw, upload);
+
+    auto indexOf = [&](const std::string& name) {
+        return std::find(order.begin(), order.end(), name) - order.begin();
+    };
+
+    for (int frame = 0; frame < 100; frame++) {
+        order.clear();
+        graph.run(pool);
+        ASSERT_EQ(order.size(), 6);
+        EXPECT_LT(indexOf("input"), indexOf("update"));
+        EXPECT_LT(indexOf("update"), indexOf("cull"));
+        EXPECT_LT(indexOf("update"), indexOf("animate"));
+        EXPECT_LT(indexOf("cull"), indexOf("record"));
+        EXPECT_LT(indexOf("animate"), indexOf("record"));
+        EXPECT_LT(indexOf("record"), indexOf("upload"));
+    }
+}
+
+TEST(TaskGraphTest, WideGraph) {
+    Hazy::ThreadPool pool;
+    Hazy::TaskGraph graph;
+    std::atomic<int> count = 0;
+    auto root = graph.addNode("root", [] { });
+    auto sink = graph.addNode("sink", [&] { EXPECT_EQ(count.load(), 256); });
+    for (int i = 0; i < 256; i++) {
+        auto node = graph.addNode("leaf", [&] { count++; });
+        graph.precede(root, node).precede(node, sink);
+    }
+    for (int frame = 0; frame < 10; frame++) {
+        count = 0;
+        graph.launch(pool);
+        EXPECT_TRUE(graph.isRunning());
+        graph.wait();
+        EXPECT_EQ(count.load(), 256);
+    }
+}
+
+TEST(TaskGraphTest, CycleDetection) {
+    Hazy::TaskGraph graph;
+    auto a = graph.addNode("a", [] { });
+    auto b = graph.addNode("b", [] { });
+    graph.precede(a, b).precede(b, a);
+    EXPECT_THROW(graph.compile(), std::logic_error);
+}
+
+TEST(TaskGraphTest, ExceptionPropagation) {
+    Hazy::ThreadPool pool;
+    Hazy::TaskGraph graph;
+    bool after = false;
+    auto a = graph.addNode("a", [] { throw std::runtime_error("a"); });
+    auto b = graph.addNode("b", [&] { after = true; });
+    graph.precede(a, b);
+    EXPECT_THROW(graph.run(pool), std::runtime_error);
+    EXPECT_FALSE(after);
+    EXPECT_FALSE(graph.isRunning());
+}
+
+TEST(TaskGraphTest, WaitInsidePoolTask) {
+    // 只有一个工作线程，在任务里等待另一个图时必须帮忙执行图的节点，否则会死锁
+    Hazy::ThreadPool pool(1);
+    std::atomic<int> count = 0;
+    auto outer = pool.Execute(
+        [&] {
+            Hazy::TaskGraph graph;
+            auto root = graph.addNode("root", [&] { count++; });
+            for (int i = 0; i < 16; i++) {
+                graph.precede(root, graph.addNode("leaf", [&] { count++; }));
+            }
+            graph.run(pool);
+        });
+    pool.wait(outer);
+    EXPECT_EQ(count.load(), 17);
+}
+
+TEST(TaskGraphTest, DestroyRightAfterWait) {
+    // 最后一个节点完成之后，工作线程不能再访问图，等待者可以马上销毁它
+    Hazy::ThreadPool pool;
+    for (int frame = 0; frame < 1000; frame++) {
+        auto graph = std::make_unique<Hazy::TaskGraph>();
+        auto root = graph->addNode("root", [] { });
+        for (int i = 0; i < 4; i++) {
+            graph->precede(root, graph->addNode("leaf", [] { }));
+        }
+        graph->run(pool);
+        graph.reset();
+    }
+}
+
+TEST(TaskGraphTest, SubmitFailure) {
+    // 线程池停止之后提交节点会失败，失败的节点和它的后继都计为完成，wait() 重新抛出提交时的异常
+    auto pool = std::make_unique<Hazy::ThreadPool>(1);
+    std::atomic<bool> executed = false;
+    std::atomic<bool> thrown = false;
+    pool->Submit(
+        [&, pool = pool.get()] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            Hazy::TaskGraph graph;
+            auto a = graph.addNode("a", [&] { executed = true; });
+            auto b = graph.addNode("b", [&] { executed = true; });
+            graph.precede(a, b);
+            try {
+                graph.run(*pool);
+            }
+            catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            EXPECT_FALSE(graph.isRunning());
+        });
+    pool.reset();
+    EXPECT_TRUE(thrown.load());
+    EXPECT_FALSE(executed.load());
+}
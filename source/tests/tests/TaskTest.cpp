@@ -0,0 +1,86 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+    Hazy::Task<std::thread::id> RunOnPool(Hazy::ThreadPool& pool) {
+        co_await pool.schedule();
+        co_return std::this_thread::get_id();
+    }
+
+    Hazy::Task<int> Square(Hazy::ThreadPool& pool, int value) {
+        co_await pool.schedule();
+        co_return value * value;
+    }
+
+    Hazy::Task<int> SumOfSquares(Hazy::ThreadPool& pool, int count) {
+        int sum = 0;
+        for (int i = 1; i <= count; i++) {
+            sum += co_await Square(pool, i);
+        }
+        co_return sum;
+    }
+
+    Hazy::Task<> Fail(Hazy::ThreadPool& pool) {
+        co_await pool.schedule();
+        throw std::runtime_error("boom");
+    }
+
+}
+
+TEST(TaskTest, TaskIsLazy) {
+    bool started = false;
+    auto body = [&]() -> Hazy::Task<> {
+        started = true;
+        co_return;
+    };
+    auto task = body();
+    EXPECT_FALSE(started);
+    syncWait(std::move(task));
+    EXPECT_TRUE(started);
+}
+
+TEST(TaskTest, ScheduleResumesOnWorkerThread) {
+    Hazy::ThreadPool pool(2);
+    std::thread::id worker = syncWait(RunOnPool(pool));
+    EXPECT_NE(worker, std::this_thread::get_id());
+}
+
+TEST(TaskTest, AwaitNestedTasks) {
+    Hazy::ThreadPool pool(4);
+    EXPECT_EQ(syncWait(SumOfSquares(pool, 100)), 338350);
+}
+
+TEST(TaskTest, ExceptionPropagatesToAwaiter) {
+    Hazy::ThreadPool pool(2);
+    EXPECT_THROW(syncWait(Fail(pool)), std::runtime_error);
+
+    auto outer = [&]() -> Hazy::Task<bool> {
+        try {
+            co_await Fail(pool);
+        }
+        catch (const std::runtime_error&) {
+            co_return true;
+        }
+        co_return false;
+    };
+    EXPECT_TRUE(syncWait(outer()));
+}
+
+TEST(TaskTest, DetachedTasksRunToCompletion) {
+    constexpr int taskCount = 1000;
+    Hazy::ThreadPool pool(4);
+    std::atomic<int> counter = 0;
+
+    auto work = [](Hazy::ThreadPool& pool, std::atomic<int>& counter) -> Hazy::Task<> {
+        co_await pool.schedule();
+        counter.fetch_add(1);
+    };
+    for (int i = 0; i < taskCount; i++) {
+        work(pool, counter).detach();
+    }
+    while (counter.load() < taskCount) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(counter.load(), taskCount);
+}
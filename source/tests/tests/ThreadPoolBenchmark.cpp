@@ -0,0 +1,210 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+
+namespace Baseline {
+
+    /**
+     * @brief 改造之前的线程池原样拷贝：一个 std::queue 加一把锁，任务包装成 std::packaged_task 放在堆上，
+     * 作为基准测试的参照物，不要跟着 Hazy::ThreadPool 一起修改
+     */
+    class ThreadPool {
+    public:
+        ThreadPool(int threadCount = std::thread::hardware_concurrency())
+            : m_stopped(false) {
+            for (int i = 0; i < threadCount; i++) {
+                m_threads.emplace_back(std::thread(&ThreadPool::Work, this));
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                m_stopped = true;
+            }
+            m_cv.notify_all();
+            for (std::thread& thread : m_threads) {
+                thread.join();
+            }
+        }
+
+        template <typename Func, typename... Args>
+        std::future<std::invoke_result_t<Func, Args...>> Execute(Func&& func, Args&&... args) {
+            using return_type = std::invoke_result_t<Func, Args...>;
+
+            auto task = std::make_shared<std::packaged_task<return_type()>>(
+                std::bind(std::forward<Func>(func), std::forward<Args>(args)...)
+            );
+
+            std::future<return_type> future = task->get_future();
+
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                if (m_stopped)
+                    throw std::runtime_error("ThreadPool has been stopped.");
+                m_taskQueue.emplace([task]() { (*task)(); });
+            }
+
+            m_cv.notify_one();
+            return future;
+        }
+
+    private:
+        void Work() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_queueMutex);
+                    m_cv.wait(lock,
+                        [this] {
+                            return m_stopped || !m_taskQueue.empty();
+                        });
+                    if (m_stopped && m_taskQueue.empty())
+                        return;
+                    task = std::move(m_taskQueue.front());
+                    m_taskQueue.pop();
+                }
+                task();
+            }
+        }
+
+        std::condition_variable m_cv;
+        std::vector<std::thread> m_threads;
+        std::mutex m_queueMutex;
+        std::queue<std::function<void()>> m_taskQueue;
+        bool m_stopped;
+    };
+
+}
+
+namespace {
+
+    struct Result {
+        double milliseconds;
+        int completed;
+    };
+
+    // 忙等待指定的微秒数，模拟一个细粒度的任务
+    void Spin(int microseconds) {
+        auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(microseconds);
+        while (std::chrono::steady_clock::now() < end) { }
+    }
+
+    std::vector<int> ThreadCounts() {
+        std::vector<int> counts;
+        int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int i = 1; i < hardware; i *= 2) {
+            counts.push_back(i);
+        }
+        counts.push_back(hardware);
+        return counts;
+    }
+
+    double Elapsed(std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    /**
+     * @brief 外部线程逐个提交 taskCount 个任务，然后等待它们全部完成
+     */
+    template <typename Pool>
+    Result ExternalSubmission(Pool& pool, int taskCount, int taskMicroseconds) {
+        std::atomic<int> completed = 0;
+        auto task = [&completed, taskMicroseconds] { Spin(taskMicroseconds); completed.fetch_add(1, std::memory_order_relaxed); };
+        std::vector<std::future<void>> futures;
+        futures.reserve(taskCount);
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < taskCount; i++) {
+            futures.push_back(pool.Execute(task));
+        }
+        for (auto& future : futures) {
+            future.wait();
+        }
+        return { Elapsed(begin), completed.load() };
+    }
+
+    /**
+     * @brief 外部线程一次性提交 taskCount 个任务，然后等待整批任务完成，
+     * 原来的线程池没有批量提交，只能逐个提交
+     */
+    template <typename Pool>
+    Result BatchSubmission(Pool& pool, int taskCount, int taskMicroseconds) {
+        if constexpr (!std::is_same_v<Pool, Hazy::ThreadPool>) {
+            return ExternalSubmission(pool, taskCount, taskMicroseconds);
+        }
+        else {
+            std::atomic<int> completed = 0;
+            auto task = [&completed, taskMicroseconds] { Spin(taskMicroseconds); completed.fetch_add(1, std::memory_order_relaxed); };
+            std::vector<decltype(task)> tasks(taskCount, task);
+            auto begin = std::chrono::steady_clock::now();
+            pool.ExecuteBatch(tasks).wait();
+            return { Elapsed(begin), completed.load() };
+        }
+    }
+
+    /**
+     * @brief 一个根任务在工作线程中递归地把任务一分为二，叶子任务执行细粒度的工作
+     */
+    template <typename Pool>
+    Result NestedFanOut(Pool& pool, int taskCount, int taskMicroseconds) {
+        std::atomic<int> remaining = taskCount;
+        std::promise<void> done;
+
+        std::function<void(int, int)> split =
+            [&](int begin, int end) {
+                while (end - begin > 1) {
+                    int middle = begin + (end - begin) / 2;
+                    pool.Execute(split, middle, end);
+                    end = middle;
+                }
+                Spin(taskMicroseconds);
+                if (remaining.fetch_sub(1) == 1)
+                    done.set_value();
+            };
+
+        auto begin = std::chrono::steady_clock::now();
+        pool.Execute(split, 0, taskCount);
+        done.get_future().wait();
+        return { Elapsed(begin), taskCount - remaining.load() };
+    }
+
+    /**
+     * @brief 在不同的线程数下，分别用原来的线程池和现在的工作窃取线程池跑同一个场景，
+     * 每一次都检查所有任务确实执行完了
+     */
+    template <typename Benchmark>
+    void Compare(const char* name, Benchmark benchmark) {
+        constexpr int taskCount = 20000;
+        constexpr int taskMicroseconds = 20;
+        const double serial = taskCount * taskMicroseconds / 1000.0;
+
+        Hazy::Logger::LogInfo("{}: {} tasks x {} us, serial time {:.1f} ms", name, taskCount, taskMicroseconds, serial);
+        for (int threads : ThreadCounts()) {
+            Result baseline, stealing;
+            {
+                Baseline::ThreadPool pool(threads);
+                baseline = benchmark(pool, taskCount, taskMicroseconds);
+            }
+            {
+                Hazy::ThreadPool pool(threads, Hazy::ThreadPoolMode::WorkStealing);
+                stealing = benchmark(pool, taskCount, taskMicroseconds);
+            }
+            EXPECT_EQ(baseline.completed, taskCount);
+            EXPECT_EQ(stealing.completed, taskCount);
+            Hazy::Logger::LogInfo("|> {:>3} threads  baseline {:>8.1f} ms ({:>5.2f}x)  work stealing {:>8.1f} ms ({:>5.2f}x)",
+                threads, baseline.milliseconds, serial / baseline.milliseconds, stealing.milliseconds, serial / stealing.milliseconds);
+        }
+    }
+
+}
+
+TEST(ThreadPoolBenchmark, ExternalSubmission) {
+    Compare("ExternalSubmission", [](auto& pool, int taskCount, int taskMicroseconds) { return ExternalSubmission(pool, taskCount, taskMicroseconds); });
+}
+
+TEST(ThreadPoolBenchmark, BatchSubmission) {
+    Compare("BatchSubmission", [](auto& pool, int taskCount, int taskMicroseconds) { return BatchSubmission(pool, taskCount, taskMicroseconds); });
+}
+
+TEST(ThreadPoolBenchmark, NestedFanOut) {
+    Compare("NestedFanOut", [](auto& pool, int taskCount, int taskMicroseconds) { return NestedFanOut(pool, taskCount, taskMicroseconds); });
+}
@@ -70,4 +70,413 @@ TEST(ThreadPoolTest, ThreadPoolTest_SecurityOfThreadPool) {
     };
 
     EXPECT_EQ(futures.size(), 1000);
-}
\ No newline at end of file
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_ParallelFor) {
+    Hazy::ThreadPool pool;
+    std::vector<int> values(100000, 0);
+    pool.parallelFor(size_t(0), values.size(), size_t(0),
+        [&](size_t i) {
+            values[i] = static_cast<int>(i) * 2;
+        });
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_EQ(values[i], static_cast<int>(i) * 2);
+    }
+
+    std::atomic<int> visited = 0;
+    pool.parallelFor(0, 1000, 64,
+        [&](int begin, int end) {
+            EXPECT_LE(end - begin, 64);
+            visited += end - begin;
+        });
+    EXPECT_EQ(visited.load(), 1000);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_ParallelReduce) {
+    Hazy::ThreadPool pool;
+    long long sum = pool.parallelReduce(1LL, 100001LL, 0LL, 0LL,
+        [](long long begin, long long end, long long init) {
+            for (long long i = begin; i < end; i++) {
+                init += i;
+            }
+            return init;
+        },
+        std::plus<long long>());
+    EXPECT_EQ(sum, 5000050000LL);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_NestedParallelFor) {
+    Hazy::ThreadPool pool(2);
+    std::atomic<int> count = 0;
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 8; i++) {
+        futures.push_back(pool.Execute(
+            [&] {
+                pool.parallelFor(0, 1000, 10, [&](int) { count++; });
+            }));
+    }
+    for (auto& future : futures) {
+        future.wait();
+    }
+    EXPECT_EQ(count.load(), 8000);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_ParallelForException) {
+    Hazy::ThreadPool pool;
+    EXPECT_THROW(
+        pool.parallelFor(0, 100, 1,
+            [](int i) {
+                if (i == 42)
+                    throw std::runtime_error("42");
+            }),
+        std::runtime_error);
+}
+
+namespace {
+
+    // 让线程池唯一的工作线程卡住，直到 open() 被调用
+    struct Gate {
+        std::atomic<bool> opened = false;
+        std::atomic<bool> entered = false;
+
+        void block() {
+            entered = true;
+            while (!opened.load()) {
+                std::this_thread::yield();
+            }
+        }
+
+        void waitEntered() {
+            while (!entered.load()) {
+                std::this_thread::yield();
+            }
+        }
+
+        void open() { opened = true; }
+    };
+
+    void WaitUntil(const std::function<bool()>& pred) {
+        while (!pred()) {
+            std::this_thread::yield();
+        }
+    }
+
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_PriorityOrder) {
+    Hazy::ThreadPool pool(1);
+    Gate gate;
+    pool.Submit([&] { gate.block(); });
+    gate.waitEntered();
+
+    std::mutex mutex;
+    std::vector<Hazy::TaskPriority> order;
+    auto record = [&](Hazy::TaskPriority priority) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(priority);
+    };
+    pool.Submit(Hazy::TaskPriority::Background, record, Hazy::TaskPriority::Background);
+    pool.Submit(Hazy::TaskPriority::Normal, record, Hazy::TaskPriority::Normal);
+    pool.Submit(Hazy::TaskPriority::Critical, record, Hazy::TaskPriority::Critical);
+
+    EXPECT_EQ(pool.getQueueDepth(Hazy::TaskPriority::Critical), 1u);
+    EXPECT_EQ(pool.getQueueDepth(Hazy::TaskPriority::Normal), 1u);
+    EXPECT_EQ(pool.getQueueDepth(Hazy::TaskPriority::Background), 1u);
+
+    gate.open();
+    WaitUntil([&] { std::lock_guard<std::mutex> lock(mutex); return order.size() == 3; });
+    EXPECT_EQ(order, std::vector<Hazy::TaskPriority>({ Hazy::TaskPriority::Critical, Hazy::TaskPriority::Normal, Hazy::TaskPriority::Background }));
+    EXPECT_EQ(pool.getQueueDepth(Hazy::TaskPriority::Background), 0u);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_BackgroundDoesNotOccupyAllWorkers) {
+    Hazy::ThreadPool pool(2);
+    Gate gate;
+    std::atomic<int> started = 0;
+    for (int i = 0; i < 2; i++) {
+        pool.Submit(Hazy::TaskPriority::Background, [&] { started++; gate.block(); });
+    }
+    gate.waitEntered();
+
+    // 只有一个线程在执行后台任务，另一个线程可以马上执行帧任务
+    auto future = pool.Execute(Hazy::TaskPriority::Critical, [] { return 42; });
+    EXPECT_EQ(future.get(), 42);
+    EXPECT_EQ(started.load(), 1);
+
+    gate.open();
+    WaitUntil([&] { return started.load() == 2; });
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_SingleWorkerBackground) {
+    // 只有一个工作线程时后台任务可以占用它，等待帧任务的线程会亲自执行帧任务
+    Hazy::ThreadPool pool(1);
+    Gate gate;
+    pool.Submit(Hazy::TaskPriority::Background, [&] { gate.block(); });
+    gate.waitEntered();
+
+    auto future = pool.Execute(Hazy::TaskPriority::Critical, [] { return 42; });
+    EXPECT_EQ(pool.wait(future), 42);
+
+    gate.open();
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_BackgroundBudget) {
+    Hazy::ThreadPool pool(2);
+    pool.setBackgroundBudget(std::chrono::microseconds(1000));
+    std::atomic<int> finished = 0;
+    for (int i = 0; i < 4; i++) {
+        pool.Submit(Hazy::TaskPriority::Background,
+            [&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                finished++;
+            });
+    }
+
+    // 第一个任务就把这一帧的预算用完了，剩下的要等到下一帧
+    WaitUntil([&] { return finished.load() == 1; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(finished.load(), 1);
+    EXPECT_EQ(pool.getQueueDepth(Hazy::TaskPriority::Background), 3u);
+
+    // 帧任务不受后台预算的影响
+    EXPECT_EQ(pool.Execute([] { return 7; }).get(), 7);
+
+    for (int frame = 2; frame <= 4; frame++) {
+        pool.beginFrame();
+        WaitUntil([&] { return finished.load() == frame; });
+    }
+    EXPECT_EQ(pool.getQueueDepth(Hazy::TaskPriority::Background), 0u);
+}
+
+namespace {
+
+    // 递归地把区间一分为二，在任务中提交子任务并等待它们，没有帮忙等待的话两个线程很快就会全部阻塞
+    long long RecursiveSum(Hazy::ThreadPool& pool, long long begin, long long end) {
+        if (end - begin <= 64) {
+            long long sum = 0;
+            for (long long i = begin; i < end; i++) {
+                sum += i;
+            }
+            return sum;
+        }
+        long long middle = begin + (end - begin) / 2;
+        auto left = pool.Execute(RecursiveSum, std::ref(pool), begin, middle);
+        auto right = pool.ExecutePooled(RecursiveSum, std::ref(pool), middle, end);
+        return pool.wait(left) + pool.wait(right);
+    }
+
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_WaitHelpsNestedTasks) {
+    Hazy::ThreadPool pool(2);
+    auto future = pool.Execute(RecursiveSum, std::ref(pool), 0LL, 100000LL);
+    EXPECT_EQ(pool.wait(future), 4999950000LL);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_WaitSharedFutureAndException) {
+    Hazy::ThreadPool pool(1);
+    std::shared_future<int> shared = pool.Execute([] { return 5; }).share();
+    EXPECT_EQ(pool.wait(shared), 5);
+
+    auto failed = pool.ExecutePooled([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(pool.wait(failed), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_WaitOnBackgroundFromTasks) {
+    // 所有工作线程都在任务中等待后台任务，并且后台预算已经用完，等待者要自己执行后台任务
+    Hazy::ThreadPool pool(2);
+    pool.setBackgroundBudget(std::chrono::microseconds(1));
+    pool.ExecutePooled(Hazy::TaskPriority::Background, [] { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }).wait();
+
+    std::vector<Hazy::PooledFuture<int>> futures;
+    for (int i = 0; i < 3; i++) {
+        futures.push_back(pool.ExecutePooled([&pool, i] {
+            auto read = pool.ExecutePooled(Hazy::TaskPriority::Background, [i] { return i; });
+            return pool.wait(read);
+        }));
+    }
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(pool.wait(futures[i]), i);
+    }
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_CancelQueuedTasks) {
+    Hazy::ThreadPool pool(1);
+    Gate gate;
+    pool.Submit([&] { gate.block(); });
+    gate.waitEntered();
+
+    Hazy::CancellationSource source;
+    std::atomic<int> executed = 0;
+    std::vector<Hazy::PooledFuture<int>> futures;
+    for (int i = 0; i < 10; i++) {
+        futures.push_back(pool.ExecuteCancellable(source.getToken(), [&executed](int value) { executed++; return value; }, i));
+    }
+    auto kept = pool.ExecuteCancellable(Hazy::CancellationToken(), [] { return 42; });
+    source.cancel();
+
+    // 排队的任务在 cancel() 的时候就已经完成了，不需要等工作线程把它们取出来
+    for (auto& future : futures) {
+        EXPECT_TRUE(future.isReady());
+        EXPECT_TRUE(future.isCancelled());
+    }
+    // 令牌已经被取消了，任务不会被提交
+    auto late = pool.ExecuteCancellable(source.getToken(), [&executed] { executed++; });
+    EXPECT_TRUE(late.isCancelled());
+    gate.open();
+
+    for (auto& future : futures) {
+        future.wait();
+        EXPECT_TRUE(future.isCancelled());
+        EXPECT_THROW(future.get(), Hazy::TaskCancelled);
+    }
+    EXPECT_EQ(pool.wait(kept), 42);
+    EXPECT_EQ(executed.load(), 0);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_CancelRunningTask) {
+    Hazy::ThreadPool pool(1);
+    Hazy::CancellationSource source;
+    std::atomic<bool> started = false;
+    auto future = pool.ExecuteCancellable(source.getToken(),
+        [&](const Hazy::CancellationToken& token) {
+            started = true;
+            int iterations = 0;
+            while (true) {
+                token.throwIfCancelled();
+                iterations++;
+                std::this_thread::yield();
+            }
+            return iterations;
+        });
+    WaitUntil([&] { return started.load(); });
+    source.cancel();
+    future.wait();
+    EXPECT_TRUE(future.isCancelled());
+    EXPECT_THROW(future.get(), Hazy::TaskCancelled);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_SpinThenPark) {
+    Hazy::ThreadPoolConfig config;
+    config.threadCount = 2;
+    config.spinDuration = std::chrono::microseconds(200);
+    Hazy::ThreadPool pool(config);
+    for (int frame = 0; frame < 100; frame++) {
+        EXPECT_EQ(pool.Execute([frame] { return frame; }).get(), frame);
+    }
+    // 自旋结束之后线程会睡眠，仍然可以被正常唤醒
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(pool.Execute([] { return 1; }).get(), 1);
+}
+
+#ifdef __linux__
+TEST(ThreadPoolTest, ThreadPoolTest_ThreadNameAndAffinity) {
+    Hazy::ThreadPoolConfig config;
+    config.threadCount = 1;
+    config.name = "TestWorker";
+    config.cpuCores = { 0 };
+    Hazy::ThreadPool pool(config);
+
+    auto [name, core] = pool.Execute(
+        [] {
+            char buffer[16] = {};
+            pthread_getname_np(pthread_self(), buffer, sizeof(buffer));
+            return std::make_pair(std::string(buffer), sched_getcpu());
+        }).get();
+    EXPECT_EQ(name, "TestWorker-0");
+    EXPECT_EQ(core, 0);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_InvalidCoresIgnored) {
+    auto affinity = [] {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+        return std::make_pair(CPU_COUNT(&set), CPU_ISSET(0, &set) != 0);
+    };
+    const auto original = affinity();
+
+    // 超出范围的核心被忽略，剩下的核心照常使用，主线程的核心超出范围时不固定主线程
+    Hazy::ThreadPoolConfig config;
+    config.threadCount = 2;
+    config.cpuCores = { -1, 0, CPU_SETSIZE, 1 << 20 };
+    config.mainThreadCore = CPU_SETSIZE + 1;
+    {
+        Hazy::ThreadPool pool(config);
+        for (int i = 0; i < 2; i++) {
+            EXPECT_EQ(pool.Execute(affinity).get(), std::make_pair(1, true));
+        }
+    }
+    EXPECT_EQ(affinity(), original);
+
+    // 所有核心都超出范围时不固定工作线程
+    config.cpuCores = { -5, CPU_SETSIZE };
+    config.mainThreadCore = -1;
+    Hazy::ThreadPool pool(config);
+    EXPECT_EQ(pool.Execute(affinity).get(), original);
+}
+#endif
+
+TEST(ThreadPoolTest, ThreadPoolTest_ExecuteBatch) {
+    Hazy::ThreadPool pool(4);
+    std::vector<int> results(5000, 0);
+    std::vector<std::function<void()>> funcs;
+    for (size_t i = 0; i < results.size(); i++) {
+        funcs.push_back([&results, i] { results[i] = static_cast<int>(i); });
+    }
+
+    // 连续容器可以直接传进去，不需要先包装成 std::span
+    Hazy::TaskGroup group = pool.ExecuteBatch(funcs);
+    EXPECT_TRUE(group.valid());
+    EXPECT_EQ(group.size(), results.size());
+    pool.wait(std::move(group));
+    for (size_t i = 0; i < results.size(); i++) {
+        EXPECT_EQ(results[i], static_cast<int>(i));
+    }
+
+    Hazy::TaskGroup empty = pool.ExecuteBatch(std::span<std::function<void()>>());
+    EXPECT_TRUE(empty.isReady());
+    EXPECT_NO_THROW(empty.get());
+    EXPECT_FALSE(empty.valid());
+
+    std::array<std::function<void()>, 4> fixed;
+    std::atomic<int> count = 0;
+    fixed.fill([&count] { count++; });
+    pool.wait(pool.ExecuteBatch(fixed));
+    EXPECT_EQ(count.load(), 4);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_ExecuteBatchException) {
+    Hazy::ThreadPool pool(2);
+    std::atomic<int> executed = 0;
+    auto work = [&executed] {
+        if (executed.fetch_add(1) == 10)
+            throw std::runtime_error("boom");
+    };
+    std::vector<decltype(work)> funcs(100, work);
+
+    Hazy::TaskGroup group = pool.ExecuteBatch(Hazy::TaskPriority::Critical, funcs);
+    EXPECT_THROW(group.get(), std::runtime_error);
+    // 其余任务照常执行
+    EXPECT_EQ(executed.load(), 100);
+}
+
+TEST(ThreadPoolTest, ThreadPoolTest_ExecuteBatchFromWorker) {
+    Hazy::ThreadPool pool(2);
+    auto sum = pool.Execute(
+        [&pool] {
+            std::vector<int> values(1000, 0);
+            std::vector<std::function<void()>> funcs;
+            for (size_t i = 0; i < values.size(); i++) {
+                funcs.push_back([&values, i] { values[i] = 1; });
+            }
+            // 工作线程提交的批量任务放进自己的队列，等待的时候自己也会执行
+            pool.wait(pool.ExecuteBatch(std::span(funcs)));
+            int total = 0;
+            for (int value : values) {
+                total += value;
+            }
+            return total;
+        });
+    EXPECT_EQ(sum.get(), 1000);
+}
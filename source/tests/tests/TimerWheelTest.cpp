@@ -0,0 +1,136 @@
+#include <Hazy.h>
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(TimerWheelTest, OneShotTimers)
+{
+    Hazy::TimerWheel wheel;
+    std::vector<int> fired;
+    wheel.schedule(3, [&] { fired.push_back(3); });
+    wheel.schedule(1, [&] { fired.push_back(1); });
+    wheel.schedule(0, [&] { fired.push_back(0); });     // 0 和 1 相同
+    Hazy::TimerWheel::Handle handle = wheel.schedule(2, [&] { fired.push_back(2); });
+    EXPECT_EQ(wheel.size(), 4u);
+    EXPECT_TRUE(wheel.isPending(handle));
+
+    EXPECT_EQ(wheel.advance(), 2u);
+    EXPECT_EQ(fired.size(), 2u);
+    EXPECT_EQ(wheel.advance(), 1u);
+    EXPECT_EQ(fired.back(), 2);
+    EXPECT_FALSE(wheel.isPending(handle));
+    EXPECT_FALSE(wheel.cancel(handle));
+    EXPECT_EQ(wheel.advance(5), 1u);
+    EXPECT_EQ(fired.back(), 3);
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(wheel.now(), 7u);
+}
+
+TEST(TimerWheelTest, RepeatingAndCancel)
+{
+    Hazy::TimerWheel wheel;
+    int ticks = 0;
+    int cancelled = 0;
+    Hazy::TimerWheel::Handle repeating = wheel.scheduleRepeating(10, [&] { ticks++; }, 5);
+    Hazy::TimerWheel::Handle never = wheel.schedule(20, [&] { cancelled++; });
+    EXPECT_TRUE(wheel.cancel(never));
+    EXPECT_FALSE(wheel.cancel(never));
+
+    wheel.advance(5);
+    EXPECT_EQ(ticks, 1);
+    wheel.advance(100);     // 跨过了 10 个间隔，每一个都触发
+    EXPECT_EQ(ticks, 11);
+    EXPECT_TRUE(wheel.isPending(repeating));
+    EXPECT_TRUE(wheel.cancel(repeating));
+    wheel.advance(100);
+    EXPECT_EQ(ticks, 11);
+    EXPECT_EQ(cancelled, 0);
+
+    // 其他时间轮的句柄无效
+    Hazy::TimerWheel other;
+    Hazy::TimerWheel::Handle foreign = other.schedule(1, [] { });
+    EXPECT_FALSE(wheel.cancel(foreign));
+    EXPECT_FALSE(wheel.cancel(Hazy::TimerWheel::Handle {}));
+}
+
+TEST(TimerWheelTest, CallbacksModifyTimers)
+{
+    Hazy::TimerWheel wheel;
+    std::vector<std::string> log;
+    Hazy::TimerWheel::Handle self;
+    Hazy::TimerWheel::Handle victim;
+    self = wheel.scheduleRepeating(3,
+        [&] {
+            log.push_back("self");
+            if (log.size() == 1) {
+                EXPECT_TRUE(wheel.cancel(victim));      // 同一刻到期的另一个定时器
+                for (int i = 0; i < 1000; i++) {        // 节点池扩容
+                    wheel.schedule(1 + i % 7, [] { });
+                }
+                wheel.schedule(1, [&] { log.push_back("child"); });
+            }
+            else {
+                EXPECT_TRUE(wheel.cancel(self));        // 取消自己
+            }
+        });
+    victim = wheel.schedule(3, [&] { log.push_back("victim"); });
+
+    wheel.advance(3);
+    wheel.advance(1);
+    EXPECT_EQ(log, (std::vector<std::string> { "self", "child" }));
+    wheel.advance(10);
+    EXPECT_EQ(log, (std::vector<std::string> { "self", "child", "self" }));
+    EXPECT_FALSE(wheel.isPending(self));
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, LongDelaysAcrossLevels)
+{
+    // 每一层的边界附近，以及超过时间轮范围的延迟
+    constexpr uint64_t range = uint64_t(1) << (Hazy::TimerWheel::s_slotBits * Hazy::TimerWheel::s_levelCount);
+    std::vector<uint64_t> delays = { 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 300000, range - 1, range, range + 12345, range * 2 + 7 };
+
+    Hazy::TimerWheel wheel;
+    wheel.advance(1234567);     // 起点不对齐
+    uint64_t start = wheel.now();
+    std::vector<uint64_t> firedAt;
+    for (uint64_t delay : delays) {
+        wheel.schedule(delay, [&, delay] { firedAt.push_back(wheel.now() - start); EXPECT_EQ(wheel.now() - start, delay); });
+    }
+    // 一次前进一大段和分多次前进结果相同
+    wheel.advance(70000);
+    wheel.advance(range * 3);
+    EXPECT_EQ(firedAt, delays);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, MatchesBruteForce)
+{
+    std::mt19937 random(42);
+    Hazy::TimerWheel wheel;
+    struct Expected { uint64_t expiry; bool cancelled; };
+    std::vector<Expected> expected;
+    std::vector<Hazy::TimerWheel::Handle> handles;
+    std::vector<uint64_t> firedAt;
+
+    for (int i = 0; i < 5000; i++) {
+        uint64_t delay = random() % 3 == 0 ? random() % 100000 : random() % 200;
+        size_t id = expected.size();
+        expected.push_back({ wheel.now() + std::max<uint64_t>(delay, 1), false });
+        firedAt.push_back(0);
+        handles.push_back(wheel.schedule(delay, [&, id] { firedAt[id] = wheel.now(); }));
+        if (random() % 4 == 0) {
+            size_t victim = random() % handles.size();
+            bool pending = wheel.isPending(handles[victim]);
+            EXPECT_EQ(wheel.cancel(handles[victim]), pending);
+            if (pending)
+                expected[victim].cancelled = true;
+        }
+        wheel.advance(random() % 30);
+    }
+    wheel.advance(200000);
+
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(firedAt[i], expected[i].cancelled ? 0 : expected[i].expiry) << "timer " << i;
+    }
+    EXPECT_TRUE(wheel.empty());
+}
\ No newline at end of file